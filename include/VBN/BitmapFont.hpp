@@ -2,67 +2,259 @@
 #define BITMAP_FONT_HPP_INCLUDED
 
 #include <string>
-#include <array>
+#include <string_view>
+#include <memory>
+#include <vector>
 #include <VBN/Texture.hpp>
 #include <VBN/TrueTypeFont.hpp>
+#include <VBN/GlyphAtlas.hpp>
+#include <VBN/TextLayout.hpp>
 
 class TrueTypeFontManager;
 
 class BitmapFont
 {
+	public:
+		// How glyphs are rasterized
+		enum RenderMode
+		{
+			// Aliased glyphs, binary alpha
+			SOLID,
+			// Anti-aliased glyphs, stored with premultiplied alpha
+			BLENDED
+		};
+
+		// Glyph image & placement, rasterized on first use
+		struct Glyph
+		{
+			// Unicode codepoint
+			Uint32 codepoint;
+			// Glyph image in the atlas (empty area for blank glyphs)
+			GlyphAtlas::Region region;
+			// Horizontal offset of the image from the pen position
+			int xOffset;
+			// Pen advance
+			int advance;
+			// First kerning pair with this glyph on the left
+			Uint32 kerningBegin;
+			// Number of kerning pairs with this glyph on the left
+			Uint32 kerningCount;
+		};
+
 	private:
+		// Pen adjustment between a left glyph & 'codepoint'
+		struct KerningPair
+		{
+			// Codepoint of the right glyph
+			Uint32 codepoint;
+			// Pen adjustment
+			int offset;
+		};
+
+		// Cache file header, followed by the glyph, slot & kerning pair
+		// tables, then the glyph images
+		struct CacheHeader
+		{
+			char magic[4];
+			Uint32 version;
+			Uint32 renderMode;
+			Sint32 size;
+			Sint32 lineSkip;
+			Sint32 pageSize;
+			Uint32 fallback;
+			Uint32 ellipsis;
+			Sint32 ellipsisCount;
+			Uint32 glyphCount;
+			Uint32 slotCount;
+			Uint32 usedSlotCount;
+			Uint32 kerningPairCount;
+		};
+
+		// Slot of the codepoint -> glyph hash table
+		struct GlyphSlot
+		{
+			// Codepoint, or BITMAP_FONT_EMPTY_SLOT
+			Uint32 codepoint;
+			// Index into _glyphs
+			Uint32 glyph;
+		};
+
 		// Raw SDL_Renderer on which the BitmapFont is built
 		SDL_Renderer * _sdlRenderer;
 
-		// Available characters for this font texture
-		std::string _alphabet;
-		// Font tileset
-		Texture _texture;
-
 		/* TTF characteristics */
-		// Metrics for each character
-		std::array<TrueTypeFont::GlyphMetrics, UCHAR_MAX> _glyphMetrics;
-		// Clipping rectangle to render each character
-		std::array<SDL_Rect, UCHAR_MAX> _clips;
+		// Manager owning _font
+		std::shared_ptr<TrueTypeFontManager> _ttfManager;
+		// Font name & size
+		std::string _name;
+		int _size;
+		// Font glyphs are rasterized with (opened on first use)
+		TrueTypeFont * _font;
 		// Max height for one line
 		int _lineSkip;
+		// How glyphs are rasterized
+		RenderMode _renderMode;
+		// Atlas page size fitting the font (about 16 lines of glyphs)
+		int _pageSize;
+
+		/* Glyph cache */
+		// Pages holding glyph images (possibly shared with other fonts)
+		std::shared_ptr<GlyphAtlas> _atlas;
+		// Glyphs rasterized so far
+		std::vector<Glyph> _glyphs;
+		// Open-addressing hash table (linear probing, power of two size)
+		std::vector<GlyphSlot> _slots;
+		// Number of used slots in _slots
+		std::size_t _usedSlots;
+		// Glyph drawn for codepoints the font does not provide
+		Uint32 _fallback;
+		// Non-zero kerning pairs, grouped by left glyph
+		std::vector<KerningPair> _kerningPairs;
+		// Glyph ending truncated layouts ('…', or '.' drawn thrice)
+		Uint32 _ellipsis;
+		// Number of _ellipsis glyphs ending truncated layouts
+		int _ellipsisCount;
+		// Glyph images waiting for upload() (RGBA32, in glyph order)
+		std::vector<Uint8> _bakedPixels;
+		// Whether glyph images go straight to the atlas
+		bool _uploaded;
+		// Layout of the last queueText() call (storage is reused)
+		TextLayout _scratchLayout;
+
+		// Get the font glyphs are rasterized with, opening it if needed
+		TrueTypeFont * getTrueTypeFont(void);
+		// Forget every cached glyph, before baking them again
+		void clearGlyphs(void);
+		// Rasterize preloaded glyphs & compute their kerning
+		void bake(void);
+		// Get the cache file path for this font ("" if the font is missing)
+		std::string computeCachePath(std::string const & cacheDirectory);
+		// Restore baked glyphs & atlas from a cache file
+		bool loadCache(std::string const & path);
+		// Write baked glyphs & atlas to a cache file
+		void saveCache(std::string const & path);
+
+		// Find the index of a cached glyph (BITMAP_FONT_NO_GLYPH on miss)
+		Uint32 findGlyph(Uint32 const codepoint) const;
+		// Map a codepoint to a glyph index in the hash table
+		void insertSlot(Uint32 const codepoint, Uint32 const glyph);
+		// Render a glyph image (to be freed by the caller)
+		SDL_Surface * renderGlyph(Uint32 const codepoint);
+		// Rasterize a glyph into the atlas (or stage it until upload())
+		void rasterize(Glyph & glyph);
+		// Get the glyph index for a codepoint, rasterizing it if needed
+		Uint32 getGlyphIndex(Uint32 const codepoint);
+		// Cache the glyph of a codepoint missing from the glyph cache
+		Uint32 addGlyph(Uint32 const codepoint);
+		// Get a cached glyph, rasterizing it again if evicted
+		Glyph const & resolveGlyph(Uint32 const index);
+		// Get a cached glyph to draw, falling back on rasterization failure
+		Glyph const * resolveDrawnGlyph(Uint32 const index);
+		// Build the kerning pairs between every cached glyph
+		void buildKerningPairs(void);
+		// Get the pen adjustment between two glyphs
+		int getKerning(Glyph const & left, Glyph const & right) const;
 
 		/*
-		 * Internal method to compute max number of chars we can put into one
-		 * line, whose width (in pixel) is passed as a parameter
+		 * Internal method to find where the line starting at 'begin' ends,
+		 * whose width (in pixel) is passed as a parameter. 'next' is set to
+		 * the beginning of the following line.
 		 */
-		unsigned int computeLineEnd(
-			std::string const & text,
-			unsigned int startPoint,
-			unsigned int maxWidthPx) const;
+		std::size_t computeLineEnd(
+			std::string_view const text,
+			std::size_t const begin,
+			int const maxWidth,
+			std::size_t & next);
+		// Measure a line, trailing blanks excluded
+		int measureLine(
+			std::string_view const text,
+			std::size_t const begin,
+			std::size_t const end,
+			std::size_t & visibleEnd,
+			int & gaps);
+		// Find where a line must be cut to fit in a given width
+		std::size_t truncateLine(
+			std::string_view const text,
+			std::size_t const begin,
+			std::size_t const end,
+			int const maxWidth);
+		// Break & align lines, placing glyphs into 'layout' if not nullptr
+		SDL_Rect layoutLines(
+			std::string_view const text,
+			int const width,
+			int const height,
+			TextLayout::Options const & options,
+			TextLayout * layout);
 
 	public:
 		/* Constructors & destructor */
 		// May throw
 		BitmapFont(std::shared_ptr<TrueTypeFontManager> ttfManager,
 			std::string const & name, int size,
-			SDL_Renderer * renderer);
+			SDL_Renderer * renderer,
+			RenderMode const renderMode = SOLID,
+			std::string const & cacheDirectory = std::string(),
+			std::shared_ptr<GlyphAtlas> atlas = nullptr,
+			TrueTypeFont * bakingFont = nullptr);
 		BitmapFont(BitmapFont const & other) = delete;
 		BitmapFont(BitmapFont && other);
 		BitmapFont & operator = (BitmapFont const &) = delete;
 		BitmapFont & operator = (BitmapFont &&) = delete;
 		~BitmapFont(void);
 
+		// Upload glyphs baked with a 'bakingFont' (renderer thread), into
+		// 'atlas' if its pages fit the font
+		void upload(std::shared_ptr<GlyphAtlas> const & atlas = nullptr);
+
 		/* Rendering methods */
-		// Render text on attached renderer using destination rectangle
-		void renderText(std::string const & text,
+		// Render UTF-8 text on attached renderer using destination rectangle
+		void renderText(std::string_view const text,
 			SDL_Color const & color,
 			SDL_Rect const & destination);
-		// Render the whole font texture at destination coordinates
-		void renderDebug(
+		// Lay UTF-8 text out into the glyph batch, without drawing it yet
+		void queueText(std::string_view const text,
+			SDL_Color const & color,
+			SDL_Rect const & destination);
+		// Compute line breaks & glyph positions of UTF-8 text
+		void layoutText(std::string_view const text,
+			int const width,
+			int const height,
+			TextLayout & layout,
+			TextLayout::Options const & options = TextLayout::Options());
+		// Compute the area UTF-8 text would cover, without laying it out
+		SDL_Rect measureText(std::string_view const text,
+			int const width,
+			int const height,
+			TextLayout::Options const & options = TextLayout::Options());
+		// Queue a layout computed with this font, without drawing it yet
+		void queueLayout(TextLayout const & layout,
+			SDL_Color const & color,
+			int const x,
+			int const y);
+		// Draw every queued glyph, one draw call per atlas page (glyphs of
+		// fonts sharing the atlas included)
+		void flush(void);
+		// Check whether glyphs are waiting for flush()
+		bool hasQueuedGlyphs(void) const;
+		// Render every atlas page at destination coordinates, returning the
+		// number of glyph areas outlined
+		std::size_t renderDebug(
 			int const xDest,
 			int const yDest);
 
 		/* Getters */
-		// Get the whole font texture
+		// Get the first atlas page
 		Texture const * getTexture(void);
-		// Get all character clips
-		std::array<SDL_Rect, UCHAR_MAX> getClips(void) const;
+		// Get the glyph atlas
+		GlyphAtlas * getAtlas(void);
+		// Get the number of glyphs rasterized so far
+		std::size_t getGlyphCount(void) const;
+		// Get max height for one line
+		int getLineSkip(void) const;
+		// Get the atlas page size fitting the font
+		int getPageSize(void) const;
+		// Get how glyphs are rasterized
+		RenderMode getRenderMode(void) const;
 };
 
 #endif // BITMAP_FONT_HPP_INCLUDED
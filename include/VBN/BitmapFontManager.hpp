@@ -2,7 +2,9 @@
 #define BITMAP_FONT_MANAGER_HPP_INCLUDED
 
 #include <map>
+#include <mutex>
 #include <string>
+#include <tuple>
 #include <vector>
 #include <VBN/BitmapFont.hpp>
 
@@ -13,7 +15,18 @@ class BitmapFontManager
 	private:
 		SDL_Renderer * _renderer;
 		std::shared_ptr<TrueTypeFontManager> _trueTypeFontManager;
-		std::map<std::pair<std::string, int>, BitmapFont> _fonts;
+		// Fonts, by name, size & render mode
+		std::map<std::tuple<std::string, int, BitmapFont::RenderMode>,
+			BitmapFont> _fonts;
+		// Render mode of fonts returned by getFont() & findFont()
+		BitmapFont::RenderMode _renderMode;
+		// Directory baked fonts are cached into ("" = no cache)
+		std::string _cacheDirectory;
+		// Atlas pages shared by every font, by render mode
+		std::map<BitmapFont::RenderMode, std::shared_ptr<GlyphAtlas>> _atlases;
+
+		// Get (or create) the atlas shared by fonts of the current render mode
+		std::shared_ptr<GlyphAtlas> getSharedAtlas(int const pageSize);
 
 	public:
 		// May throw
@@ -25,8 +38,21 @@ class BitmapFontManager
 		BitmapFontManager & operator = (BitmapFontManager &&) = delete;
 		~BitmapFontManager(void);
 
-		void preload(std::vector<std::pair<std::string, int>> const fonts);
+		void preload(std::vector<std::pair<std::string, int>> const fonts,
+			std::recursive_mutex * rendererMutex = nullptr);
 		BitmapFont * getFont(std::string const & name, int const size);
+		BitmapFont * findFont(std::string const & name, int const size);
+
+		// Select which render mode fonts are looked up & generated with
+		void setRenderMode(BitmapFont::RenderMode const renderMode);
+		BitmapFont::RenderMode getRenderMode(void) const;
+
+		// Cache baked fonts into a directory, so that later runs skip baking
+		void setCacheDirectory(std::string const & cacheDirectory);
+		std::string const & getCacheDirectory(void) const;
+
+		// Get usage of the atlas shared by fonts of the current render mode
+		GlyphAtlas::Occupancy getAtlasOccupancy(void) const;
 };
 
 #endif // BITMAP_FONT_MANAGER_HPP_INCLUDED
@@ -7,12 +7,14 @@
 #include <deque>
 
 class IGameContext;
+class ResolutionController;
 
 class Engine
 {
 	private:
 		std::vector<std::shared_ptr<IGameContext>> _stack;
 		std::deque<Uint32> _msPerFrame;
+		std::shared_ptr<ResolutionController> _resolutionController;
 
 	public:
 		Engine(std::shared_ptr<IGameContext> initialContext);
@@ -26,6 +28,9 @@ class Engine
 
 		Uint32 getAverageMillisecondsPerFrame(void);
 		Uint32 getInstantMillisecondsPerFrame(void);
+
+		void setResolutionController(
+			std::shared_ptr<ResolutionController> controller);
 };
 
 #endif // GAME_CONTEXT_MANAGER_HPP_INCLUDED
@@ -0,0 +1,109 @@
+#ifndef FRAME_CAPTURE_HPP_INCLUDED
+#define FRAME_CAPTURE_HPP_INCLUDED
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <SDL2/SDL_render.h>
+
+/*!
+ * Asynchronous screenshot writer
+ *
+ * Each instance of this class reads rendered frames back into pooled system
+ * memory buffers, and hands them over to a background thread which encodes
+ * them (PNG or QOI) & writes them to disk : the rendering thread only pays for
+ * the readback itself. At most 'maxPending' frames can wait for encoding ;
+ * further captures are dropped instead of stalling the frame.
+ *
+ * Readback relies on SDL_RenderReadPixels(), which is supported by every SDL
+ * renderer including the software one : captures work in headless runs (e.g.
+ * SDL_VIDEODRIVER=dummy with a software Renderer).
+ */
+class FrameCapture
+{
+	public:
+		//! Image file formats
+		enum Format
+		{
+			//! Portable Network Graphics (through SDL_image)
+			PNG,
+			//! Quite OK Image format (fast, lossless)
+			QOI
+		};
+
+	private:
+		//! Single frame waiting for encoding
+		struct Frame
+		{
+			//! Destination file
+			std::string path;
+			//! Destination file format
+			Format format;
+			//! Frame width
+			int width;
+			//! Frame height
+			int height;
+			//! RGBA32 pixels, tightly packed (pooled buffer)
+			std::vector<Uint8> pixels;
+		};
+
+		//! Encoder thread
+		std::thread _worker;
+		//! Protects every member below
+		std::mutex _mutex;
+		//! Signals new frames, finished frames or shutdown
+		std::condition_variable _condition;
+		//! Frames waiting for the encoder thread
+		std::deque<Frame> _pending;
+		//! Buffers available for readback
+		std::vector<std::vector<Uint8>> _pool;
+		//! Maximum number of frames read back but not written yet
+		std::size_t _maxPending;
+		//! Number of frames read back but not written yet
+		std::size_t _inFlight;
+		//! Number of frames dropped because too many were in flight
+		Uint32 _dropped;
+		//! Whether the encoder thread must exit
+		bool _stopping;
+
+		//! Encoder thread main loop
+		void work(void);
+
+		//! Encode & write a frame (may throw)
+		static void write(Frame & frame);
+		//! Write a frame as a QOI file (may throw)
+		static void writeQOI(Frame const & frame);
+		//! Write a frame as a PNG file (may throw)
+		static void writePNG(Frame & frame);
+
+	public:
+		//! Build a FrameCapture and start its encoder thread
+		FrameCapture(std::size_t const maxPending);
+		//! Write pending frames, stop encoder thread & delete instance
+		~FrameCapture(void);
+		FrameCapture(FrameCapture const &) = delete;
+		FrameCapture(FrameCapture &&) = delete;
+		FrameCapture & operator = (FrameCapture const &) = delete;
+		FrameCapture & operator = (FrameCapture &&) = delete;
+
+		//! Read the rendering output back & queue it for writing
+		bool capture(
+			SDL_Renderer * renderer,
+			std::string const & path,
+			Format const format);
+
+		//! Wait until every queued frame was written
+		void flush(void);
+		//! Get the number of frames read back but not written yet
+		std::size_t getPendingCount(void);
+		//! Get the number of frames dropped so far
+		Uint32 getDroppedCount(void);
+
+		//! Guess an image file format from its extension (PNG by default)
+		static Format formatFromPath(std::string const & path);
+};
+
+#endif // FRAME_CAPTURE_HPP_INCLUDED
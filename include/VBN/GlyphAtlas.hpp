@@ -0,0 +1,182 @@
+#ifndef GLYPH_ATLAS_HPP_INCLUDED
+#define GLYPH_ATLAS_HPP_INCLUDED
+
+#include <vector>
+#include <SDL2/SDL_render.h>
+#include <VBN/Texture.hpp>
+
+/*!
+ * Set of glyph atlas pages filled on demand
+ *
+ * Each page is a square RGBA32 Texture, filled with a shelf packer : glyph
+ * images are stacked from left to right into horizontal shelves, a new shelf
+ * being opened below the last one when no existing shelf fits. When every page
+ * is full and no new page may be created, the least recently used page which
+ * is not pinned is cleared & reused.
+ *
+ * Allocations are identified by (page, generation) : clearing a page bumps its
+ * generation, so that owners can detect evicted glyphs with isValid() instead
+ * of being notified.
+ *
+ * Textured quads are accumulated per page, then drawn with one
+ * SDL_RenderGeometry() call per page by flush().
+ *
+ * Premultiplied atlases store color multiplied by alpha, and blend with
+ * (ONE, ONE_MINUS_SRC_ALPHA) : anti-aliased edges then filter & blend without
+ * dark fringes. Renderers which do not support this blending mode (e.g. the
+ * software renderer) get straight alpha & SDL_BLENDMODE_BLEND instead.
+ *
+ * An atlas may be shared by several fonts (see BitmapFontManager) : texts
+ * printed with different fonts are then drawn by the same per-page calls.
+ */
+class GlyphAtlas
+{
+	public:
+		//! Area allocated in a page
+		struct Region
+		{
+			//! Page index
+			Uint16 page;
+			//! Page generation at allocation time
+			Uint16 generation;
+			//! Area in the page
+			SDL_Rect area;
+		};
+
+		//! Page usage, for tuning page size & count
+		struct Occupancy
+		{
+			//! Number of pages created
+			std::size_t pageCount;
+			//! Maximum number of pages
+			std::size_t maxPageCount;
+			//! Number of pages which may not be evicted
+			std::size_t pinnedPageCount;
+			//! Allocated area (padding included), in pixels
+			std::size_t usedArea;
+			//! Area of the created pages, in pixels
+			std::size_t totalArea;
+		};
+
+		//! Rendering work done by a flush() call
+		struct FlushStats
+		{
+			//! SDL draw calls issued (one per page with queued quads)
+			Uint32 drawCalls;
+			//! Quads drawn
+			Uint32 quads;
+			//! Texture of the first page drawn (nullptr if none)
+			SDL_Texture const * firstTexture;
+			//! Texture of the last page drawn (nullptr if none)
+			SDL_Texture const * lastTexture;
+		};
+
+	private:
+		//! Horizontal strip of a page
+		struct Shelf
+		{
+			//! Top of the shelf
+			int y;
+			//! Height of the shelf
+			int height;
+			//! Left of the free part of the shelf
+			int x;
+		};
+
+		//! Single atlas page
+		struct Page
+		{
+			//! Page pixels
+			Texture texture;
+			//! Shelves, top to bottom
+			std::vector<Shelf> shelves;
+			//! Top of the free part of the page
+			int nextShelfY;
+			//! Incremented each time the page is cleared
+			Uint16 generation;
+			//! Last use stamp (see touch())
+			Uint32 lastUse;
+			//! Whether the page may be evicted
+			bool pinned;
+			//! Textured quads waiting for flush()
+			std::vector<SDL_Vertex> vertices;
+			//! Vertex indices, six per quad
+			std::vector<int> indices;
+		};
+
+		//! Raw SDL_Renderer pages are created for
+		SDL_Renderer * _sdlRenderer;
+		//! Width & height of every page
+		int _pageSize;
+		//! Maximum number of pages
+		std::size_t _maxPages;
+		//! Pages, in creation order
+		std::vector<Page> _pages;
+		//! Incremented on each touch()
+		Uint32 _useStamp;
+		//! Whether pages were requested to hold premultiplied alpha
+		bool _premultiplied;
+		//! Whether pages actually hold premultiplied alpha (false when the
+		//! renderer rejects the premultiplied blending mode)
+		bool _premultiplyPixels;
+		//! Premultiplied pixels staging (storage is reused)
+		std::vector<Uint8> _uploadBuffer;
+
+		//! Add an empty page
+		void addPage(void);
+		//! Reset a page to an empty state
+		void clearPage(Page & page);
+		//! Try allocating an area in a given page
+		bool allocateInPage(
+			Page & page,
+			int const width,
+			int const height,
+			SDL_Rect & area);
+
+	public:
+		//! Build an empty GlyphAtlas
+		GlyphAtlas(
+			SDL_Renderer * renderer,
+			int const pageSize,
+			std::size_t const maxPages,
+			bool const premultiplied = false);
+		//! Move a GlyphAtlas instance
+		GlyphAtlas(GlyphAtlas && other);
+		//! Delete a GlyphAtlas instance
+		~GlyphAtlas(void);
+		GlyphAtlas(GlyphAtlas const &) = delete;
+		GlyphAtlas & operator = (GlyphAtlas const &) = delete;
+		GlyphAtlas & operator = (GlyphAtlas &&) = delete;
+
+		//! Allocate an area & fill it with a glyph image
+		Region insert(SDL_Surface * image);
+		//! Check whether an allocated area still holds its glyph
+		bool isValid(Region const & region) const;
+		//! Mark a page as used (LRU eviction)
+		void touch(Uint16 const page);
+		//! Prevent pages from being evicted (all or none)
+		void pinPages(std::vector<Uint16> const & pages);
+
+		//! Queue a textured quad for the next flush()
+		void addQuad(
+			Region const & region,
+			SDL_FRect const & destination,
+			SDL_Color const & color);
+		//! Draw every queued quad, one draw call per page
+		FlushStats flush(void);
+		//! Check whether quads are waiting for flush()
+		bool hasQueuedQuads(void) const;
+
+		//! Get the number of pages
+		std::size_t getPageCount(void) const;
+		//! Get a page Texture
+		Texture * getPage(std::size_t const index);
+		//! Get the width & height of every page
+		int getPageSize(void) const;
+		//! Check whether pages hold premultiplied alpha
+		bool isPremultiplied(void) const;
+		//! Get page usage
+		Occupancy getOccupancy(void) const;
+};
+
+#endif // GLYPH_ATLAS_HPP_INCLUDED
@@ -0,0 +1,89 @@
+#ifndef IMAGE_LOADER_HPP_INCLUDED
+#define IMAGE_LOADER_HPP_INCLUDED
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <SDL2/SDL_stdinc.h>
+#include <VBN/Surface.hpp>
+
+class Texture;
+
+/*!
+ * Background image decoder
+ *
+ * Each instance of this class runs a pool of worker threads, which decode
+ * image files into Surfaces and convert them to the pixel format expected by
+ * the Renderer. Decoded images are collected on the main thread with
+ * collect(), where they can be uploaded into Textures : SDL_Renderer calls
+ * never happen on worker threads.
+ */
+class ImageLoader
+{
+	public:
+		//! Single image load request
+		struct Job
+		{
+			//! Name of the Texture to build
+			std::string name;
+			//! Path to image file
+			std::string path;
+			//! Pixel format to convert the image to
+			Uint32 format;
+			//! Decoded image (set by a worker thread on success)
+			std::unique_ptr<Surface> surface;
+			//! Decoding error (set by a worker thread on failure)
+			std::exception_ptr error;
+			//! Fulfilled on the main thread once the Texture is uploaded
+			std::promise<Texture *> promise;
+		};
+
+	private:
+		//! Worker threads
+		std::vector<std::thread> _workers;
+		//! Protects every member below
+		std::mutex _mutex;
+		//! Signals new jobs or shutdown to worker threads
+		std::condition_variable _condition;
+		//! Jobs waiting for a worker thread
+		std::deque<Job> _pending;
+		//! Jobs decoded (or failed), waiting for collect()
+		std::deque<Job> _done;
+		//! Number of jobs currently being decoded
+		std::size_t _running;
+		//! Whether worker threads must exit
+		bool _stopping;
+
+		//! Worker thread main loop
+		void work(void);
+
+	public:
+		//! Build an ImageLoader and start its worker threads
+		ImageLoader(unsigned int const threadCount);
+		//! Stop worker threads & delete an ImageLoader instance
+		~ImageLoader(void);
+		ImageLoader(ImageLoader const &) = delete;
+		ImageLoader(ImageLoader &&) = delete;
+		ImageLoader & operator = (ImageLoader const &) = delete;
+		ImageLoader & operator = (ImageLoader &&) = delete;
+
+		//! Queue an image for decoding
+		std::shared_future<Texture *> load(
+			std::string const & name,
+			std::string const & path,
+			Uint32 const format);
+
+		//! Take decoded (or failed) jobs, at most 'count' of them
+		std::vector<Job> collect(std::size_t const count);
+
+		//! Get the number of jobs not collected yet
+		std::size_t getBacklog(void);
+};
+
+#endif // IMAGE_LOADER_HPP_INCLUDED
@@ -0,0 +1,70 @@
+#ifndef LAYER_HPP_INCLUDED
+#define LAYER_HPP_INCLUDED
+
+#include <functional>
+#include <SDL2/SDL_render.h>
+#include <VBN/Texture.hpp>
+
+class Renderer;
+
+/*!
+ * Cached render-to-texture drawing layer
+ *
+ * Each instance of this class owns an SDL_TEXTUREACCESS_TARGET Texture and a
+ * painter callback. The painter is only replayed into the Texture when the
+ * Layer has been invalidated ("dirty"); otherwise the Layer is composited onto
+ * the rendering space with a single copy (see Renderer::copyLayer()).
+ *
+ * The Texture holds premultiplied colors (what blended draw calls leave in a
+ * transparent target) and is composited with the matching blending mode.
+ * Fading the Texture thus takes the same color & alpha modulation.
+ */
+class Layer
+{
+	public:
+		//! Drawing callback, invoked with the Renderer targeting the Layer
+		typedef std::function<void(Renderer &)> Painter;
+
+	private:
+		//! Render target holding the cached drawing
+		Texture _texture;
+		//! Callback issuing the draw calls of the Layer
+		Painter _painter;
+		//! Whether the cached drawing must be repainted before next copy
+		bool _dirty;
+		//! Incremented each time the cached drawing is repainted
+		Uint32 _revision;
+
+	public:
+		//! Build a Layer of the given dimensions
+		Layer(
+			SDL_Renderer * renderer,
+			int const width,
+			int const height,
+			Painter const & painter);
+		//! Move a Layer instance
+		Layer(Layer && other);
+		//! Delete a Layer instance
+		~Layer(void);
+		Layer(Layer const &) = delete;
+		Layer & operator = (Layer const &) = delete;
+		Layer & operator = (Layer &&) = delete;
+
+		//! Mark the cached drawing as outdated
+		void invalidate(void);
+		//! Mark the cached drawing as up-to-date
+		void validate(void);
+		//! Check whether the cached drawing is outdated
+		bool isDirty(void) const;
+
+		//! Get underlying render target Texture
+		Texture & getTexture(void);
+		//! Get cached drawing revision
+		Uint32 getRevision(void) const;
+		//! Get painter callback
+		Painter const & getPainter(void) const;
+		//! Replace painter callback (invalidates the Layer)
+		void setPainter(Painter const & painter);
+};
+
+#endif // LAYER_HPP_INCLUDED
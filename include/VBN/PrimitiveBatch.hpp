@@ -0,0 +1,75 @@
+#ifndef PRIMITIVE_BATCH_HPP_INCLUDED
+#define PRIMITIVE_BATCH_HPP_INCLUDED
+
+#include <vector>
+#include <SDL2/SDL_render.h>
+
+/*!
+ * Colored primitives accumulated into a single triangle list
+ *
+ * Each primitive is converted into colored triangles, so that a whole batch
+ * of points, lines and rectangles of different colors can be drawn with a
+ * single SDL_RenderGeometry() call (see Renderer::drawBatch()). Instances are
+ * meant to be cleared & refilled every frame : clear() keeps the allocated
+ * storage.
+ */
+class PrimitiveBatch
+{
+	private:
+		//! Colored vertices
+		std::vector<SDL_Vertex> _vertices;
+		//! Vertex indices, three per triangle
+		std::vector<int> _indices;
+
+		//! Append a colored quad (corners in drawing order)
+		void addQuad(
+			SDL_FPoint const & a,
+			SDL_FPoint const & b,
+			SDL_FPoint const & c,
+			SDL_FPoint const & d,
+			SDL_Color const & color);
+
+	public:
+		//! Build an empty PrimitiveBatch
+		PrimitiveBatch(void);
+		//! Move a PrimitiveBatch instance
+		PrimitiveBatch(PrimitiveBatch && other);
+		//! Delete a PrimitiveBatch instance
+		~PrimitiveBatch(void);
+		PrimitiveBatch(PrimitiveBatch const &) = delete;
+		PrimitiveBatch & operator = (PrimitiveBatch const &) = delete;
+		PrimitiveBatch & operator = (PrimitiveBatch &&) = delete;
+
+		//! Remove every primitive (keeps allocated storage)
+		void clear(void);
+		//! Check whether the batch holds no primitive
+		bool isEmpty(void) const;
+
+		//! Add a single pixel
+		void addPoint(int const x, int const y, SDL_Color const & color);
+		//! Add a line (end points included)
+		void addLine(
+			int const x1,
+			int const y1,
+			int const x2,
+			int const y2,
+			SDL_Color const & color,
+			float const thickness = 1.f);
+		//! Add a rectangle outline
+		void addRect(SDL_Rect const & rectangle, SDL_Color const & color);
+		//! Add a filled rectangle
+		void addFilledRect(SDL_Rect const & rectangle, SDL_Color const & color);
+		//! Add a filled triangle
+		void addTriangle(
+			SDL_FPoint const & a,
+			SDL_FPoint const & b,
+			SDL_FPoint const & c,
+			SDL_Color const & color);
+
+		//! Get colored vertices
+		std::vector<SDL_Vertex> const & getVertices(void) const;
+		//! Get vertex indices
+		std::vector<int> const & getIndices(void) const;
+};
+
+#endif // PRIMITIVE_BATCH_HPP_INCLUDED
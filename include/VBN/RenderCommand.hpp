@@ -0,0 +1,140 @@
+#ifndef RENDER_COMMAND_HPP_INCLUDED
+#define RENDER_COMMAND_HPP_INCLUDED
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <SDL2/SDL_render.h>
+
+class BitmapFont;
+class TextLayout;
+
+/*!
+ * Single Renderer draw call, as submitted by the public Renderer API
+ *
+ * Each instance of this class aggregates everything needed to execute a draw
+ * call at a later point (e.g. when replaying damaged regions in partial redraw
+ * mode). Renderer state changes recorded in render thread mode are commands
+ * too, so that they apply in order with the draw calls around them, as are
+ * the SDL_Renderer tasks (uploads, Layer repaints, TileMap bakes) the game
+ * thread hands over to the render thread. Fields
+ * which are irrelevant for a given Type are left zeroed so that two commands
+ * can be compared field-by-field.
+ */
+struct RenderCommand
+{
+	//! Kind of draw call
+	enum Type
+	{
+		//! Clear the whole rendering space with 'color'
+		CLEAR,
+		//! Fill the whole rendering space with 'color'
+		FILL,
+		//! Fill 'destination' with 'color'
+		FILL_RECT,
+		//! Draw 'destination' outline with 'color'
+		DRAW_RECT,
+		//! Draw a line from 'start' to 'end' with 'color'
+		DRAW_LINE,
+		//! Draw every point of 'points' with 'color'
+		DRAW_POINTS,
+		//! Draw a polyline joining 'points' with 'color'
+		DRAW_LINES,
+		//! Draw every rectangle outline of 'rects' with 'color'
+		DRAW_RECTS,
+		//! Fill every rectangle of 'rects' with 'color'
+		FILL_RECTS,
+		//! Draw 'vertices' triangles (indexed by 'indices' if not empty)
+		GEOMETRY,
+		//! Copy 'source' area of 'texture' to 'destination'
+		COPY,
+		//! Copy 'source' area of 'texture' to 'destination' (extended)
+		COPY_EX,
+		//! Print 'text' (or 'layout') with 'font' & 'color' into 'destination'
+		TEXT,
+		//! Print the whole 'font' texture at 'destination' position
+		FONT_DEBUG,
+		//! Set renderer logical size to 'destination' dimensions
+		SET_LOGICAL_SIZE,
+		//! Set renderer viewport to 'destination'
+		SET_VIEWPORT,
+		//! Reset renderer viewport to the whole rendering target
+		RESET_VIEWPORT,
+		//! Set renderer scale to 'scale'
+		SET_SCALE,
+		//! Run 'task' on the SDL_Renderer (render thread mode)
+		TASK
+	};
+
+	//! Kind of draw call
+	Type type;
+	//! Drawing color (primitives) or text color (text)
+	SDL_Color color;
+	//! Drawing blending mode (primitives) or source texture blending mode
+	//! (copies recorded in partial redraw mode)
+	SDL_BlendMode blendMode;
+	//! Source texture (copies)
+	SDL_Texture * texture;
+	//! Source texture contents revision, used to detect repainted textures
+	Uint32 revision;
+	//! Source texture color & alpha modulation (copies recorded in partial
+	//! redraw mode)
+	SDL_Color modulation;
+	//! Source area in 'texture' (copies)
+	SDL_Rect source;
+	//! Destination area
+	SDL_Rect destination;
+	//! Line start point
+	SDL_Point start;
+	//! Line end point
+	SDL_Point end;
+	//! Rotation angle in degrees (extended copies)
+	double angle;
+	//! Rotation center, relative to 'destination' (extended copies)
+	SDL_Point center;
+	//! Flip flags (extended copies)
+	SDL_RendererFlip flip;
+	//! Horizontal & vertical renderer scale (scale changes)
+	SDL_FPoint scale;
+	//! Font to print with (text)
+	BitmapFont * font;
+	//! Text to print (text)
+	std::string text;
+	//! Pre-computed layout to print instead of 'text' (text)
+	std::shared_ptr<TextLayout const> layout;
+	//! Points (point & polyline batches)
+	std::vector<SDL_Point> points;
+	//! Rectangles (rectangle batches)
+	std::vector<SDL_Rect> rects;
+	//! Colored vertices (geometry)
+	std::vector<SDL_Vertex> vertices;
+	//! Vertex indices (geometry)
+	std::vector<int> indices;
+	//! SDL_Renderer work to run in order with draw calls (tasks)
+	std::function<void(void)> task;
+	//! Area of the rendering space affected by the draw call
+	SDL_Rect bounds;
+
+	//! Build a zeroed command of the given type
+	RenderCommand(Type const type);
+
+	//! Compute the area affected by the draw call, within 'canvas'
+	SDL_Rect computeBounds(SDL_Rect const & canvas) const;
+
+	//! Hash the fields compared by operator ==
+	std::size_t hash(void) const;
+
+	//! Check whether two commands would produce the same pixels
+	bool operator == (RenderCommand const & other) const;
+	//! Check whether two commands would produce different pixels
+	bool operator != (RenderCommand const & other) const;
+
+	//! Check whether the command is a renderer state change
+	bool isStateChange(void) const;
+	//! Check whether the command must run even if its frame is replaced
+	bool isPersistent(void) const;
+};
+
+#endif // RENDER_COMMAND_HPP_INCLUDED
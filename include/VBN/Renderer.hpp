@@ -1,9 +1,28 @@
 #ifndef RENDERER_HPP_INCLUDED
 #define RENDERER_HPP_INCLUDED
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <SDL2/SDL_render.h>
 #include <VBN/Texture.hpp>
+#include <VBN/StreamingTexture.hpp>
+#include <VBN/FrameCapture.hpp>
+#include <VBN/ImageLoader.hpp>
+#include <VBN/TexturePack.hpp>
+#include <VBN/Layer.hpp>
+#include <VBN/TileMap.hpp>
+#include <VBN/PrimitiveBatch.hpp>
+#include <VBN/RenderCommand.hpp>
 #include <VBN/BitmapFontManager.hpp>
 
 /*!
@@ -15,7 +34,139 @@
  */
 class Renderer
 {
+	public:
+		//! Per-frame copy culling counters
+		struct CullingStats
+		{
+			//! Copies submitted to SDL
+			Uint32 drawn;
+			//! Copies rejected for lying outside the visible area
+			Uint32 culled;
+		};
+
+		//! Per-frame rendering counters
+		struct RenderStats
+		{
+			//! SDL draw calls issued
+			Uint32 drawCalls;
+			//! Primitives drawn (points, lines, rectangles, triangles, copies)
+			Uint32 primitives;
+			//! Textured draw calls using another texture than the previous one
+			Uint32 textureSwitches;
+			//! Primitive draw calls using another blend mode than the previous one
+			Uint32 blendChanges;
+			//! Rendering target changes issued by the Renderer
+			Uint32 targetSwitches;
+			//! Texture uploads (creations & streaming updates)
+			Uint32 uploads;
+			//! Bytes uploaded to textures
+			Uint64 uploadedBytes;
+			//! Time spent rendering, presentation & vsync wait excluded, in
+			//! milliseconds (render thread : executing the frame's commands ;
+			//! otherwise : calling thread's time since previous present())
+			float renderMilliseconds;
+		};
+
 	private:
+		//! How to rebuild a stored Texture after eviction
+		struct TextureSource
+		{
+			//! Kind of source
+			enum Kind
+			{
+				//! Image file at 'path'
+				IMAGE,
+				//! Latin1-encoded 'text' printed with 'fontName'
+				LATIN1_TEXT,
+				//! UTF-8-encoded 'text' printed with 'fontName'
+				UTF8_TEXT,
+				//! Pre-decoded image 'entry' of the texture pack at 'path'
+				PACKED
+			};
+
+			//! Kind of source
+			Kind kind;
+			//! Image file or texture pack path (images)
+			std::string path;
+			//! Image name within the texture pack (packed images)
+			std::string entry;
+			//! Font name (texts)
+			std::string fontName;
+			//! Printed text (texts)
+			std::string text;
+			//! Text size (texts)
+			int size;
+			//! Text color (texts)
+			SDL_Color color;
+			//! Index of the frame during which the Texture was last used
+			Uint32 lastUsedFrame;
+			//! Whether the Texture must never be evicted (e.g. tilesets)
+			bool pinned;
+
+			//! Build an empty source of the given kind
+			TextureSource(Kind const kind);
+		};
+
+		//! Texture creation waiting for the upload scheduler
+		struct PendingUpload
+		{
+			//! Name of the Texture to build
+			std::string name;
+			//! Source to build the Texture from (if no decoded image)
+			TextureSource source;
+			//! Decoded image to upload (asynchronous loads)
+			std::unique_ptr<Surface> surface;
+			//! Fulfilled once the Texture is uploaded
+			std::promise<Texture *> promise;
+
+			//! Build an upload from a source, without decoded image
+			PendingUpload(std::string const & name, TextureSource const & source);
+		};
+
+		//! Texture creation handed over to the render thread
+		struct ThreadedUpload
+		{
+			//! Texture to create, with its decoded image (if not packed)
+			PendingUpload upload;
+			//! Created Texture (set by the render thread)
+			std::unique_ptr<Texture> texture;
+			//! Creation error (set by the render thread)
+			std::exception_ptr error;
+			//! Performance counter ticks the render thread spent creating it
+			Uint64 ticks;
+			//! Frame whose commands hold the creation task
+			Uint32 frame;
+			//! Whether the Texture was forgotten meanwhile
+			bool dropped;
+
+			//! Build a hand-over of a pending upload
+			ThreadedUpload(PendingUpload && upload, Uint32 const frame);
+		};
+
+		//! Rendering target & state saved while repainting a Layer
+		struct SavedTarget
+		{
+			//! Previous rendering target (nullptr = screen)
+			SDL_Texture * target;
+			//! Previous renderer scale
+			SDL_FPoint scale;
+			//! Previous viewport
+			SDL_Rect viewport;
+			//! Previous clipping rectangle
+			SDL_Rect clip;
+			//! Whether clipping was enabled
+			SDL_bool clipEnabled;
+		};
+
+		//! Layout of a text printed from a plain string
+		struct CachedTextLayout
+		{
+			//! Line breaks & glyph positions
+			TextLayout layout;
+			//! Value of _textLayoutStamp when last printed
+			Uint32 lastUsed;
+		};
+
 		//! Underlying SDL_Renderer enclosed in std::unique_ptr
 		std::unique_ptr<SDL_Renderer, decltype(&SDL_DestroyRenderer)> _renderer;
 		//! BitmapFontManager instance associated with the Renderer
@@ -24,6 +175,248 @@ class Renderer
 		std::shared_ptr<TrueTypeFontManager> _trueTypeFontManager;
 		//! Map of named Texture objects available to copy on the Renderer
 		std::map<std::string, Texture> _textures;
+		//! Sources of the named Texture objects, for reload after eviction
+		std::map<std::string, TextureSource> _textureSources;
+		//! Memory-mapped texture packs, by path
+		std::map<std::string, TexturePack> _texturePacks;
+		//! Map of named StreamingTexture objects available to copy on the Renderer
+		std::map<std::string, StreamingTexture> _streamingTextures;
+		//! Map of named cached Layer objects available to copy on the Renderer
+		std::map<std::string, Layer> _layers;
+		//! Map of named TileMap objects available to draw on the Renderer
+		std::map<std::string, TileMap> _tileMaps;
+
+		//! Current drawing color, applied when executing primitives
+		SDL_Color _drawColor;
+		//! Current drawing blending mode, applied when executing primitives
+		SDL_BlendMode _blendMode;
+		//! Nesting depth of Layer repaints (their draw calls are never deferred)
+		int _layerDepth;
+
+		//! Copy culling counters of the current frame
+		CullingStats _cullingStats;
+		//! Copy culling counters of the last presented frame
+		CullingStats _lastCullingStats;
+		//! Rendering counters of the current frame
+		RenderStats _renderStats;
+		//! Rendering counters of the last presented frame
+		RenderStats _lastRenderStats;
+		//! Performance counter when rendering of the current frame started
+		Uint64 _renderStartTicks;
+		//! Texture used by the last textured draw call (texture switches)
+		SDL_Texture const * _lastTexture;
+		//! Blend mode used by the last primitive draw call (blend changes)
+		SDL_BlendMode _lastBlendMode;
+		//! Glyph atlas whose quads are batched but not drawn yet
+		GlyphAtlas * _pendingTextAtlas;
+		//! Layouts of plain string texts, by content hash
+		std::unordered_map<std::size_t, CachedTextLayout> _textLayouts;
+		//! Incremented each executed frame (text layout cache aging)
+		Uint32 _textLayoutStamp;
+
+		//! Index of the current frame
+		Uint32 _frame;
+		//! Bytes held by loaded named Texture objects
+		std::size_t _textureBytes;
+		//! Maximum bytes held by named Texture objects (0 = unlimited)
+		std::size_t _textureBudget;
+		//! Frames a Texture must stay unused before being evicted
+		Uint32 _textureIdleFrames;
+
+		//! Background image decoder (started on first asynchronous load)
+		std::unique_ptr<ImageLoader> _imageLoader;
+		//! Names of the Texture objects being decoded or waiting for upload
+		std::set<std::string> _loadingTextures;
+		//! Pixel format decoded images are converted to
+		Uint32 _uploadFormat;
+		//! Texture creations waiting for the upload scheduler, oldest first
+		std::deque<PendingUpload> _uploadQueue;
+		//! Texture creations handed over to the render thread, oldest first
+		std::deque<std::shared_ptr<ThreadedUpload>> _threadedUploads;
+		//! Maximum bytes uploaded per frame by the scheduler (0 = unlimited)
+		std::size_t _uploadBudgetBytes;
+		//! Maximum time spent per frame by the scheduler (0 = unlimited)
+		Uint32 _uploadBudgetMicroseconds;
+		//! Bytes uploaded during the current frame
+		std::size_t _uploadBytesSpent;
+		//! Performance counter ticks spent uploading during the current frame
+		Uint64 _uploadTicksSpent;
+
+		//! Serializes SDL_Renderer access between game & render threads
+		std::recursive_mutex _sdlMutex;
+		//! Protects font glyph tables & _textLayouts (text layout & measurement
+		//! from the game thread, text commands on the render thread)
+		std::mutex _textMutex;
+		//! Protects _lastRenderStats
+		mutable std::mutex _statsMutex;
+		//! Thread executing presented frames (render thread mode)
+		std::thread _renderThread;
+		//! Protects the frame mailbox & render thread feedback below
+		std::mutex _frameMutex;
+		//! Signals queued frames, completed frames & shutdown
+		std::condition_variable _frameCondition;
+		//! Draw calls of the last presented frame, not taken yet
+		std::vector<RenderCommand> _queuedCommands;
+		//! Draw calls being executed by the render thread
+		std::vector<RenderCommand> _executedCommands;
+		//! Whether _queuedCommands holds a frame not taken yet
+		bool _frameQueued;
+		//! Index of the frame held by _queuedCommands
+		Uint32 _queuedFrame;
+		//! Whether the render thread must exit
+		bool _renderThreadStopping;
+		//! Index following the last frame executed by the render thread
+		std::atomic<Uint32> _completedFrames;
+		//! Frames replaced in the mailbox before the render thread took them
+		Uint32 _droppedFrames;
+		//! Visible area measured by the render thread after its last frame
+		SDL_Rect _renderThreadViewport;
+		//! Visible area used to cull draw calls in render thread mode
+		SDL_Rect _visibleArea;
+		//! Frame during which a renderer state change was last recorded
+		Uint32 _stateChangeFrame;
+
+		//! Persistent render target used by the partial redraw mode
+		std::unique_ptr<Texture> _canvas;
+		//! Draw calls recorded during the current frame (partial redraw mode)
+		std::vector<RenderCommand> _commands;
+		//! Draw calls recorded during the previous frame (partial redraw mode)
+		std::vector<RenderCommand> _previousCommands;
+		//! (hash, index) of _commands, sorted (partial redraw mode)
+		std::vector<std::pair<std::size_t, std::size_t>> _commandHashes;
+		//! (hash, index) of _previousCommands, sorted (partial redraw mode)
+		std::vector<std::pair<std::size_t, std::size_t>> _previousCommandHashes;
+		//! Canvas regions to redraw at next present() (partial redraw mode)
+		std::vector<SDL_Rect> _damage;
+		//! Canvas regions redrawn during last present() (partial redraw mode)
+		std::vector<SDL_Rect> _lastDamage;
+
+		//! Low-resolution render target (scaled target mode)
+		std::unique_ptr<Texture> _scaledTarget;
+		//! Whether the scaled target is upscaled by integer factors only
+		bool _integerScaling;
+		//! Fraction of the scaled target resolution actually rendered
+		float _renderScale;
+		//! Screen area the scaled target was copied to during last present()
+		SDL_Rect _scaledTargetDestination;
+
+		//! Background frame writer (created on first capture)
+		std::unique_ptr<FrameCapture> _frameCapture;
+		//! File to save the next presented frame to (empty = none)
+		std::string _screenshotPath;
+		//! File name prefix for continuous capture
+		std::string _capturePrefix;
+		//! Save one frame every _captureInterval frames (0 = disabled)
+		Uint32 _captureInterval;
+		//! File format for continuous capture
+		FrameCapture::Format _captureFormat;
+
+		//! Build a Texture from its source
+		Texture buildTexture(TextureSource const & source);
+		//! Build the image of a Texture source (any but PACKED)
+		Surface buildSurface(TextureSource const & source);
+		//! Find the texture pack entry of a PACKED source
+		TexturePack::Entry const & findPackedEntry(
+			TextureSource const & source,
+			TexturePack const * & pack) const;
+		//! Check whether a Texture name is stored or being loaded
+		bool hasTexture(std::string const & name) const;
+		//! Drop a stored or queued Texture & its reload source
+		void forgetTexture(std::string const & name);
+		//! Store a Texture built from its source (or queue it if budgeted)
+		void storeTexture(
+			std::string const & name,
+			TextureSource const & source);
+		//! Build, store & account a pending Texture right away
+		Texture * performUpload(PendingUpload & upload);
+		//! Get named Texture for drawing, reloading it if evicted
+		Texture * useTexture(std::string const & name);
+		//! Evict least recently used Texture objects until within budget
+		void enforceTextureBudget(void);
+		//! Run queued Texture creations within per-frame upload budget
+		void processUploads(void);
+		//! Prepare a pending Texture creation & hand it to the render thread
+		void handOverUpload(PendingUpload && upload);
+		//! Store the Textures created by the render thread
+		void collectUploads(void);
+
+		//! Replay a Layer's painter into its render target Texture
+		void paintLayer(Layer & layer);
+		//! Save rendering target & state, then target & clear a Layer
+		bool beginLayerPaint(SDL_Texture * texture, SavedTarget & saved);
+		//! Restore rendering target & state after a Layer repaint
+		void endLayerPaint(SavedTarget const & saved);
+
+		//! Build a command of the given type using current drawing state
+		RenderCommand makeCommand(RenderCommand::Type const type) const;
+		//! Cull a draw call, then execute it or defer it (partial redraw mode)
+		void submit(RenderCommand && command);
+		//! Record a renderer state change, or apply it right away
+		void submitState(RenderCommand && command);
+		//! Record SDL_Renderer work for the render thread
+		void recordTask(std::function<void(void)> task);
+		//! Check whether draw calls are recorded instead of executed
+		bool isRecording(void) const;
+		//! Execute a draw call, optionally restricted to a clipping rectangle
+		void execute(RenderCommand const & command, SDL_Rect const * clip);
+		//! Flush text, count a draw call & apply its drawing state
+		void beginCommand(
+			RenderCommand const & command,
+			std::size_t const batchSize);
+		//! Draw a primitive batch from raw elements
+		void executeBatch(
+			RenderCommand::Type const type,
+			void const * elements,
+			std::size_t const count,
+			int const * indices = nullptr,
+			std::size_t const indexCount = 0);
+		//! Draw a primitive batch right away if not recording
+		bool drawImmediately(
+			RenderCommand::Type const type,
+			void const * elements,
+			std::size_t const count,
+			int const * indices = nullptr,
+			std::size_t const indexCount = 0);
+		//! Update current frame's rendering counters for a draw call
+		void countCommand(
+			RenderCommand const & command,
+			std::size_t const batchSize);
+		//! Update current frame's rendering counters for TileMap chunk bakes
+		void countBakes(TileMap::BakeStats const & bakes);
+		//! Update current frame's rendering counters for a texture upload
+		void countUpload(std::size_t const bytes);
+		//! Draw batched text glyphs, if any
+		void flushText(void);
+		//! Get the cached layout of a plain string TEXT command
+		TextLayout const & getTextLayout(RenderCommand const & command);
+		//! Drop cached text layouts unused for a while
+		void trimTextLayouts(void);
+
+		//! Add a canvas region to redraw at next present()
+		void addDamage(SDL_Rect const & region);
+		//! Merge overlapping damaged regions
+		void mergeDamage(void);
+		//! Redraw damaged canvas regions & composite canvas onto the screen
+		void presentCanvas(void);
+
+		//! Redirect rendering into the scaled target (if enabled)
+		void bindScaledTarget(void);
+		//! Pick the scaled target filtering matching current render scale
+		void applyScaledTargetFilter(void);
+		//! Fit the scaled target into the rendering space
+		SDL_Rect computeScaledTargetDestination(SDL_Rect const & space) const;
+		//! Upscale the scaled target onto the screen
+		void presentScaledTarget(void);
+
+		//! Publish & reset current frame's rendering counters
+		void publishRenderStats(void);
+		//! Hand the recorded frame over to the render thread
+		void queueFrame(void);
+		//! Render thread main loop
+		void renderLoop(void);
+
+		//! Read a finished frame back if a capture was requested
+		void captureFrame(Uint32 const frame);
 
 	public:
 		//! Build a Renderer for an existing Window
@@ -76,9 +469,69 @@ class Renderer
 			std::string const & name,
 			std::string const & path);
 
+		//! Map a texture pack & build a Texture for each of its images
+		void addTexturePack(std::string const & path);
+
+		//! Start loading an image into a named Texture in the background
+		std::shared_future<Texture *> addImageTextureAsync(
+			std::string const & name,
+			std::string const & path);
+		//! Set per-frame Texture upload budget (bytes & microseconds)
+		void setUploadBudget(
+			std::size_t const bytes,
+			Uint32 const microseconds);
+		//! Get the number of asynchronous loads not uploaded yet
+		std::size_t getPendingTextureLoads(void) const;
+
 		//! Get named Texture
 		Texture * getTexture(std::string const & name);
 
+		//! Set texture memory budget & minimum idle frames before eviction
+		void setTextureBudget(
+			std::size_t const bytes,
+			Uint32 const idleFrames);
+		//! Get bytes held by loaded named Texture objects
+		std::size_t getTextureBytes(void) const;
+
+		//! Build a double-buffered StreamingTexture and store it
+		void addStreamingTexture(
+			std::string const & name,
+			Uint32 const format,
+			int const width,
+			int const height);
+
+		//! Get named StreamingTexture
+		StreamingTexture * getStreamingTexture(std::string const & name);
+
+		//! Build a cached render-to-texture Layer and store it
+		void addLayer(
+			std::string const & name,
+			int const width,
+			int const height,
+			Layer::Painter const & painter);
+
+		//! Get named Layer
+		Layer * getLayer(std::string const & name);
+
+		//! Mark every stored Layer as outdated (e.g. after targets reset)
+		void invalidateLayers(void);
+
+		//! Build an empty chunked TileMap over a stored tileset and store it
+		void addTileMap(
+			std::string const & name,
+			std::string const & tilesetName,
+			int const tileWidth,
+			int const tileHeight,
+			int const columns,
+			int const rows,
+			int const chunkSize = 16);
+
+		//! Get named TileMap
+		TileMap * getTileMap(std::string const & name);
+
+		//! Mark every stored TileMap chunk as outdated
+		void invalidateTileMaps(void);
+
 		//! Clear rendering surface
 		void clear(void);
 		//! Fill rendering surface with current drawing color
@@ -94,6 +547,17 @@ class Renderer
 			int const x2,
 			int const y2);
 
+		//! Draw points with current drawing color
+		void drawPoints(std::vector<SDL_Point> const & points);
+		//! Draw a polyline with current drawing color
+		void drawLines(std::vector<SDL_Point> const & points);
+		//! Draw rectangles with current drawing color
+		void drawRects(std::vector<SDL_Rect> const & rectangles);
+		//! Fill rectangles with current drawing color
+		void fillRects(std::vector<SDL_Rect> const & rectangles);
+		//! Draw a batch of colored primitives with current blending mode
+		void drawBatch(PrimitiveBatch const & batch);
+
 		//! Copy named Texture's clip to destination rectangle
 		void copy(
 			std::string const & textureName,
@@ -109,6 +573,22 @@ class Renderer
 			SDL_Point const & center,
 			SDL_RendererFlip const & flip);
 
+		//! Copy named StreamingTexture to destination, committing its changes
+		void copyStreamingTexture(
+			std::string const & textureName,
+			SDL_Rect const & destination);
+
+		//! Copy named Layer to destination rectangle, repainting it if dirty
+		void copyLayer(
+			std::string const & layerName,
+			SDL_Rect const & destination);
+
+		//! Draw the camera-visible part of a named TileMap
+		void drawTileMap(
+			std::string const & tileMapName,
+			SDL_Rect const & camera,
+			SDL_Rect const & destination);
+
 		//! Print a dynamically-rendered text into the destination rectangle
 		void printText(std::string const & text,
 				std::string const & fontName,
@@ -121,6 +601,103 @@ class Renderer
 			int const size,
 			int const xDest,
 			int const yDest);
+		//! Compute line breaks & glyph positions of a text, for printText()
+		std::shared_ptr<TextLayout const> layoutText(
+			std::string_view const text,
+			std::string const & fontName,
+			int const size,
+			int const width,
+			int const height,
+			TextLayout::Options const & options = TextLayout::Options());
+		//! Compute the area a text would cover, without laying it out
+		SDL_Rect measureText(
+			std::string_view const text,
+			std::string const & fontName,
+			int const size,
+			int const width,
+			int const height,
+			TextLayout::Options const & options = TextLayout::Options());
+		//! Print a pre-computed text layout at destination coordinates
+		void printText(std::shared_ptr<TextLayout const> const & layout,
+			SDL_Color const & color,
+			int const xDest,
+			int const yDest);
+		//! Select how glyphs of texts printed from now on are rasterized
+		void setTextRenderMode(BitmapFont::RenderMode const renderMode);
+		//! Get how glyphs of printed texts are rasterized
+		BitmapFont::RenderMode getTextRenderMode(void) const;
+		//! Cache baked fonts into a directory ("" disables the cache)
+		void setFontCacheDirectory(std::string const & cacheDirectory);
+		//! Get usage of the glyph atlas shared by fonts
+		GlyphAtlas::Occupancy getGlyphAtlasOccupancy(void);
+		//! Bake {font, size} pairs ahead of printing, in parallel
+		void preloadFonts(
+			std::vector<std::pair<std::string, int>> const & fonts);
+
+		//! Enable partial redraw mode using a canvas of the given dimensions
+		void enablePartialRedraw(int const width, int const height);
+		//! Disable partial redraw mode
+		void disablePartialRedraw(void);
+		//! Check whether partial redraw mode is enabled
+		bool isPartialRedrawEnabled(void) const;
+		//! Force a canvas region to be redrawn at next present()
+		void invalidateRegion(SDL_Rect const & region);
+		//! Force the whole canvas to be redrawn at next present()
+		void invalidateCanvas(void);
+		//! Get canvas regions redrawn during last present()
+		std::vector<SDL_Rect> const & getLastDamage(void) const;
+
+		//! Render into a low-resolution target, upscaled at present()
+		void enableScaledTarget(
+			int const width,
+			int const height,
+			bool const integerScaling);
+		//! Render directly to the screen again
+		void disableScaledTarget(void);
+		//! Check whether scaled target mode is enabled
+		bool isScaledTargetEnabled(void) const;
+		//! Get the screen area covered by the scaled target
+		SDL_Rect getScaledTargetDestination(void) const;
+		//! Set the fraction of the scaled target resolution to render at
+		void setRenderScale(float const scale);
+		//! Get the fraction of the scaled target resolution rendered at
+		float getRenderScale(void) const;
+
+		//! Get copy culling counters of the last presented frame
+		CullingStats getCullingStats(void) const;
+		//! Get rendering counters of the last presented frame
+		RenderStats getRenderStats(void) const;
+
+		//! Start executing presented frames on a dedicated thread
+		void enableRenderThread(void);
+		//! Stop the render thread, executing pending draw calls
+		void disableRenderThread(void);
+		//! Check whether render thread mode is enabled
+		bool isRenderThreadEnabled(void) const;
+		//! Get the index of the frame being recorded
+		Uint32 getFrameIndex(void) const;
+		//! Check whether a frame was executed (or superseded) on screen
+		bool isFrameComplete(Uint32 const frame) const;
+		//! Get the index following the last fully executed frame
+		Uint32 getCompletedFrames(void) const;
+		//! Wait until every presented frame was executed
+		void finish(void);
+		//! Get the number of presented frames the render thread skipped
+		Uint32 getDroppedFrames(void) const;
+		//! Lock the SDL_Renderer for direct SDL calls (render thread mode)
+		std::unique_lock<std::recursive_mutex> lockRenderer(void);
+
+		//! Save the next presented frame into an image file
+		void captureScreenshot(std::string const & path);
+		//! Save one presented frame out of 'interval' into image files
+		void startFrameCapture(
+			std::string const & prefix,
+			Uint32 const interval,
+			FrameCapture::Format const format);
+		//! Stop saving presented frames
+		void stopFrameCapture(void);
+		//! Wait until every captured frame was written
+		void flushCaptures(void);
 
 		//! Present current render onto screen
 		void present(void);
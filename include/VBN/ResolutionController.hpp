@@ -0,0 +1,63 @@
+#ifndef RESOLUTION_CONTROLLER_HPP_INCLUDED
+#define RESOLUTION_CONTROLLER_HPP_INCLUDED
+
+#include <SDL2/SDL_stdinc.h>
+
+class Window;
+
+/*!
+ * Dynamic resolution scaling controller
+ *
+ * Each instance of this class watches the rendering time of a Window's frames
+ * (polled by Engine, presentation & vsync wait excluded) and adjusts its
+ * render scale accordingly : resolution drops quickly when frames run over
+ * budget, and rises back slowly once they are comfortably under it. Both
+ * thresholds are apart & require several consecutive frames, so that the
+ * scale does not oscillate around the budget.
+ */
+class ResolutionController
+{
+	private:
+		//! Window whose render scale is driven (not owned)
+		Window * _window;
+		//! Frame duration budget, in milliseconds
+		Uint32 _targetMilliseconds;
+		//! Lowest render scale allowed
+		float _minScale;
+		//! Highest render scale allowed
+		float _maxScale;
+		//! Smoothed frame rendering time, in milliseconds
+		float _averageMilliseconds;
+		//! Consecutive frames over the downscale threshold
+		Uint32 _slowFrames;
+		//! Consecutive frames under the upscale threshold
+		Uint32 _fastFrames;
+		//! Renderer completed frames count when last updated
+		Uint32 _completedFrames;
+
+	public:
+		//! Build a ResolutionController
+		ResolutionController(
+			Window * window,
+			Uint32 const targetMilliseconds,
+			float const minScale,
+			float const maxScale);
+		//! Delete a ResolutionController instance
+		~ResolutionController(void);
+		ResolutionController(ResolutionController const &) = delete;
+		ResolutionController(ResolutionController &&) = delete;
+		ResolutionController & operator = (ResolutionController const &) = delete;
+		ResolutionController & operator = (ResolutionController &&) = delete;
+
+		//! Account the last rendered frame & adjust render scale if needed
+		void update(void);
+
+		//! Change the frame duration budget
+		void setTargetMilliseconds(Uint32 const targetMilliseconds);
+		//! Change the render scale range
+		void setScaleRange(float const minScale, float const maxScale);
+		//! Get the smoothed frame rendering time, in milliseconds
+		float getAverageMilliseconds(void) const;
+};
+
+#endif // RESOLUTION_CONTROLLER_HPP_INCLUDED
@@ -0,0 +1,135 @@
+#ifndef STREAMING_TEXTURE_HPP_INCLUDED
+#define STREAMING_TEXTURE_HPP_INCLUDED
+
+#include <vector>
+#include <SDL2/SDL_render.h>
+#include <VBN/Texture.hpp>
+
+/*!
+ * Double-buffered SDL_TEXTUREACCESS_STREAMING Texture for dynamic contents
+ *
+ * CPU writes (lock()/unlock() or update()) always go into a system memory copy
+ * of the pixels, and never touch a Texture the GPU may still be reading. On
+ * commit(), the regions changed since the back Texture was last updated are
+ * uploaded into it, then front & back are swapped : the back Texture was last
+ * drawn two frames ago, so uploading into it does not stall on the frame being
+ * displayed.
+ *
+ * Modulation & blending mode must be set through the StreamingTexture itself,
+ * so that they apply to both Textures and survive buffer swaps.
+ *
+ * When the SDL_Renderer is owned by another thread, stage() does the commit()
+ * bookkeeping & copies the changed pixels out, leaving upload() to that thread.
+ */
+class StreamingTexture
+{
+	public:
+		//! Changed pixels staged by stage(), waiting for upload()
+		struct Upload
+		{
+			//! Texture to upload into (front Texture once staged)
+			SDL_Texture * texture;
+			//! Area to upload
+			SDL_Rect region;
+			//! Pixels of the area, rows packed
+			std::vector<Uint8> pixels;
+		};
+
+	private:
+		//! Texture currently copied onto the rendering space
+		Texture _front;
+		//! Texture receiving the next upload
+		Texture _back;
+
+		//! System memory copy of the pixels
+		std::vector<Uint8> _pixels;
+		//! Bytes per pixel row in _pixels
+		int _pitch;
+		//! Bytes per pixel
+		int _bytesPerPixel;
+
+		//! Area locked through lock(), if any
+		SDL_Rect _lockedRegion;
+		//! Whether lock() was called without matching unlock()
+		bool _locked;
+		//! Area changed since last commit()
+		SDL_Rect _pendingRegion;
+		//! Area the back Texture misses (changed before last commit())
+		SDL_Rect _staleRegion;
+		//! Incremented each time front & back are swapped
+		Uint32 _revision;
+		//! Color & alpha modulation applied to both Textures
+		SDL_Color _colorAlphaMod;
+		//! Blending mode applied to both Textures
+		SDL_BlendMode _blendMode;
+
+		//! Crop a region to the texture & reject invalid ones
+		SDL_Rect cropRegion(SDL_Rect const * region) const;
+		//! Extend a (possibly empty) region to cover another one
+		static void extendRegion(SDL_Rect & region, SDL_Rect const & other);
+		//! Apply stored modulation & blending mode to a Texture
+		void applyState(Texture & texture) const;
+		//! Check whether changes can be committed, computing the upload area
+		bool prepareCommit(SDL_Rect & upload) const;
+		//! Copy a region of the pixels, row by row
+		void copyPixels(
+			SDL_Rect const & region,
+			Uint8 * destination,
+			int const destinationPitch) const;
+		//! Swap buffers once the back Texture is (or will be) up-to-date
+		void swapBuffers(void);
+
+	public:
+		//! Build a StreamingTexture
+		StreamingTexture(
+			SDL_Renderer * renderer,
+			Uint32 const format,
+			int const width,
+			int const height);
+		//! Move a StreamingTexture instance
+		StreamingTexture(StreamingTexture && other);
+		//! Delete a StreamingTexture instance
+		~StreamingTexture(void);
+		StreamingTexture(StreamingTexture const &) = delete;
+		StreamingTexture & operator = (StreamingTexture const &) = delete;
+		StreamingTexture & operator = (StreamingTexture &&) = delete;
+
+		//! Get write access to a region of the pixels
+		void * lock(SDL_Rect const * region, int & pitch);
+		//! Release write access & mark the locked region as changed
+		void unlock(void);
+		//! Overwrite a region of the pixels
+		void update(
+			SDL_Rect const * region,
+			void const * pixels,
+			int const pitch);
+
+		//! Check whether changes are waiting for commit()
+		bool hasPendingChanges(void) const;
+		//! Upload pending changes into the back Texture & swap buffers
+		std::size_t commit(void);
+		//! Swap buffers, staging pending changes for a later upload()
+		bool stage(Upload & upload);
+		//! Upload staged changes into their Texture
+		static std::size_t upload(Upload const & upload);
+
+		//! Set color & alpha modulation of both Textures
+		void setColorAlphaMod(SDL_Color const & color);
+		//! Get color & alpha modulation
+		SDL_Color getColorAlphaMod(void) const;
+		//! Set blending mode of both Textures
+		void setBlendMode(SDL_BlendMode const & blendMode);
+		//! Get blending mode
+		SDL_BlendMode getBlendMode(void) const;
+
+		//! Get the Texture to copy onto the rendering space
+		Texture & getTexture(void);
+		//! Get current buffer revision
+		Uint32 getRevision(void) const;
+		//! Get texture width
+		int getWidth(void) const;
+		//! Get texture height
+		int getHeight(void) const;
+};
+
+#endif // STREAMING_TEXTURE_HPP_INCLUDED
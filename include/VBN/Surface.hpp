@@ -34,6 +34,8 @@ class Surface
 
 		//! Get raw pointer to underlying SDL_Surface
 		SDL_Surface * getSurface(void);
+		//! Build a copy of the Surface converted to another pixel format
+		Surface convert(Uint32 const format);
 
 		//! Print a Latin1-encoded string onto a new Surface
 		static Surface fromLatin1Text(
@@ -0,0 +1,108 @@
+#ifndef TEXT_LAYOUT_HPP_INCLUDED
+#define TEXT_LAYOUT_HPP_INCLUDED
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <SDL2/SDL_rect.h>
+
+class BitmapFont;
+
+/*!
+ * Line breaks & glyph positions of a text laid out with a BitmapFont
+ *
+ * Built by BitmapFont::layoutText() for a given {text, font, width, height,
+ * options}, then drawn as many times as needed by BitmapFont::queueLayout()
+ * without measuring or wrapping the text again. Glyphs are referred to by their
+ * index in the font glyph cache, so that evicted glyph images are transparently
+ * rasterized again when drawn.
+ *
+ * Storage is reused when a TextLayout is laid out again : refreshing a layout
+ * every frame does not allocate once it has grown.
+ */
+class TextLayout
+{
+	friend class BitmapFont;
+
+	public:
+		//! Horizontal placement of lines within the layout width
+		enum Alignment
+		{
+			//! Lines start at the left edge
+			LEFT,
+			//! Lines are centered
+			CENTER,
+			//! Lines end at the right edge
+			RIGHT,
+			//! Blanks are stretched so that wrapped lines fill the width
+			JUSTIFY
+		};
+
+		//! Layout parameters
+		struct Options
+		{
+			//! Horizontal placement of lines
+			Alignment alignment = LEFT;
+			//! Distance between baselines (0 = font line skip)
+			int lineHeight = 0;
+			//! Whether text overflowing the height ends with an ellipsis
+			bool ellipsis = false;
+
+			//! Check whether two option sets produce the same layout
+			bool operator == (Options const & other) const;
+		};
+
+		//! Glyph placed relative to the layout origin
+		struct PlacedGlyph
+		{
+			//! Index in the font glyph cache
+			Uint32 glyph;
+			//! Left of the glyph image
+			int x;
+			//! Top of the line
+			int y;
+		};
+
+	private:
+		//! Font the layout was computed with
+		BitmapFont * _font;
+		//! Laid out text
+		std::string _text;
+		//! Maximum line width
+		int _width;
+		//! Maximum layout height
+		int _height;
+		//! Layout parameters
+		Options _options;
+		//! Glyphs with an image, in text order
+		std::vector<PlacedGlyph> _glyphs;
+		//! Area covered by each line, relative to the layout origin
+		std::vector<SDL_Rect> _lineBounds;
+		//! Area covered by the whole text, relative to the layout origin
+		SDL_Rect _bounds;
+
+	public:
+		//! Build an empty TextLayout
+		TextLayout(void);
+
+		//! Check whether the layout was computed for these parameters
+		bool matches(
+			BitmapFont const * font,
+			std::string_view const text,
+			int const width,
+			int const height,
+			Options const & options) const;
+
+		/* Getters */
+		BitmapFont * getFont(void) const;
+		std::string const & getText(void) const;
+		int getWidth(void) const;
+		int getHeight(void) const;
+		Options const & getOptions(void) const;
+		std::vector<PlacedGlyph> const & getGlyphs(void) const;
+		std::vector<SDL_Rect> const & getLineBounds(void) const;
+		int getLineCount(void) const;
+		SDL_Rect const & getBounds(void) const;
+};
+
+#endif // TEXT_LAYOUT_HPP_INCLUDED
@@ -34,6 +34,11 @@ class Texture
 		//! Texture heigt
 		int _height;
 
+		//! Color-Alpha modulation saved by unload(), restored by reload()
+		SDL_Color _savedColorAlphaMod;
+		//! Blending mode saved by unload(), restored by reload()
+		SDL_BlendMode _savedBlendMode;
+
 		//! Private constructor (use factories for public instantiation)
 		Texture(SDL_Texture * rawTexture);
 
@@ -57,6 +62,8 @@ class Texture
 		int getAccess(void) const;
 		//! Get Texture pixel format
 		Uint32 getPixelFormat(void) const;
+		//! Get Texture pixel data size in bytes
+		std::size_t getSize(void) const;
 
 		
 		//! Add a clipping rectangle to the clips dictionnary
@@ -71,6 +78,15 @@ class Texture
 		void setColorAlphaMod(SDL_Color const & color);
 		//! Get Color-Alpha modulation
 		SDL_Color getColorAlphaMod(void) const;
+		//! Set blending mode used when copying the Texture
+		void setBlendMode(SDL_BlendMode const & blendMode);
+
+		//! Release the underlying SDL_Texture (keeps metrics & clips)
+		void unload(void);
+		//! Check whether the underlying SDL_Texture is available
+		bool isLoaded(void) const;
+		//! Adopt the SDL_Texture of a freshly built Texture after unload()
+		void reload(Texture && replacement);
 
 		//! Print a Latin1-encoded string onto a new Texture instance
 		static Texture fromLatin1Text(
@@ -95,6 +111,15 @@ class Texture
 			SDL_Renderer * renderer,
 			Surface & surface);
 
+		//! Build a static Texture instance from raw pixels
+		static Texture fromPixels(
+			SDL_Renderer * renderer,
+			Uint32 const format,
+			int const width,
+			int const height,
+			void const * pixels,
+			int const pitch);
+
 		//! Build a Texture instance from scratch using SDL parameters
 		static Texture fromScratch(
 			SDL_Renderer * renderer,
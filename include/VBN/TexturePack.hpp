@@ -0,0 +1,106 @@
+#ifndef TEXTURE_PACK_HPP_INCLUDED
+#define TEXTURE_PACK_HPP_INCLUDED
+
+#include <string>
+#include <unordered_map>
+#include <SDL2/SDL_stdinc.h>
+
+#define TEXTURE_PACK_MAGIC "VBNP"
+#define TEXTURE_PACK_VERSION 1
+#define TEXTURE_PACK_BYTE_ORDER 0x01020304
+#define TEXTURE_PACK_NAME_SIZE 64
+#define TEXTURE_PACK_ALIGNMENT 16
+
+/*!
+ * Read-only, memory-mapped pack of pre-decoded images
+ *
+ * A pack file (built offline by tools/TexturePacker.cpp) starts with a Header,
+ * followed by 'count' Entry records, followed by the raw pixel rows of every
+ * image, each block aligned on TEXTURE_PACK_ALIGNMENT bytes. Pixels are stored
+ * in the pixel format the pack was built for, so that they can be uploaded
+ * as-is with SDL_UpdateTexture() : opening a pack involves no decoding and no
+ * copy, the operating system pages pixels in on first access.
+ *
+ * Integers are stored in the byte order of the machine that built the pack ;
+ * packs built on a machine of different byte order are rejected.
+ */
+class TexturePack
+{
+	public:
+		//! Pack file header
+		struct Header
+		{
+			//! TEXTURE_PACK_MAGIC (not null-terminated)
+			char magic[4];
+			//! TEXTURE_PACK_VERSION
+			Uint32 version;
+			//! TEXTURE_PACK_BYTE_ORDER, as written by the packer
+			Uint32 byteOrder;
+			//! Number of Entry records following the header
+			Uint32 count;
+		};
+
+		//! Pack file index record
+		struct Entry
+		{
+			//! Image name (null-terminated)
+			char name[TEXTURE_PACK_NAME_SIZE];
+			//! SDL pixel format of the pixels
+			Uint32 format;
+			//! Image width
+			Sint32 width;
+			//! Image height
+			Sint32 height;
+			//! Bytes per pixel row
+			Sint32 pitch;
+			//! Offset of the first pixel row from the start of the file
+			Uint64 offset;
+			//! Byte size of the pixel rows
+			Uint64 size;
+		};
+
+	private:
+		//! Path to the pack file
+		std::string _path;
+		//! Start of the mapped file
+		Uint8 const * _data;
+		//! Size of the mapped file
+		std::size_t _size;
+		//! Index record positions, by image name
+		std::unordered_map<std::string, std::size_t> _entries;
+#ifdef _WIN32
+		//! File mapping object handle
+		void * _mapping;
+#endif
+
+		//! Private constructor (use factories for public instantiation)
+		TexturePack(std::string const & path);
+
+		//! Check header & index consistency, then index records by name
+		void validate(void);
+
+	public:
+		//! Move a TexturePack instance
+		TexturePack(TexturePack && other);
+		//! Unmap & delete a TexturePack instance
+		~TexturePack(void);
+		TexturePack(TexturePack const &) = delete;
+		TexturePack & operator = (TexturePack const &) = delete;
+		TexturePack & operator = (TexturePack &&) = delete;
+
+		//! Get the number of images in the pack
+		std::size_t getCount(void) const;
+		//! Get an index record by position
+		Entry const & getEntry(std::size_t const index) const;
+		//! Get an index record by image name
+		Entry const * findEntry(std::string const & name) const;
+		//! Get the pixel rows of an image
+		void const * getPixels(Entry const & entry) const;
+		//! Get path to the pack file
+		std::string const & getPath(void) const;
+
+		//! Map a pack file into memory
+		static TexturePack fromFile(std::string const & path);
+};
+
+#endif // TEXTURE_PACK_HPP_INCLUDED
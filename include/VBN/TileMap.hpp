@@ -0,0 +1,173 @@
+#ifndef TILE_MAP_HPP_INCLUDED
+#define TILE_MAP_HPP_INCLUDED
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <SDL2/SDL_render.h>
+#include <VBN/Texture.hpp>
+
+/*!
+ * Chunked tile grid rendered from a tileset Texture
+ *
+ * Tiles are stored as compact 16-bit indices into a tileset Texture (read
+ * left-to-right, top-to-bottom in tileWidth x tileHeight cells). The grid is
+ * split into square chunks, each of them pre-baked into a cached render target
+ * Texture the first time it becomes visible. Changing a single tile only
+ * re-bakes that tile's cell in its chunk.
+ *
+ * Bakes are prepared from the tile indices, then executed right away or handed
+ * over to a BakeScheduler (e.g. to run on the thread owning the SDL_Renderer,
+ * in order with the draw calls copying the chunks).
+ */
+class TileMap
+{
+	public:
+		//! Tile index meaning "no tile"
+		static Uint16 const EMPTY_TILE = 0xFFFF;
+
+		//! Baked chunk area to copy, as computed by TileMap::prepare()
+		struct ChunkCopy
+		{
+			//! Baked chunk Texture
+			SDL_Texture * texture;
+			//! Baked chunk contents revision
+			Uint32 revision;
+			//! Area to copy from the chunk Texture
+			SDL_Rect source;
+			//! Destination area, relative to the camera's top-left corner
+			SDL_Rect destination;
+		};
+
+		//! Rendering work done by chunk bakes, as reported by takeBakeStats()
+		struct BakeStats
+		{
+			//! Chunks baked
+			Uint32 chunks;
+			//! SDL draw calls issued (tile copies & cell clears)
+			Uint32 drawCalls;
+		};
+
+		//! Runs a prepared chunk bake later, on the thread owning the renderer
+		typedef std::function<void(std::function<void(void)> &&)> BakeScheduler;
+
+	private:
+		//! Cached rendering of a chunkSize x chunkSize block of tiles
+		struct Chunk
+		{
+			//! Baked tiles (created when first baked)
+			std::unique_ptr<Texture> texture;
+			//! Whether the whole chunk must be re-baked
+			bool fullyDirty;
+			//! Tiles (chunk-local offsets) to re-bake individually
+			std::vector<Uint16> dirtyTiles;
+			//! Incremented each time the chunk is re-baked
+			Uint32 revision;
+		};
+
+		//! SDL calls of a chunk bake, prepared from the tile indices
+		struct Bake
+		{
+			//! SDL_Renderer to bake on
+			SDL_Renderer * renderer;
+			//! Chunk Texture
+			SDL_Texture * target;
+			//! Tileset Texture
+			SDL_Texture * tileset;
+			//! Whether the whole chunk is cleared first
+			bool clear;
+			//! Cells (chunk area) cleared individually
+			std::vector<SDL_Rect> cells;
+			//! Tiles to copy : (tileset area, chunk area)
+			std::vector<std::pair<SDL_Rect, SDL_Rect>> copies;
+		};
+
+		//! Raw SDL_Renderer on which chunks are baked
+		SDL_Renderer * _sdlRenderer;
+		//! Mutex serializing SDL_Renderer access while baking (optional)
+		std::recursive_mutex * _rendererMutex;
+		//! Tileset Texture (not owned)
+		Texture * _tileset;
+		//! Number of tile columns in the tileset
+		int _tilesetColumns;
+
+		//! Tile width in pixels
+		int _tileWidth;
+		//! Tile height in pixels
+		int _tileHeight;
+		//! Number of tile columns in the map
+		int _columns;
+		//! Number of tile rows in the map
+		int _rows;
+		//! Chunk side, in tiles
+		int _chunkSize;
+		//! Number of chunk columns in the map
+		int _chunkColumns;
+		//! Number of chunk rows in the map
+		int _chunkRows;
+
+		//! Tile indices, row-major
+		std::vector<Uint16> _tiles;
+		//! Chunks, row-major
+		std::vector<Chunk> _chunks;
+		//! Visible chunk areas computed by last prepare() call
+		std::vector<ChunkCopy> _visible;
+		//! Bake work done since last takeBakeStats() call
+		BakeStats _bakeStats;
+
+		//! Bring a chunk's baked Texture up-to-date
+		void bakeChunk(
+			int const chunkColumn,
+			int const chunkRow,
+			BakeScheduler const & schedule);
+		//! Add a single tile copy to a chunk bake
+		void bakeTile(
+			Bake & bake,
+			int const column,
+			int const row,
+			SDL_Rect const & chunk);
+		//! Issue the SDL calls of a chunk bake
+		static void runBake(Bake const & bake);
+
+	public:
+		//! Build an empty TileMap
+		TileMap(
+			SDL_Renderer * renderer,
+			Texture * tileset,
+			int const tileWidth,
+			int const tileHeight,
+			int const columns,
+			int const rows,
+			int const chunkSize,
+			std::recursive_mutex * rendererMutex = nullptr);
+		//! Move a TileMap instance
+		TileMap(TileMap && other);
+		//! Delete a TileMap instance
+		~TileMap(void);
+		TileMap(TileMap const &) = delete;
+		TileMap & operator = (TileMap const &) = delete;
+		TileMap & operator = (TileMap &&) = delete;
+
+		//! Set the tileset index of a tile
+		void setTile(int const column, int const row, Uint16 const index);
+		//! Get the tileset index of a tile
+		Uint16 getTile(int const column, int const row) const;
+		//! Mark every chunk as outdated (e.g. after targets reset)
+		void invalidate(void);
+
+		//! Get map width in pixels
+		int getWidth(void) const;
+		//! Get map height in pixels
+		int getHeight(void) const;
+
+		//! Bake visible chunks & compute their areas for a given camera
+		std::vector<ChunkCopy> const & prepare(
+			SDL_Rect const & camera,
+			BakeScheduler const & schedule = BakeScheduler());
+		//! Get & reset bake work done since last call
+		BakeStats takeBakeStats(void);
+};
+
+#endif // TILE_MAP_HPP_INCLUDED
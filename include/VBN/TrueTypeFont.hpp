@@ -3,7 +3,10 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_surface.h>
 
@@ -12,17 +15,18 @@
  *
  * Each instance of this class encapsulates a TTF_Font object in a dedicated
  * std::unique_ptr, configured to free the underlying memory chunk using
- * TTF_CloseFont().
+ * TTF_CloseFont(). Faces are opened & closed under a process-wide lock, as
+ * they all share the FreeType library.
+ *
+ * Glyph metrics are cached as they are queried : a dense table for Latin1, a
+ * hash table for other codepoints. Style, outline & hinting changes clear the
+ * cache. Instances are not thread-safe, even through const methods.
  *
  * @todo	Add documentation for TTF getters/setters
- * @todo	Implement Blended, Shaded etc. renders
+ * @todo	Implement Blended, Shaded etc. text renders
  */
 class TrueTypeFont
 {
-	private:
-		//! Internal SDL TTF_Font
-		std::unique_ptr<TTF_Font, decltype(&TTF_CloseFont)> _font;
-
 	public:
 		/*!
 		 * Aggregates all exposed metrics for a single glyph. (refer to
@@ -40,6 +44,32 @@ class TrueTypeFont
 			int advance;
 		};
 
+	private:
+		//! Cached metrics of a single glyph
+		struct CachedMetrics
+		{
+			//! Glyph metrics (zeroed if the glyph is not provided)
+			GlyphMetrics metrics;
+			//! Whether the font provides the glyph
+			bool provided;
+			//! Whether the entry was filled
+			bool filled;
+		};
+
+		//! Internal SDL TTF_Font
+		std::unique_ptr<TTF_Font, decltype(&TTF_CloseFont)> _font;
+		//! Metrics of Latin1 glyphs, by codepoint (allocated on first use)
+		mutable std::vector<CachedMetrics> _denseMetrics;
+		//! Metrics of other glyphs
+		mutable std::unordered_map<Uint32, CachedMetrics> _sparseMetrics;
+
+		//! Get the cache entry of a glyph, filling it if needed
+		CachedMetrics const & getCachedMetrics(Uint32 const codepoint) const;
+		//! Drop cached metrics (after a rendering setting change)
+		void clearMetrics(void);
+
+	public:
+
 		//! Build a TrueTypeFont instance
 		TrueTypeFont(
 			std::string const & filePath,
@@ -62,10 +92,14 @@ class TrueTypeFont
 		int getAscent(void) const;
 		int getDescent(void) const;
 		int getLineSkip(void) const;
+		int getHeight(void) const;
 		int getFaces(void) const;
 		bool getIsFixedWidth(void) const;
 		std::string getFaceFamilyName(void) const;
-		GlyphMetrics getGlyphMetrics(char const c) const;
+		GlyphMetrics const & getGlyphMetrics(char const c) const;
+		GlyphMetrics const & getCodepointMetrics(Uint32 const codepoint) const;
+		bool hasGlyph(Uint32 const codepoint) const;
+		int getKerningSize(Uint32 const previous, Uint32 const current) const;
 
 		/* Setters */
 		void setStyle(int const style);
@@ -74,7 +108,11 @@ class TrueTypeFont
 		void setKerning(int const kerning);
 
 		/* Computation */
-		std::pair<int, int> getTextSize(std::string const text) const;
+		std::pair<int, int> getTextSize(std::string const & text) const;
+		//! Size many UTF-8 strings from cached glyph metrics
+		void getTextSizes(
+			std::vector<std::string_view> const & texts,
+			std::vector<std::pair<int, int>> & sizes) const;
 
 		/* Rendering */
 		//! Render Latin1 text into an SDL_Surface
@@ -85,6 +123,14 @@ class TrueTypeFont
 		SDL_Surface * renderSolidUTF8(
 			std::string const & text,
 			SDL_Color const & color);
+		//! Render a single glyph into an SDL_Surface
+		SDL_Surface * renderSolidGlyph(
+			Uint32 const codepoint,
+			SDL_Color const & color);
+		//! Render a single anti-aliased glyph into an SDL_Surface
+		SDL_Surface * renderBlendedGlyph(
+			Uint32 const codepoint,
+			SDL_Color const & color);
 };
 
 #endif // TRUE_TYPE_FONT_HPP_INCLUDED
\ No newline at end of file
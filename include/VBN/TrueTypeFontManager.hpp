@@ -35,6 +35,10 @@ class TrueTypeFontManager
 
 		//! Get a (cached or newly created) TrueTypeFont
 		TrueTypeFont * getFont(std::string const & name, int const size);
+		//! Get a cached TrueTypeFont, without opening it
+		TrueTypeFont * findFont(std::string const & name, int const size);
+		//! Get the path of a font file
+		std::string getFontPath(std::string const & name) const;
 };
 
 #endif // TRUE_TYPE_FONT_MANAGER_HPP_INCLUDED
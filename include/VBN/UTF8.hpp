@@ -0,0 +1,78 @@
+#ifndef UTF8_HPP_INCLUDED
+#define UTF8_HPP_INCLUDED
+
+#include <cstddef>
+#include <string_view>
+#include <SDL2/SDL_stdinc.h>
+
+//! Unicode replacement character, decoded from malformed UTF-8
+#define UTF8_REPLACEMENT 0xFFFD
+
+/*!
+ * Malformed sequences decode to UTF8_REPLACEMENT, skipping a single byte.
+ *
+ * @param	text	UTF-8 text
+ * @param	cursor	Offset of the sequence to decode, moved past it
+ * @returns			Decoded codepoint
+ */
+inline Uint32 decodeUTF8(std::string_view const text, std::size_t & cursor)
+{
+	unsigned char const lead(text[cursor]);
+	if (lead < 0x80)
+	{
+		++cursor;
+		return lead;
+	}
+
+	std::size_t length(0);
+	Uint32 codepoint(0), minimum(0);
+	if ((lead & 0xE0) == 0xC0)
+	{
+		length = 2;
+		codepoint = lead & 0x1F;
+		minimum = 0x80;
+	}
+	else if ((lead & 0xF0) == 0xE0)
+	{
+		length = 3;
+		codepoint = lead & 0x0F;
+		minimum = 0x800;
+	}
+	else if ((lead & 0xF8) == 0xF0)
+	{
+		length = 4;
+		codepoint = lead & 0x07;
+		minimum = 0x10000;
+	}
+	else
+	{
+		++cursor;
+		return UTF8_REPLACEMENT;
+	}
+
+	if (cursor + length > text.size())
+	{
+		++cursor;
+		return UTF8_REPLACEMENT;
+	}
+	for (std::size_t index(1) ; index < length ; ++index)
+	{
+		unsigned char const continuation(text[cursor + index]);
+		if ((continuation & 0xC0) != 0x80)
+		{
+			++cursor;
+			return UTF8_REPLACEMENT;
+		}
+		codepoint = (codepoint << 6) | (continuation & 0x3F);
+	}
+	cursor += length;
+
+	// Reject overlong forms, surrogates & out of range values
+	if (codepoint < minimum || codepoint > 0x10FFFF ||
+		(codepoint >= 0xD800 && codepoint <= 0xDFFF))
+		return UTF8_REPLACEMENT;
+
+	return codepoint;
+}
+
+#endif // UTF8_HPP_INCLUDED
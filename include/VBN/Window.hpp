@@ -33,6 +33,13 @@ class Window
 			 */
 			FIXED_RATIO_STRETCH,
 
+			/*!
+			 * Renders at intended resolution into an offscreen target, then
+			 * upscales it by the largest fitting integer factor, using black
+			 * borders to fill gaps (pixel-art games)
+			 */
+			FIXED_RATIO_PIXEL,
+
 			/*!
 			 * Resolution depends on window size
 			 */
@@ -51,6 +58,8 @@ class Window
 		int _canvasWidth;
 		//! Height of the drawable internal canvas
 		int _canvasHeight;
+		//! Fraction of the canvas resolution actually rendered
+		float _renderScale;
 
 		//! (Re-)Apply RatioType, e.g. after toggling Full-Screen
 		void applyRatioTypeSettings(void);
@@ -58,6 +67,9 @@ class Window
 		//! Update canvas dimensions (if using FIXED_RATIO_FRAME mode)
 		void updateCanvasFrame(SDL_Rect const & outerSurface);
 
+		//! (Re-)Apply render scale, e.g. after resizing the Window
+		void applyRenderScale(void);
+
 	public:
 		//! Build a Window
 		Window(std::string const & title,
@@ -95,6 +107,11 @@ class Window
 
 		//! Must be called whenever the Window is resized */
 		void handleResize(void);
+
+		//! Set the fraction of the canvas resolution to render at */
+		void setRenderScale(float const scale);
+		//! Get the fraction of the canvas resolution rendered at */
+		float getRenderScale(void) const;
 };
 
 #endif // WINDOW_HPP_INCLUDED
@@ -1,25 +1,102 @@
 #include <VBN/BitmapFont.hpp>
-#include <climits>
-#include <cctype>
-#include <vector>
-#include <VBN/Window.hpp>
-#include <VBN/WindowManager.hpp>
-#include <VBN/Engine.hpp>
+#include <algorithm>
+#include <fstream>
 #include <VBN/TrueTypeFontManager.hpp>
-#include <VBN/Surface.hpp>
+#include <VBN/UTF8.hpp>
 #include <VBN/Logging.hpp>
 #include <VBN/Exceptions.hpp>
 
+//! Marks unused hash table slots (not a valid codepoint)
+#define BITMAP_FONT_EMPTY_SLOT 0xFFFFFFFF
+//! Returned by findGlyph() on miss
+#define BITMAP_FONT_NO_GLYPH 0xFFFFFFFF
+//! Initial hash table size (power of two)
+#define BITMAP_FONT_INITIAL_SLOTS 512
+//! Horizontal ellipsis, drawn at the end of truncated layouts
+#define BITMAP_FONT_ELLIPSIS 0x2026
+//! Atlas page size bounds (pages hold about 16 lines of glyphs)
+#define BITMAP_FONT_MIN_PAGE_SIZE 256
+#define BITMAP_FONT_MAX_PAGE_SIZE 2048
+//! Maximum number of pages of atlases owned by a font
+#define BITMAP_FONT_MAX_PAGES 4
+//! Cache file signature & format version
+#define BITMAP_FONT_CACHE_MAGIC "VBNF"
+#define BITMAP_FONT_CACHE_VERSION 3
+//! Sanity bound on cache file table sizes
+#define BITMAP_FONT_CACHE_MAX_ENTRIES (1 << 20)
+//! Atlas page of glyphs not rasterized yet (never a valid page)
+#define BITMAP_FONT_PENDING_PAGE 0xFFFF
+
+namespace
+{
+	// Fibonacci hashing, spreads consecutive codepoints over the table : the
+	// high half of the product depends on every codepoint bit, and callers
+	// keep its low bits
+	inline std::size_t hashCodepoint(Uint32 const codepoint)
+	{
+		return (std::size_t)(
+			((Uint64)codepoint * 11400714819323198485ULL) >> 32);
+	}
+
+	inline bool isControl(Uint32 const codepoint)
+	{
+		return (codepoint < 0x20 || (codepoint >= 0x7F && codepoint < 0xA0));
+	}
+
+	inline bool isBlank(Uint32 const codepoint)
+	{
+		return (codepoint == ' ' || codepoint == '\t');
+	}
+
+	// Previous glyph at line start (no kerning)
+	BitmapFont::Glyph const noGlyph{0,
+		GlyphAtlas::Region{0, 0, SDL_Rect{0, 0, 0, 0}},
+		0,
+		0,
+		0,
+		0};
+}
+
+/*
+ * Glyphs are packed into 'atlas' if any (see BitmapFontManager) and its pages
+ * fit the font, into an atlas owned by the font otherwise.
+ *
+ * With a cache directory, the baked glyphs are loaded from a cache file keyed
+ * by font file contents, size, render mode, TTF font settings & SDL_ttf
+ * version, if any : the TTF font is then only opened once a glyph missing from
+ * the cache is needed. Otherwise glyphs are baked, then written to the cache
+ * directory.
+ *
+ * With a 'bakingFont', glyphs are rasterized with it, and nothing is uploaded :
+ * the font may then be built on any thread, but upload() must be called on the
+ * renderer thread before anything else. TTF fonts are not thread-safe, so each
+ * thread needs its own 'bakingFont'.
+ */
 BitmapFont::BitmapFont(
 	std::shared_ptr<TrueTypeFontManager> ttfManager,
 	std::string const & name,
 	int size,
-	SDL_Renderer * renderer) :
+	SDL_Renderer * renderer,
+	RenderMode const renderMode,
+	std::string const & cacheDirectory,
+	std::shared_ptr<GlyphAtlas> atlas,
+	TrueTypeFont * bakingFont) :
 	_sdlRenderer(renderer),
-	_texture(Texture::fromScratch(renderer,
-				SDL_PIXELFORMAT_RGBA32,
-				SDL_TEXTUREACCESS_STATIC,
-				10, 10))
+	_ttfManager(ttfManager),
+	_name(name),
+	_size(size),
+	_font(bakingFont),
+	_lineSkip(0),
+	_renderMode(renderMode),
+	_pageSize(0),
+	_atlas(atlas),
+	_slots(BITMAP_FONT_INITIAL_SLOTS,
+		GlyphSlot{BITMAP_FONT_EMPTY_SLOT, BITMAP_FONT_NO_GLYPH}),
+	_usedSlots(0),
+	_fallback(BITMAP_FONT_NO_GLYPH),
+	_ellipsis(BITMAP_FONT_NO_GLYPH),
+	_ellipsisCount(0),
+	_uploaded(false)
 {
 	if (!ttfManager)
 		THROW(Exception, "Received nullptr 'ttfManager'");
@@ -29,116 +106,81 @@ BitmapFont::BitmapFont(
 		THROW(Exception, "Received 'size' <= 0");
 	if (_sdlRenderer == nullptr)
 		THROW(Exception, "Received nullptr 'renderer'");
+	if (atlas && atlas->isPremultiplied() != (renderMode == BLENDED))
+		THROW(Exception, "Received 'atlas' with another alpha mode");
 
-	TrueTypeFont * font = ttfManager->getFont(name, size);
-	if (!font)
-		THROW(Exception,
-			"Cannot retrieve font '%s' size '%d'",
-			name.c_str(),
-			size);
-
-	_lineSkip = font->getLineSkip();
-	TrueTypeFont::GlyphMetrics spaceMetrics = font->getGlyphMetrics(' ');
-
-	unsigned char currentCharacter(0);
-	int currentLine(0), maxWidth(0);
-	std::vector<Surface> lineSurfaces;
-
-	/* Iterate through available alphabet, building 16 char long lines */
-	do
+	std::string const cachePath(cacheDirectory.empty() ?
+		std::string() :
+		computeCachePath(cacheDirectory));
+	bool const cached(!cachePath.empty() && loadCache(cachePath));
+	if (!cached)
 	{
-		std::string lineString;
-		int	horizontalAdvance(0),
-			currentPrintable(0),
-			verticalAdvance(currentLine * _lineSkip);
-
-		do
+		bake();
+		if (!cachePath.empty())
 		{
-			/* Skip unprintable characters */
-			if (std::isprint(currentCharacter))
+			try
 			{
-				lineString.append(1, currentCharacter);
-				_glyphMetrics[currentCharacter] =
-					font->getGlyphMetrics(currentCharacter);
-				_clips[currentCharacter] =
-					{horizontalAdvance + _glyphMetrics[currentCharacter].xMin,
-					verticalAdvance,
-					_glyphMetrics[currentCharacter].width,
-					_lineSkip};
-
-				horizontalAdvance +=
-					_glyphMetrics[currentCharacter].advance;
-
-				++currentPrintable;
-
-				/*
-				VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
-					"'%c' x(%d;%d)y(%d;%d)a(%d)",
-					currentCharacter,
-					_glyphMetrics[currentCharacter].xMin,
-					_glyphMetrics[currentCharacter].xMax,
-					_glyphMetrics[currentCharacter].yMin,
-					_glyphMetrics[currentCharacter].yMax,
-					_glyphMetrics[currentCharacter].advance);
-					*/
+				saveCache(cachePath);
 			}
-			else
+			catch (Exception const & exc)
 			{
-				_clips[currentCharacter] = {0, 0, 0, 0};
-				_glyphMetrics[currentCharacter] = {0, 0, 0, 0, 0};
+				EXCEPT(exc);
 			}
+		}
+	}
 
-			++currentCharacter;
-		} while(currentPrintable < 16 && currentCharacter < UCHAR_MAX);
-
-		/* Generate a surface that contains the current 16 character line */
-		lineSurfaces.push_back(Surface::fromLatin1Text(
-								ttfManager, lineString, name, size,
-								{255,255,255,255}));
-
-		/* Update longest line width */
-		Surface & lastLineInserted(lineSurfaces.back());
-		if (lastLineInserted.getSurface()->w > maxWidth)
-			maxWidth = lastLineInserted.getSurface()->w;
-
-		++currentLine;
-	} while(currentCharacter < UCHAR_MAX);
-
-	/* Instantiate internal target surface */
-	Surface internalSurface = Surface::fromScratch(maxWidth,
-												_lineSkip*currentLine, 32);
-
-	/* Blit previously generated line surfaces on main surface */
-	int line(0);
-	for(auto & surface : lineSurfaces)
+	// Glyphs missing later on are rasterized with the shared TTF font
+	if (bakingFont != nullptr)
+		_font = nullptr;
+	else if (cached)
 	{
-		SDL_Rect lineDest{0,
-				line*_lineSkip,
-				internalSurface.getSurface()->w,
-				_lineSkip};
-
-		SDL_BlitSurface(surface.getSurface(), nullptr,
-						internalSurface.getSurface(), &lineDest);
-
-		++line;
+		// Cached glyph images the atlas rejects are baked again
+		try
+		{
+			upload();
+		}
+		catch (std::exception const & exc)
+		{
+			EXCEPT(exc);
+			clearGlyphs();
+			bake();
+			upload();
+		}
 	}
-
-	/* Convert surface into a texture for accelerated rendering */
-	// TODO : memleak check
-	_texture = std::move(Texture::fromSurface(renderer, internalSurface));
+	else
+		upload();
 
 	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
-		"Build BitmapFont %p",
-		this);
+		"Build %s BitmapFont %p (%u glyphs, %u kerning pairs, "
+		"%dx%d atlas pages%s)",
+		renderMode == BLENDED ? "blended" : "solid",
+		this,
+		(unsigned int)_glyphs.size(),
+		(unsigned int)_kerningPairs.size(),
+		_pageSize,
+		_pageSize,
+		cached ? ", from cache" : "");
 }
 
 BitmapFont::BitmapFont(BitmapFont && other) :
 	_sdlRenderer(std::move(other._sdlRenderer)),
-	_alphabet(std::move(other._alphabet)),
-	_texture(std::move(other._texture)),
-	_glyphMetrics(std::move(other._glyphMetrics)),
-	_clips(std::move(other._clips)),
-	_lineSkip(std::move(other._lineSkip))
+	_ttfManager(std::move(other._ttfManager)),
+	_name(std::move(other._name)),
+	_size(std::move(other._size)),
+	_font(std::move(other._font)),
+	_lineSkip(std::move(other._lineSkip)),
+	_renderMode(std::move(other._renderMode)),
+	_pageSize(std::move(other._pageSize)),
+	_atlas(std::move(other._atlas)),
+	_glyphs(std::move(other._glyphs)),
+	_slots(std::move(other._slots)),
+	_usedSlots(std::move(other._usedSlots)),
+	_fallback(std::move(other._fallback)),
+	_kerningPairs(std::move(other._kerningPairs)),
+	_ellipsis(std::move(other._ellipsis)),
+	_ellipsisCount(std::move(other._ellipsisCount)),
+	_bakedPixels(std::move(other._bakedPixels)),
+	_uploaded(std::move(other._uploaded))
 {
 	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
 		"Move BitmapFont %p into new BitmapFont %p",
@@ -153,166 +195,1016 @@ BitmapFont::~BitmapFont(void)
 		this);
 }
 
-unsigned int BitmapFont::computeLineEnd(
-	std::string const & text,
-	unsigned int cursor,
-	unsigned int maxWidth) const
+Uint32 BitmapFont::findGlyph(Uint32 const codepoint) const
 {
-	unsigned int width(0), lastWordEnd(cursor), result(0);
-	char currentCharacter(0), previousCharacter(0);
+	std::size_t const mask(_slots.size() - 1);
+	for (std::size_t slot(hashCodepoint(codepoint) & mask) ;
+		_slots[slot].codepoint != BITMAP_FONT_EMPTY_SLOT ;
+		slot = (slot + 1) & mask)
+		if (_slots[slot].codepoint == codepoint)
+			return _slots[slot].glyph;
 
-	if (cursor >= text.length())
-		return text.length();
+	return BITMAP_FONT_NO_GLYPH;
+}
 
-	/* Browse characters until either of those conditions are met :
-	 * - End of text
-	 * - Max width has been reached or exceeded
-	 * - '\n' found
-	 */
-	while (cursor < text.length() && width < maxWidth)
+/*
+ * The table doubles once 70% full, which keeps probe sequences short.
+ */
+void BitmapFont::insertSlot(Uint32 const codepoint, Uint32 const glyph)
+{
+	auto place = [this](GlyphSlot const & entry)
 	{
-		currentCharacter = text.at(cursor);
-		/* Special case : newline character */
-		if (currentCharacter == '\n')
-			return cursor;
+		std::size_t const mask(_slots.size() - 1);
+		std::size_t slot(hashCodepoint(entry.codepoint) & mask);
+		while (_slots[slot].codepoint != BITMAP_FONT_EMPTY_SLOT)
+			slot = (slot + 1) & mask;
+		_slots[slot] = entry;
+	};
+
+	if ((_usedSlots + 1) * 10 > _slots.size() * 7)
+	{
+		std::vector<GlyphSlot> previous(
+			_slots.size() * 2,
+			GlyphSlot{BITMAP_FONT_EMPTY_SLOT, BITMAP_FONT_NO_GLYPH});
+		previous.swap(_slots);
+		for (GlyphSlot const & entry : previous)
+			if (entry.codepoint != BITMAP_FONT_EMPTY_SLOT)
+				place(entry);
+	}
+
+	place(GlyphSlot{codepoint, glyph});
+	++_usedSlots;
+}
+
+/*
+ * Glyph images already inserted into the atlas are left to eviction.
+ */
+void BitmapFont::clearGlyphs(void)
+{
+	_glyphs.clear();
+	_slots.assign(BITMAP_FONT_INITIAL_SLOTS,
+		GlyphSlot{BITMAP_FONT_EMPTY_SLOT, BITMAP_FONT_NO_GLYPH});
+	_usedSlots = 0;
+	_kerningPairs.clear();
+	_bakedPixels.clear();
+	_fallback = BITMAP_FONT_NO_GLYPH;
+	_ellipsis = BITMAP_FONT_NO_GLYPH;
+	_ellipsisCount = 0;
+}
+
+/*
+ * Fonts built from cache only open their TTF font on first use.
+ */
+TrueTypeFont * BitmapFont::getTrueTypeFont(void)
+{
+	if (_font == nullptr)
+	{
+		_font = _ttfManager->getFont(_name, _size);
+		if (_font == nullptr)
+			THROW(Exception,
+				"Cannot retrieve font '%s' size '%d'",
+				_name.c_str(),
+				_size);
+	}
+
+	return _font;
+}
+
+/*
+ * Rasterizes the replacement & ellipsis glyphs, then printable Latin1, and
+ * computes their kerning pairs.
+ */
+void BitmapFont::bake(void)
+{
+	TrueTypeFont * font(getTrueTypeFont());
+	_lineSkip = font->getLineSkip();
+
+	/* Size atlas pages after the font (shared pages must be as large) */
+	_pageSize = BITMAP_FONT_MIN_PAGE_SIZE;
+	while (_pageSize < 16 * font->getHeight() &&
+		_pageSize < BITMAP_FONT_MAX_PAGE_SIZE)
+		_pageSize *= 2;
+
+	/* Replacement glyph, for characters the font does not provide */
+	Uint32 const replacement(font->hasGlyph(UTF8_REPLACEMENT) ?
+		UTF8_REPLACEMENT :
+		'?');
+	_fallback = getGlyphIndex(replacement);
+
+	/* Ellipsis, for truncated layouts */
+	bool const hasEllipsis(font->hasGlyph(BITMAP_FONT_ELLIPSIS));
+	_ellipsis = getGlyphIndex(hasEllipsis ? BITMAP_FONT_ELLIPSIS : '.');
+	_ellipsisCount = hasEllipsis ? 1 : 3;
+
+	/* Preload printable Latin1 */
+	for (Uint32 codepoint(0x20) ; codepoint <= 0xFF ; ++codepoint)
+		if (!isControl(codepoint))
+			getGlyphIndex(codepoint);
+	buildKerningPairs();
+}
+
+/*
+ * Cache files are named after the font, size & render mode, plus a hash of
+ * the font file contents, of the style, outline & hinting of the TTF font
+ * glyphs are rasterized with, and of the SDL_ttf version : editing a font,
+ * changing its settings or updating SDL_ttf invalidates its cache files.
+ * TTF fonts not opened yet are hashed with the settings they open with.
+ */
+std::string BitmapFont::computeCachePath(std::string const & cacheDirectory)
+{
+	std::string const fontPath(_ttfManager->getFontPath(_name));
+	std::ifstream file(fontPath, std::ios::binary);
+	if (!file)
+		return std::string();
+
+	// FNV-1a
+	Uint64 hash(0xCBF29CE484222325ULL);
+	char buffer[4096];
+	while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+		for (std::streamsize index(0) ; index < file.gcount() ; ++index)
+		{
+			hash ^= (Uint8)buffer[index];
+			hash *= 0x100000001B3ULL;
+		}
 
-		width += _glyphMetrics[currentCharacter].advance;
-		if (cursor > 0)
+	TrueTypeFont const * font(_font != nullptr ?
+		_font :
+		_ttfManager->findFont(_name, _size));
+	SDL_version const * version(TTF_Linked_Version());
+	int const settings[6] = {
+		font != nullptr ? font->getStyle() : TTF_STYLE_NORMAL,
+		font != nullptr ? font->getOutline() : 0,
+		font != nullptr ? font->getHinting() : TTF_HINTING_NORMAL,
+		version->major,
+		version->minor,
+		version->patch};
+	for (int const setting : settings)
+		for (int shift(0) ; shift < 32 ; shift += 8)
 		{
-			previousCharacter = text.at(cursor - 1);
-			if (std::isspace(currentCharacter) &&
-				!std::isspace(previousCharacter))
-				lastWordEnd = cursor - 1;
+			hash ^= (Uint8)((Uint32)setting >> shift);
+			hash *= 0x100000001B3ULL;
 		}
-		++cursor;
+
+	std::string directory(cacheDirectory);
+	if (directory.back() != '/' && directory.back() != '\\')
+		directory += '/';
+
+	char suffix[64];
+	SDL_snprintf(suffix, sizeof(suffix), "-%d-%s-%016llx.vbnfont",
+		_size,
+		_renderMode == BLENDED ? "blended" : "solid",
+		(unsigned long long)hash);
+	return directory + _name + suffix;
+}
+
+/*
+ * Glyph images are staged, to be uploaded by upload().
+ *
+ * @returns	false if the cache file is missing, stale or malformed
+ */
+bool BitmapFont::loadCache(std::string const & path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	CacheHeader header;
+	file.read(reinterpret_cast<char *>(&header), sizeof(header));
+	if (!file ||
+		SDL_memcmp(header.magic, BITMAP_FONT_CACHE_MAGIC, 4) != 0 ||
+		header.version != BITMAP_FONT_CACHE_VERSION ||
+		header.renderMode != (Uint32)_renderMode ||
+		header.size != _size ||
+		header.lineSkip <= 0 ||
+		header.pageSize < BITMAP_FONT_MIN_PAGE_SIZE ||
+		header.pageSize > BITMAP_FONT_MAX_PAGE_SIZE ||
+		header.glyphCount > BITMAP_FONT_CACHE_MAX_ENTRIES ||
+		header.slotCount == 0 ||
+		header.slotCount > BITMAP_FONT_CACHE_MAX_ENTRIES ||
+		(header.slotCount & (header.slotCount - 1)) != 0 ||
+		header.usedSlotCount >= header.slotCount ||
+		header.kerningPairCount > BITMAP_FONT_CACHE_MAX_ENTRIES ||
+		header.fallback >= header.glyphCount ||
+		header.ellipsis >= header.glyphCount ||
+		header.ellipsisCount < 1 ||
+		header.ellipsisCount > 3)
+	{
+		DEBUG(SDL_LOG_CATEGORY_APPLICATION,
+			"Ignore stale or malformed font cache '%s'",
+			path.c_str());
+		return false;
 	}
 
-	/* Handle pixel width overflow */
-	if (width > maxWidth)
-		result = cursor - 2;
-	else
-		result = cursor - 1;
+	std::vector<Glyph> glyphs(header.glyphCount);
+	std::vector<GlyphSlot> slots(header.slotCount);
+	std::vector<KerningPair> kerningPairs(header.kerningPairCount);
+	file.read(reinterpret_cast<char *>(glyphs.data()),
+		glyphs.size() * sizeof(Glyph));
+	file.read(reinterpret_cast<char *>(slots.data()),
+		slots.size() * sizeof(GlyphSlot));
+	file.read(reinterpret_cast<char *>(kerningPairs.data()),
+		kerningPairs.size() * sizeof(KerningPair));
+	if (!file)
+		return false;
+
+	// Glyph images fill the rest of the file
+	std::streamoff const tablesEnd(file.tellg());
+	file.seekg(0, std::ios::end);
+	std::streamoff const fileEnd(file.tellg());
+	file.seekg(tablesEnd);
+	if (tablesEnd < 0 || fileEnd < tablesEnd || !file)
+		return false;
 
-	/* If we're not at the end of the text */
-	if (result + 1 < text.length())
+	std::size_t pixelSize(0);
+	for (Glyph const & glyph : glyphs)
 	{
-		/* We're cutting the line right in the middle of a word */
-		if(!std::isspace(text.at(result + 1)))
-			/* Finish the line at the last detected word's end instead */
-			result = lastWordEnd;
+		SDL_Rect const & area(glyph.region.area);
+		if (glyph.kerningBegin > kerningPairs.size() ||
+			glyph.kerningCount > kerningPairs.size() - glyph.kerningBegin ||
+			area.w < 0 || area.w > header.pageSize ||
+			area.h < 0 || area.h > header.pageSize ||
+			(area.w > 0) != (area.h > 0))
+			return false;
+		pixelSize += (std::size_t)area.w * area.h * 4;
 	}
+	// Lookups probe until an empty slot : the table must keep one
+	std::size_t usedSlots(0);
+	for (GlyphSlot const & slot : slots)
+		if (slot.codepoint != BITMAP_FONT_EMPTY_SLOT)
+		{
+			if (slot.glyph >= glyphs.size())
+				return false;
+			++usedSlots;
+		}
+	if (usedSlots != header.usedSlotCount ||
+		pixelSize != (std::size_t)(fileEnd - tablesEnd))
+		return false;
 
-	return result;
+	std::vector<Uint8> pixels(pixelSize);
+	file.read(reinterpret_cast<char *>(pixels.data()), pixels.size());
+	if (!file)
+		return false;
+
+	_lineSkip = header.lineSkip;
+	_pageSize = header.pageSize;
+	_fallback = header.fallback;
+	_ellipsis = header.ellipsis;
+	_ellipsisCount = header.ellipsisCount;
+	_glyphs = std::move(glyphs);
+	_slots = std::move(slots);
+	_usedSlots = header.usedSlotCount;
+	_kerningPairs = std::move(kerningPairs);
+	_bakedPixels = std::move(pixels);
+	return true;
 }
 
-void BitmapFont::renderText(std::string const & text,
-	SDL_Color const & color,
-	SDL_Rect const & destination)
+/*
+ * @throws	Exception	Glyph images already uploaded, or cannot write the
+ *						cache file
+ */
+void BitmapFont::saveCache(std::string const & path)
 {
-	int	maxLineWidth(destination.w),
-		maxLines(destination.h / _lineSkip);
-	if (maxLines < 1 || maxLineWidth < 1)
+	if (_uploaded)
+		THROW(Exception, "Cannot save font cache : glyphs already uploaded");
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		THROW(Exception, "Cannot write font cache '%s'", path.c_str());
+
+	CacheHeader header;
+	SDL_memcpy(header.magic, BITMAP_FONT_CACHE_MAGIC, 4);
+	header.version = BITMAP_FONT_CACHE_VERSION;
+	header.renderMode = (Uint32)_renderMode;
+	header.size = _size;
+	header.lineSkip = _lineSkip;
+	header.pageSize = _pageSize;
+	header.fallback = _fallback;
+	header.ellipsis = _ellipsis;
+	header.ellipsisCount = _ellipsisCount;
+	header.glyphCount = (Uint32)_glyphs.size();
+	header.slotCount = (Uint32)_slots.size();
+	header.usedSlotCount = (Uint32)_usedSlots;
+	header.kerningPairCount = (Uint32)_kerningPairs.size();
+
+	file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+	file.write(reinterpret_cast<char const *>(_glyphs.data()),
+		_glyphs.size() * sizeof(Glyph));
+	file.write(reinterpret_cast<char const *>(_slots.data()),
+		_slots.size() * sizeof(GlyphSlot));
+	file.write(reinterpret_cast<char const *>(_kerningPairs.data()),
+		_kerningPairs.size() * sizeof(KerningPair));
+	file.write(reinterpret_cast<char const *>(_bakedPixels.data()),
+		_bakedPixels.size());
+	if (!file)
+		THROW(Exception, "Cannot write font cache '%s'", path.c_str());
+
+	DEBUG(SDL_LOG_CATEGORY_APPLICATION,
+		"Write font cache '%s'",
+		path.c_str());
+}
+
+/*
+ * Glyphs are rendered in white, then tinted through vertex colors.
+ */
+SDL_Surface * BitmapFont::renderGlyph(Uint32 const codepoint)
+{
+	TrueTypeFont * font(getTrueTypeFont());
+	SDL_Color const white{255, 255, 255, 255};
+	return (_renderMode == BLENDED ?
+		font->renderBlendedGlyph(codepoint, white) :
+		font->renderSolidGlyph(codepoint, white));
+}
+
+/*
+ * Until upload(), glyph images are staged instead (converted to RGBA32), and
+ * glyph areas only hold their size.
+ */
+void BitmapFont::rasterize(Glyph & glyph)
+{
+	std::unique_ptr<SDL_Surface, decltype(&SDL_FreeSurface)> const image(
+		renderGlyph(glyph.codepoint),
+		&SDL_FreeSurface);
+	if (_uploaded)
+	{
+		glyph.region = _atlas->insert(image.get());
 		return;
+	}
 
-	/* -----------8<----------- DEBUG -----------8<----------- */
-	/* Draw destination rectangle */
-	if (SDL_SetRenderDrawColor(_sdlRenderer, 128, 0, 255, 255))
-		ERROR(SDL_LOG_CATEGORY_APPLICATION,
-			"Could not set renderer color : SDL error '%s'",
-			SDL_GetError());
-	if (SDL_RenderDrawRect(_sdlRenderer, &destination))
-		ERROR(SDL_LOG_CATEGORY_APPLICATION,
-			"Could not render rectangle : SDL error '%s'",
+	std::unique_ptr<SDL_Surface, decltype(&SDL_FreeSurface)> const converted(
+		SDL_ConvertSurfaceFormat(image.get(), SDL_PIXELFORMAT_RGBA32, 0),
+		&SDL_FreeSurface);
+	if (!converted)
+		THROW(Exception,
+			"Cannot convert glyph image : SDL error '%s'",
 			SDL_GetError());
-	/* ----------8<---------- END DEBUG ----------8<---------- */
 
-	/* Apply color and alpha modulation */
-	_texture.setColorAlphaMod(color);
+	for (int row(0) ; row < converted->h ; ++row)
+	{
+		Uint8 const * pixels(static_cast<Uint8 const *>(converted->pixels) +
+			(std::size_t)row * converted->pitch);
+		_bakedPixels.insert(_bakedPixels.end(),
+			pixels,
+			pixels + (std::size_t)converted->w * 4);
+	}
+	glyph.region = GlyphAtlas::Region{0, 0,
+		SDL_Rect{0, 0, converted->w, converted->h}};
+}
+
+/*
+ * Glyph images go into 'atlas' (or the atlas given at construction) if its
+ * pages fit the font, into an atlas owned by the font otherwise. Staged glyph
+ * images are inserted, then their pages pinned so that preloaded glyphs stay
+ * resident ; nothing is pinned if the atlas cannot keep an evictable page
+ * besides. Glyphs rasterized afterwards go straight to the atlas.
+ *
+ * @param	atlas		Atlas shared with other fonts, if any
+ * @throws	Exception	Invalid input parameters, atlas too small to keep the
+ *						staged glyphs resident, or SDL call error
+ */
+void BitmapFont::upload(std::shared_ptr<GlyphAtlas> const & atlas)
+{
+	if (_uploaded)
+		return;
+	if (atlas && atlas->isPremultiplied() != (_renderMode == BLENDED))
+		THROW(Exception, "Received 'atlas' with another alpha mode");
+
+	if (atlas)
+		_atlas = atlas;
+	if (!_atlas || _atlas->getPageSize() < _pageSize)
+		_atlas = std::make_shared<GlyphAtlas>(
+			_sdlRenderer,
+			_pageSize,
+			BITMAP_FONT_MAX_PAGES,
+			_renderMode == BLENDED);
+
+	std::vector<Uint16> pages;
+	Uint8 * image(_bakedPixels.data());
+	for (Glyph & glyph : _glyphs)
+	{
+		int const width(glyph.region.area.w);
+		int const height(glyph.region.area.h);
+		if (width <= 0)
+			continue;
+
+		std::unique_ptr<SDL_Surface, decltype(&SDL_FreeSurface)> const surface(
+			SDL_CreateRGBSurfaceWithFormatFrom(
+				image,
+				width,
+				height,
+				32,
+				width * 4,
+				SDL_PIXELFORMAT_RGBA32),
+			&SDL_FreeSurface);
+		if (!surface)
+			THROW(Exception,
+				"Cannot wrap baked glyph image : SDL error '%s'",
+				SDL_GetError());
 
-	/* First and last character for each line */
-	std::vector<std::pair<int, int>> lines;
+		glyph.region = _atlas->insert(surface.get());
+		if (std::find(pages.begin(), pages.end(), glyph.region.page) ==
+			pages.end())
+			pages.push_back(glyph.region.page);
+		image += (std::size_t)width * height * 4;
+	}
+
+	// Unpinned pages may have been evicted for the last staged glyphs
+	for (Glyph const & glyph : _glyphs)
+		if (glyph.region.area.w > 0 && !_atlas->isValid(glyph.region))
+			THROW(Exception,
+				"Glyph atlas %p cannot hold every preloaded glyph",
+				_atlas.get());
+	_atlas->pinPages(pages);
+
+	std::vector<Uint8>().swap(_bakedPixels);
+	_uploaded = true;
+}
 
-	/* Line computation loop */
-	unsigned int lineNumber(0), lineBegin(0), lineEnd(0);
+/*
+ * Missing glyphs are rasterized on first use. Control characters are blank,
+ * tabulations being as wide as a space. Once glyph images are uploaded, glyphs
+ * which cannot be rasterized are replaced by the fallback glyph.
+ */
+Uint32 BitmapFont::getGlyphIndex(Uint32 const codepoint)
+{
+	Uint32 index(findGlyph(codepoint));
+	if (index == BITMAP_FONT_NO_GLYPH)
+	{
+		try
+		{
+			index = addGlyph(codepoint);
+		}
+		catch (std::exception const & exc)
+		{
+			if (!_uploaded || _fallback == BITMAP_FONT_NO_GLYPH)
+				throw;
+
+			EXCEPT(exc);
+			index = _fallback;
+		}
+		insertSlot(codepoint, index);
+	}
+
+	return index;
+}
+
+/*
+ * Once glyph images are uploaded, new glyphs are rasterized when first drawn
+ * (see resolveGlyph()) : laying text out never touches the renderer.
+ *
+ * @returns	Index of the glyph to draw for 'codepoint' (new glyph or fallback)
+ */
+Uint32 BitmapFont::addGlyph(Uint32 const codepoint)
+{
+	if (!getTrueTypeFont()->hasGlyph(codepoint) &&
+		!isControl(codepoint) &&
+		_fallback != BITMAP_FONT_NO_GLYPH)
+		return _fallback;
+
+	Glyph glyph{codepoint,
+		GlyphAtlas::Region{0, 0, SDL_Rect{0, 0, 0, 0}},
+		0,
+		0,
+		0,
+		0};
+	if (codepoint == '\t')
+		glyph.advance = _glyphs[getGlyphIndex(' ')].advance;
+	else if (!isControl(codepoint))
+	{
+		TrueTypeFont::GlyphMetrics const metrics(
+			getTrueTypeFont()->getCodepointMetrics(codepoint));
+		glyph.xOffset = std::min(0, metrics.xMin);
+		glyph.advance = metrics.advance;
+		if (metrics.width > 0 && metrics.height > 0 && _uploaded)
+			glyph.region = GlyphAtlas::Region{BITMAP_FONT_PENDING_PAGE, 0,
+				SDL_Rect{0, 0, metrics.width, metrics.height}};
+		else if (metrics.width > 0 && metrics.height > 0)
+			rasterize(glyph);
+	}
+	_glyphs.push_back(glyph);
+	return (Uint32)(_glyphs.size() - 1);
+}
+
+/*
+ * Glyphs not rasterized yet, or whose atlas page was evicted since they were
+ * rasterized, are rasterized now.
+ */
+BitmapFont::Glyph const & BitmapFont::resolveGlyph(Uint32 const index)
+{
+	Glyph & glyph(_glyphs[index]);
+	if (glyph.region.area.w > 0)
+	{
+		if (_atlas->isValid(glyph.region))
+			_atlas->touch(glyph.region.page);
+		else
+			rasterize(glyph);
+	}
+
+	return glyph;
+}
+
+/*
+ * Glyphs which cannot be rasterized again are replaced by the fallback glyph
+ * (retried next time), or skipped if the fallback glyph fails too.
+ *
+ * @returns	Glyph to draw, nullptr if none
+ */
+BitmapFont::Glyph const * BitmapFont::resolveDrawnGlyph(Uint32 const index)
+{
+	try
+	{
+		return (&resolveGlyph(index));
+	}
+	catch (std::exception const & exc)
+	{
+		EXCEPT(exc);
+	}
+
+	if (index != _fallback && _fallback != BITMAP_FONT_NO_GLYPH)
+		try
+		{
+			return (&resolveGlyph(_fallback));
+		}
+		catch (std::exception const & exc)
+		{
+			EXCEPT(exc);
+		}
+
+	return nullptr;
+}
+
+/*
+ * Only pairs with a non-zero adjustment are stored, right after each other for
+ * a given left glyph & sorted by right codepoint : a lookup binary searches a
+ * few contiguous entries. Glyphs cached later on (outside of Latin1) are laid
+ * out without kerning.
+ */
+void BitmapFont::buildKerningPairs(void)
+{
+	TrueTypeFont * font(getTrueTypeFont());
+	_kerningPairs.clear();
+	if (font->getIsFixedWidth())
+		return;
+
+	for (Glyph & left : _glyphs)
+	{
+		left.kerningBegin = (Uint32)_kerningPairs.size();
+		for (Glyph const & right : _glyphs)
+		{
+			if (left.advance == 0 || right.advance == 0)
+				continue;
+
+			int const offset(font->getKerningSize(
+				left.codepoint,
+				right.codepoint));
+			if (offset != 0)
+				_kerningPairs.push_back(KerningPair{right.codepoint, offset});
+		}
+		left.kerningCount = (Uint32)_kerningPairs.size() - left.kerningBegin;
+
+		// Sorted by right codepoint, for getKerning() binary searches
+		std::sort(_kerningPairs.begin() + left.kerningBegin,
+			_kerningPairs.end(),
+			[](KerningPair const & a, KerningPair const & b) {
+				return (a.codepoint < b.codepoint);
+			});
+	}
+	_kerningPairs.shrink_to_fit();
+}
+
+int BitmapFont::getKerning(Glyph const & left, Glyph const & right) const
+{
+	auto const begin(_kerningPairs.begin() + left.kerningBegin);
+	auto const end(begin + left.kerningCount);
+	auto const pair(std::lower_bound(begin, end, right.codepoint,
+		[](KerningPair const & pair, Uint32 const codepoint) {
+			return (pair.codepoint < codepoint);
+		}));
+
+	return ((pair != end && pair->codepoint == right.codepoint) ?
+		pair->offset :
+		0);
+}
+
+/*
+ * Lines break at the last blank fitting in 'maxWidth', or in the middle of a
+ * word longer than a whole line ; '\n' always breaks. At least one character
+ * is laid out per line.
+ */
+std::size_t BitmapFont::computeLineEnd(
+	std::string_view const text,
+	std::size_t const begin,
+	int const maxWidth,
+	std::size_t & next)
+{
+	std::size_t cursor(begin), lastBreak(std::string_view::npos);
+	int width(0);
+	bool previousBlank(false);
+	Glyph previous(noGlyph);
+
+	while (cursor < text.size())
+	{
+		if (text[cursor] == '\n')
+		{
+			next = cursor + 1;
+			return cursor;
+		}
+
+		std::size_t const start(cursor);
+		Uint32 const codepoint(decodeUTF8(text, cursor));
+		bool const blank(isBlank(codepoint));
+		if (blank && !previousBlank && start > begin)
+			lastBreak = start;
+		previousBlank = blank;
+
+		Glyph const glyph(_glyphs[getGlyphIndex(codepoint)]);
+		int const advance(getKerning(previous, glyph) + glyph.advance);
+		previous = glyph;
+		if (width + advance > maxWidth && start > begin && !blank)
+		{
+			if (lastBreak != std::string_view::npos)
+			{
+				next = lastBreak;
+				return lastBreak;
+			}
+			next = start;
+			return start;
+		}
+		width += advance;
+	}
+
+	next = text.size();
+	return text.size();
+}
+
+/*
+ * Returns the width of [begin, end[ without trailing blanks ; 'visibleEnd' is
+ * set past the last non-blank character, 'gaps' to the number of blank runs
+ * between words.
+ */
+int BitmapFont::measureLine(
+	std::string_view const text,
+	std::size_t const begin,
+	std::size_t const end,
+	std::size_t & visibleEnd,
+	int & gaps)
+{
+	std::size_t cursor(begin);
+	int width(0), visibleWidth(0);
+	bool previousBlank(false);
+	Glyph previous(noGlyph);
+
+	visibleEnd = begin;
+	gaps = 0;
+	while (cursor < end)
+	{
+		Uint32 const codepoint(decodeUTF8(text, cursor));
+		bool const blank(isBlank(codepoint));
+		if (!blank && previousBlank)
+			++gaps;
+		previousBlank = blank;
+
+		Glyph const glyph(_glyphs[getGlyphIndex(codepoint)]);
+		width += getKerning(previous, glyph) + glyph.advance;
+		previous = glyph;
+		if (!blank)
+		{
+			visibleEnd = cursor;
+			visibleWidth = width;
+		}
+	}
+
+	return visibleWidth;
+}
+
+/*
+ * Returns where [begin, end[ must be cut so that it fits in 'maxWidth'.
+ */
+std::size_t BitmapFont::truncateLine(
+	std::string_view const text,
+	std::size_t const begin,
+	std::size_t const end,
+	int const maxWidth)
+{
+	std::size_t cursor(begin);
+	int width(0);
+	Glyph previous(noGlyph);
+
+	while (cursor < end)
+	{
+		std::size_t const start(cursor);
+		Uint32 const codepoint(decodeUTF8(text, cursor));
+		Glyph const glyph(_glyphs[getGlyphIndex(codepoint)]);
+		width += getKerning(previous, glyph) + glyph.advance;
+		previous = glyph;
+		if (width > maxWidth)
+			return start;
+	}
+
+	return end;
+}
+
+/*
+ * Shared by layoutText() & measureText() : glyphs are only placed when
+ * 'layout' is not nullptr. Lines which would not fit in 'height' are dropped ;
+ * with the ellipsis option, the last line is cut short to make room for an
+ * ellipsis when text remains.
+ */
+SDL_Rect BitmapFont::layoutLines(
+	std::string_view const text,
+	int const width,
+	int const height,
+	TextLayout::Options const & options,
+	TextLayout * layout)
+{
+	int const lineHeight(options.lineHeight > 0 ? options.lineHeight : _lineSkip);
+	int const maxLines(height / lineHeight);
+	if (maxLines < 1 || width < 1 || text.empty())
+		return SDL_Rect{0, 0, 0, 0};
+
+	Glyph const ellipsis(_glyphs[_ellipsis]);
+	int const ellipsisWidth(_ellipsisCount * ellipsis.advance);
+
+	/* Line computation & placement loop */
+	int lineNumber(0), left(0), right(0);
+	std::size_t lineBegin(0), nextLine(0);
 	do
 	{
-		/* Skip any whitespace prefixing the line */
-		while (lineBegin < text.length() && std::isspace(text.at(lineBegin)))
+		/* Skip any blank prefixing the line */
+		while (lineBegin < text.size() &&
+			isBlank((unsigned char)text[lineBegin]))
 			++lineBegin;
 
 		/* Compute line end using internal method */
-		lineEnd = computeLineEnd(text, lineBegin, maxLineWidth);
-		lines.push_back(std::make_pair(lineBegin, lineEnd));
+		std::size_t lineEnd(computeLineEnd(text, lineBegin, width, nextLine));
+		bool const paragraphEnd(nextLine >= text.size() ||
+			text[nextLine - 1] == '\n');
 
-		/* Increment line number & prepare next line beginning (if any) */
-		++lineNumber;
-		lineBegin = lineEnd + 1;
-	} while(lineNumber < maxLines && lineBegin < text.length());
+		/* Make room for an ellipsis if text remains after the last line */
+		bool truncated(false);
+		if (options.ellipsis && lineNumber + 1 == maxLines)
+		{
+			std::size_t const remaining(
+				text.find_first_not_of(" \t\n", nextLine));
+			if (remaining != std::string_view::npos)
+			{
+				truncated = true;
+				lineEnd = truncateLine(text, lineBegin, lineEnd,
+					width - ellipsisWidth);
+			}
+		}
 
+		std::size_t visibleEnd(lineBegin);
+		int gaps(0);
+		int const lineWidth(measureLine(text, lineBegin, lineEnd,
+			visibleEnd, gaps));
+		int const contentWidth(lineWidth + (truncated ? ellipsisWidth : 0));
 
-	/* Lines rendering loop */
-	bool error(false);
-	for(auto lineIterator = lines.begin() ;
-		lineIterator != lines.end() ;
-		++lineIterator)
-	{
-		std::string substring =
-			text.substr(lineIterator->first,
-				lineIterator->second - lineIterator->first +1);
+		/* Alignment */
+		int x(0), stretch(0), remainder(0);
+		switch (options.alignment)
+		{
+			case TextLayout::CENTER:
+				x = std::max(0, (width - contentWidth) / 2);
+			break;
+			case TextLayout::RIGHT:
+				x = std::max(0, width - contentWidth);
+			break;
+			case TextLayout::JUSTIFY:
+				if (!paragraphEnd && !truncated && gaps > 0 && lineWidth < width)
+				{
+					stretch = (width - lineWidth) / gaps;
+					remainder = (width - lineWidth) % gaps;
+				}
+			break;
+			case TextLayout::LEFT:
+			break;
+		}
 
-		int lineNumber = lineIterator - lines.begin();
+		/* Place glyphs */
+		int const y(lineNumber * lineHeight);
+		int pen(x), gap(0);
+		bool previousBlank(false);
+		Glyph previous(noGlyph);
+		std::size_t cursor(lineBegin);
+		while (cursor < visibleEnd)
+		{
+			Uint32 const codepoint(decodeUTF8(text, cursor));
+			bool const blank(isBlank(codepoint));
+			if (blank && !previousBlank)
+				pen += stretch + (gap++ < remainder ? 1 : 0);
+			previousBlank = blank;
 
-		int currentAdvance(0);
-		for(char c : substring)
+			Uint32 const index(getGlyphIndex(codepoint));
+			Glyph const glyph(_glyphs[index]);
+			pen += getKerning(previous, glyph);
+			previous = glyph;
+			if (layout != nullptr && glyph.region.area.w > 0)
+				layout->_glyphs.push_back(TextLayout::PlacedGlyph{
+					index,
+					pen + glyph.xOffset,
+					y});
+			pen += glyph.advance;
+		}
+		if (truncated)
+			for (int dot(0) ; dot < _ellipsisCount ; ++dot)
+			{
+				if (layout != nullptr && ellipsis.region.area.w > 0)
+					layout->_glyphs.push_back(TextLayout::PlacedGlyph{
+						_ellipsis,
+						pen + ellipsis.xOffset,
+						y});
+				pen += ellipsis.advance;
+			}
+
+		/* Line bounding box (empty lines still take their height) */
+		if (layout != nullptr)
+			layout->_lineBounds.push_back(SDL_Rect{x, y, pen - x, lineHeight});
+		if (lineNumber == 0)
 		{
-			TrueTypeFont::GlyphMetrics metrics = _glyphMetrics[c];
-			SDL_Rect source = _clips[c];
-			SDL_Rect glyphDest{destination.x + currentAdvance + _glyphMetrics[c].xMin,
-						destination.y + lineNumber*_lineSkip,
-						metrics.width,
-						_lineSkip};
-
-			error |= (SDL_RenderCopy(_sdlRenderer,
-						_texture.getSDLTexture(),
-						&source,
-						&glyphDest) != 0);
-
-			currentAdvance += metrics.advance;
+			left = x;
+			right = pen;
 		}
-	}
+		else
+		{
+			left = std::min(left, x);
+			right = std::max(right, pen);
+		}
+
+		/* Increment line number & prepare next line beginning (if any) */
+		++lineNumber;
+		lineBegin = nextLine;
+	} while(lineNumber < maxLines && lineBegin < text.size());
 
-	if (error)
+	return SDL_Rect{left, 0, right - left, lineNumber * lineHeight};
+}
+
+void BitmapFont::renderText(std::string_view const text,
+	SDL_Color const & color,
+	SDL_Rect const & destination)
+{
+	queueText(text, color, destination);
+	flush();
+}
+
+/*
+ * The text is laid out into an internal TextLayout (no per-call allocation
+ * once its storage has grown), then queued.
+ */
+void BitmapFont::queueText(std::string_view const text,
+	SDL_Color const & color,
+	SDL_Rect const & destination)
+{
+	layoutText(text, destination.w, destination.h, _scratchLayout);
+	queueLayout(_scratchLayout, color, destination.x, destination.y);
+}
+
+/*!
+ * @param	text	UTF-8 text to lay out
+ * @param	width	Maximum line width
+ * @param	height	Maximum layout height
+ * @param	layout	Layout to fill (storage is reused)
+ * @param	options	Alignment, line height & ellipsis
+ */
+void BitmapFont::layoutText(std::string_view const text,
+	int const width,
+	int const height,
+	TextLayout & layout,
+	TextLayout::Options const & options)
+{
+	layout._font = this;
+	layout._text.assign(text);
+	layout._width = width;
+	layout._height = height;
+	layout._options = options;
+	layout._glyphs.clear();
+	layout._lineBounds.clear();
+	layout._bounds = layoutLines(text, width, height, options, &layout);
+}
+
+/*!
+ * Runs the same line breaking as layoutText(), without placing glyphs nor
+ * allocating.
+ *
+ * @param	text	UTF-8 text to measure
+ * @param	width	Maximum line width
+ * @param	height	Maximum layout height
+ * @param	options	Alignment, line height & ellipsis
+ * @returns			Area the text would cover, relative to the layout origin
+ */
+SDL_Rect BitmapFont::measureText(std::string_view const text,
+	int const width,
+	int const height,
+	TextLayout::Options const & options)
+{
+	return layoutLines(text, width, height, options, nullptr);
+}
+
+/*!
+ * Glyphs are colored through their vertices, so layouts of different colors
+ * can share a batch.
+ *
+ * @param	layout		Layout computed with this font
+ * @param	color		Text color
+ * @param	x			X destination (layout origin)
+ * @param	y			Y destination (layout origin)
+ * @throws	Exception	Invalid input parameters
+ */
+void BitmapFont::queueLayout(TextLayout const & layout,
+	SDL_Color const & color,
+	int const x,
+	int const y)
+{
+	// Check input parameters
+	if (layout._font != this)
+		THROW(Exception, "Received 'layout' computed with another font");
+
+	for (TextLayout::PlacedGlyph const & placed : layout._glyphs)
 	{
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"BitmapFont::renderText: "
-			"Some SDL call returned error '%s'",
-			SDL_GetError());
+		Glyph const * glyph(resolveDrawnGlyph(placed.glyph));
+		if (glyph == nullptr)
+			continue;
+
+		_atlas->addQuad(glyph->region,
+			SDL_FRect{
+				(float)(x + placed.x),
+				(float)(y + placed.y),
+				(float)glyph->region.area.w,
+				(float)glyph->region.area.h},
+			color);
 	}
 }
 
-void BitmapFont::renderDebug(
+void BitmapFont::flush(void)
+{
+	_atlas->flush();
+}
+
+bool BitmapFont::hasQueuedGlyphs(void) const
+{
+	return _atlas->hasQueuedQuads();
+}
+
+/*
+ * Pages are stacked vertically, each glyph area being outlined.
+ */
+std::size_t BitmapFont::renderDebug(
 	int const xDest,
 	int const yDest)
 {
-	SDL_Rect dest{xDest, yDest, _texture.getWidth(), _texture.getHeight()};
+	int const pageSize(_atlas->getPageSize());
 	SDL_SetRenderDrawColor(_sdlRenderer, 255, 255, 255, 255);
-	SDL_RenderCopy(_sdlRenderer, _texture.getSDLTexture(), nullptr, &dest);
+	for (std::size_t page(0) ; page < _atlas->getPageCount() ; ++page)
+	{
+		SDL_Rect dest{xDest, yDest + (int)page * pageSize, pageSize, pageSize};
+		SDL_RenderCopy(_sdlRenderer,
+			_atlas->getPage(page)->getSDLTexture(),
+			nullptr,
+			&dest);
+	}
 
+	std::size_t outlines(0);
 	SDL_SetRenderDrawColor(_sdlRenderer, 255, 69, 0, 255);
-	for(auto rect : _clips)
+	for (Glyph const & glyph : _glyphs)
 	{
+		if (glyph.region.area.w <= 0 || !_atlas->isValid(glyph.region))
+			continue;
+
+		SDL_Rect rect(glyph.region.area);
 		rect.x += xDest;
-		rect.y += yDest;
+		rect.y += yDest + glyph.region.page * pageSize;
 		SDL_RenderDrawRect(_sdlRenderer, &rect);
+		++outlines;
 	}
+
+	return outlines;
 }
 
-std::array<SDL_Rect, UCHAR_MAX> BitmapFont::getClips(void) const
+Texture const * BitmapFont::getTexture(void)
 {
-	return _clips;
+	return _atlas->getPage(0);
 }
 
-Texture const * BitmapFont::getTexture(void)
+GlyphAtlas * BitmapFont::getAtlas(void)
+{
+	return _atlas.get();
+}
+
+std::size_t BitmapFont::getGlyphCount(void) const
+{
+	return _glyphs.size();
+}
+
+int BitmapFont::getLineSkip(void) const
+{
+	return _lineSkip;
+}
+
+int BitmapFont::getPageSize(void) const
 {
-	return &_texture;
-}
\ No newline at end of file
+	return _pageSize;
+}
+
+BitmapFont::RenderMode BitmapFont::getRenderMode(void) const
+{
+	return _renderMode;
+}
@@ -1,13 +1,23 @@
 #include <VBN/BitmapFontManager.hpp>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include <VBN/TrueTypeFontManager.hpp>
 #include <VBN/Logging.hpp>
 #include <VBN/Exceptions.hpp>
 
+//! Minimum shared atlas page size & page count (pages are created on demand)
+#define BITMAP_FONT_MANAGER_PAGE_SIZE 1024
+#define BITMAP_FONT_MANAGER_MAX_PAGES 16
+
 BitmapFontManager::BitmapFontManager(
 	std::shared_ptr<TrueTypeFontManager> trueTypeFontManager,
 	SDL_Renderer * renderer) :
 	_renderer(renderer),
-	_trueTypeFontManager(trueTypeFontManager)
+	_trueTypeFontManager(trueTypeFontManager),
+	_renderMode(BitmapFont::SOLID)
 {
 	if (!trueTypeFontManager)
 		THROW(Exception, "Received nullptr 'trueTypeFontManager'");
@@ -24,7 +34,10 @@ BitmapFontManager::BitmapFontManager(
 BitmapFontManager::BitmapFontManager(BitmapFontManager && other) :
 	_renderer(std::move(other._renderer)),
 	_trueTypeFontManager(other._trueTypeFontManager),
-	_fonts(std::move(other._fonts))
+	_fonts(std::move(other._fonts)),
+	_renderMode(std::move(other._renderMode)),
+	_cacheDirectory(std::move(other._cacheDirectory)),
+	_atlases(std::move(other._atlases))
 {
 	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
 		"Move BitmapFontManager %p into new BitmapFontManager %p",
@@ -39,19 +52,159 @@ BitmapFontManager::~BitmapFontManager(void)
 		this);
 }
 
+/*!
+ * Every font of a given render mode packs its glyphs into the same atlas
+ * pages : texts printed with different fonts & sizes are then drawn by a
+ * single call per page. Fonts too large for the pages get their own atlas.
+ *
+ * @param	pageSize	Page size, if the atlas is created
+ * @returns				Atlas shared by fonts of the current render mode
+ * @throws	Exception	Invalid input parameters
+ */
+std::shared_ptr<GlyphAtlas> BitmapFontManager::getSharedAtlas(
+	int const pageSize)
+{
+	std::shared_ptr<GlyphAtlas> & atlas(_atlases[_renderMode]);
+	if (!atlas)
+		atlas = std::make_shared<GlyphAtlas>(
+			_renderer,
+			pageSize,
+			BITMAP_FONT_MANAGER_MAX_PAGES,
+			_renderMode == BitmapFont::BLENDED);
+
+	return atlas;
+}
+
+/*!
+ * Fonts are baked in parallel, one per worker thread at a time : each worker
+ * rasterizes with its own TTF font (TTF fonts are not thread-safe), while
+ * glyph images are uploaded into the shared atlas on the calling thread once
+ * every font is baked. The shared atlas, if created here, gets pages fitting
+ * the largest font. Preloaded fonts keep their printable Latin1 glyphs
+ * resident in the atlas pages ; fonts which would pin the last evictable
+ * page are not generated.
+ *
+ * @param	fonts			{name, size} of the fonts to generate
+ * @param	rendererMutex	Mutex to hold while looking fonts up & uploading,
+ *							when the SDL_Renderer is shared with another
+ *							thread (nullptr = none ; never held while baking)
+ */
 void BitmapFontManager::preload(
-	std::vector <std::pair<std::string, int>> const fonts)
+	std::vector <std::pair<std::string, int>> const fonts,
+	std::recursive_mutex * rendererMutex)
 {
+	std::unique_lock<std::recursive_mutex> lock;
+	if (rendererMutex != nullptr)
+		lock = std::unique_lock<std::recursive_mutex>(*rendererMutex);
+
+	// Skip fonts already generated (or requested twice)
+	std::vector<std::pair<std::string, int>> missing;
 	for(auto const & fontConfig : fonts)
 	{
+		if (fontConfig.second <= 0)
+			THROW(Exception, "Received 'size' <= 0");
+		if (findFont(fontConfig.first, fontConfig.second) != nullptr ||
+			std::find(missing.begin(), missing.end(), fontConfig) !=
+				missing.end())
+			continue;
+
 		DEBUG(SDL_LOG_CATEGORY_APPLICATION,
 			"BitmapFontManager::preload: preloading font "
 			"'%s' size %d",
 			fontConfig.first.c_str(),
 			fontConfig.second);
+		missing.push_back(fontConfig);
+	}
+	if (missing.empty())
+		return;
+	if (lock.owns_lock())
+		lock.unlock();
+
+	// Bake on worker threads (the calling thread included)
+	std::vector<std::unique_ptr<BitmapFont>> baked(missing.size());
+	std::vector<std::exception_ptr> errors(missing.size());
+	std::atomic<std::size_t> next(0);
+	auto bake = [&](void)
+	{
+		for (std::size_t index(next++) ; index < missing.size() ;
+			index = next++)
+		{
+			std::unique_ptr<TrueTypeFont> bakingFont(nullptr);
+			try
+			{
+				bakingFont.reset(new TrueTypeFont(
+					_trueTypeFontManager->getFontPath(missing[index].first),
+					missing[index].second));
+				baked[index].reset(new BitmapFont(
+					_trueTypeFontManager,
+					missing[index].first,
+					missing[index].second,
+					_renderer,
+					_renderMode,
+					_cacheDirectory,
+					nullptr,
+					bakingFont.get()));
+			}
+			catch (...)
+			{
+				errors[index] = std::current_exception();
+			}
+		}
+	};
+
+	std::size_t const threadCount(std::max<std::size_t>(1,
+		std::min<std::size_t>(std::thread::hardware_concurrency(),
+			missing.size())));
+	std::vector<std::thread> workers;
+	for (std::size_t index(1) ; index < threadCount ; ++index)
+		workers.emplace_back(bake);
+	bake();
+	for (std::thread & worker : workers)
+		worker.join();
 
-		getFont(fontConfig.first, fontConfig.second);
+	if (rendererMutex != nullptr)
+		lock.lock();
+	int pageSize(BITMAP_FONT_MANAGER_PAGE_SIZE);
+	for (std::unique_ptr<BitmapFont> const & font : baked)
+		if (font)
+			pageSize = std::max(pageSize, font->getPageSize());
+	std::shared_ptr<GlyphAtlas> atlas(nullptr);
+	try
+	{
+		atlas = getSharedAtlas(pageSize);
+	}
+	catch (Exception const & exc)
+	{
+		EXCEPT(exc);
+		return;
+	}
+
+	// Upload on the calling thread, in request order
+	for (std::size_t index(0) ; index < missing.size() ; ++index)
+	{
+		try
+		{
+			if (errors[index])
+				std::rethrow_exception(errors[index]);
+
+			baked[index]->upload(atlas);
+			_fonts.emplace(
+				std::make_tuple(
+					missing[index].first,
+					missing[index].second,
+					_renderMode),
+				std::move(*baked[index]));
+		}
+		catch (std::exception const & exc)
+		{
+			EXCEPT(exc);
+		}
 	}
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Preload %u fonts with %u threads",
+		(unsigned int)missing.size(),
+		(unsigned int)threadCount);
 }
 
 BitmapFont * BitmapFontManager::getFont(
@@ -63,7 +216,8 @@ BitmapFont * BitmapFontManager::getFont(
 
 	BitmapFont * font(nullptr);
 
-	auto const fontIterator = _fonts.find(make_pair(name, size));
+	auto const fontIterator = _fonts.find(
+		std::make_tuple(name, size, _renderMode));
 	if(fontIterator == _fonts.end())
 	{
 		DEBUG(SDL_LOG_CATEGORY_APPLICATION,
@@ -72,10 +226,12 @@ BitmapFont * BitmapFontManager::getFont(
 
 		try
 		{
-			BitmapFont bitmapFont(_trueTypeFontManager, name, size, _renderer);
+			BitmapFont bitmapFont(_trueTypeFontManager, name, size, _renderer,
+				_renderMode, _cacheDirectory,
+				getSharedAtlas(BITMAP_FONT_MANAGER_PAGE_SIZE));
 
 			auto insertedPair(_fonts.emplace(
-				make_pair(name, size),
+				std::make_tuple(name, size, _renderMode),
 				std::move(bitmapFont)));
 
 			font = (&insertedPair.first->second);
@@ -91,4 +247,69 @@ BitmapFont * BitmapFontManager::getFont(
 	}
 
 	return font;
-}
\ No newline at end of file
+}
+
+/*!
+ * Unlike getFont(), never generates the font (no SDL call).
+ *
+ * @param	name	Font name
+ * @param	size	Font size
+ * @returns			The generated BitmapFont, nullptr if not generated yet
+ */
+BitmapFont * BitmapFontManager::findFont(
+	std::string const & name,
+	int const size)
+{
+	auto const fontIterator = _fonts.find(
+		std::make_tuple(name, size, _renderMode));
+	if (fontIterator == _fonts.end())
+		return nullptr;
+
+	return (&fontIterator->second);
+}
+
+/*!
+ * Fonts already generated with another render mode are kept, so that
+ * switching back does not rasterize them again.
+ *
+ * @param	renderMode	Render mode of fonts returned from now on
+ */
+void BitmapFontManager::setRenderMode(BitmapFont::RenderMode const renderMode)
+{
+	_renderMode = renderMode;
+}
+
+BitmapFont::RenderMode BitmapFontManager::getRenderMode(void) const
+{
+	return _renderMode;
+}
+
+/*!
+ * Fonts generated afterwards are loaded from their
+ * cache file when it matches the font file, size & render mode ; they are
+ * baked & written to the directory otherwise.
+ *
+ * @param	cacheDirectory	Existing directory ("" disables the cache)
+ */
+void BitmapFontManager::setCacheDirectory(std::string const & cacheDirectory)
+{
+	_cacheDirectory = cacheDirectory;
+}
+
+std::string const & BitmapFontManager::getCacheDirectory(void) const
+{
+	return _cacheDirectory;
+}
+
+/*!
+ * @returns	Page count & allocated area of the shared atlas (no page before
+ *			the first font of the current render mode is generated)
+ */
+GlyphAtlas::Occupancy BitmapFontManager::getAtlasOccupancy(void) const
+{
+	auto const atlasIterator(_atlases.find(_renderMode));
+	if (atlasIterator == _atlases.end())
+		return GlyphAtlas::Occupancy{0, BITMAP_FONT_MANAGER_MAX_PAGES, 0, 0, 0};
+
+	return atlasIterator->second->getOccupancy();
+}
@@ -1,6 +1,7 @@
 #include <VBN/Engine.hpp>
 #include <VBN/EngineUpdate.hpp>
 #include <VBN/IGameContext.hpp>
+#include <VBN/ResolutionController.hpp>
 #include <SDL2/SDL_timer.h>
 #include <VBN/Logging.hpp>
 #include <numeric>
@@ -63,6 +64,11 @@ void Engine::run(float const gameTicksPerMillisecond)
 		frameDuration = SDL_GetTicks() - frameStartTime;
 /* ---- End chrono measure -------------------------------------------------- */
 
+/* ---- Begin resolution scaling -------------------------------------------- */
+		if (_resolutionController)
+			_resolutionController->update();
+/* ---- End resolution scaling ---------------------------------------------- */
+
 /* ---- Begin chrono correction --------------------------------------------- */
 		unusedTime = nominalFrameDuration - frameDuration;
 		if (unusedTime > 0)
@@ -114,3 +120,12 @@ Uint32 Engine::getInstantMillisecondsPerFrame(void)
 {
 	return _msPerFrame.front();
 }
+
+/* The controller is updated once per frame : it reads the rendering time of
+the last completed frame (presentation & vsync wait excluded) and adjusts render
+resolution to keep frames within budget */
+void Engine::setResolutionController(
+	std::shared_ptr<ResolutionController> controller)
+{
+	_resolutionController = controller;
+}
@@ -0,0 +1,358 @@
+#include <VBN/FrameCapture.hpp>
+#include <VBN/Logging.hpp>
+#include <VBN/Exceptions.hpp>
+#include <SDL2/SDL_image.h>
+#include <fstream>
+
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF 0x40
+#define QOI_OP_LUMA 0x80
+#define QOI_OP_RUN 0xc0
+#define QOI_OP_RGB 0xfe
+#define QOI_OP_RGBA 0xff
+
+/*!
+ * @param	maxPending	Maximum number of frames read back but not written yet
+ * @throws	Exception	Invalid input parameters
+ */
+FrameCapture::FrameCapture(std::size_t const maxPending) :
+	_maxPending(maxPending),
+	_inFlight(0),
+	_dropped(0),
+	_stopping(false)
+{
+	// Check input parameters
+	if (maxPending == 0)
+		THROW(Exception, "Received 'maxPending' == 0");
+
+	_worker = std::thread(&FrameCapture::work, this);
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Build FrameCapture %p (%u pending frames max)",
+		this,
+		(unsigned int)maxPending);
+}
+
+/*!
+ * Frames already read back are written before the encoder thread exits.
+ */
+FrameCapture::~FrameCapture(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_condition.notify_all();
+	_worker.join();
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Delete FrameCapture %p",
+		this);
+}
+
+void FrameCapture::work(void)
+{
+	for (;;)
+	{
+		Frame frame;
+
+		// Wait for a frame (pending frames are written before exiting)
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, [this] {
+				return (_stopping || !_pending.empty());
+			});
+			if (_pending.empty())
+				return;
+
+			frame = std::move(_pending.front());
+			_pending.pop_front();
+		}
+
+		// Encode outside of the lock
+		try
+		{
+			write(frame);
+			DEBUG(SDL_LOG_CATEGORY_APPLICATION,
+				"Captured frame written to '%s'",
+				frame.path.c_str());
+		}
+		catch (Exception const & exc)
+		{
+			EXCEPT(exc);
+		}
+
+		// Give buffer back to the pool
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_pool.push_back(std::move(frame.pixels));
+			--_inFlight;
+		}
+		_condition.notify_all();
+	}
+}
+
+/*!
+ * @param	frame		Frame to write (pixels are modified)
+ * @throws	Exception	Cannot encode or write file
+ */
+void FrameCapture::write(Frame & frame)
+{
+	// Back buffers may hold any alpha : screenshots are opaque
+	for (std::size_t index(3) ; index < frame.pixels.size() ; index += 4)
+		frame.pixels[index] = 255;
+
+	if (frame.format == QOI)
+		writeQOI(frame);
+	else
+		writePNG(frame);
+}
+
+/*!
+ * Follows the QOI specification 1.0 (https://qoiformat.org)
+ *
+ * @param	frame		Frame to write
+ * @throws	Exception	Cannot write file
+ */
+void FrameCapture::writeQOI(Frame const & frame)
+{
+	std::vector<Uint8> data;
+	data.reserve(14 + frame.pixels.size() / 2 + 8);
+
+	// Header (big endian)
+	Uint8 const header[14] = {
+		'q', 'o', 'i', 'f',
+		(Uint8)(frame.width >> 24), (Uint8)(frame.width >> 16),
+		(Uint8)(frame.width >> 8), (Uint8)frame.width,
+		(Uint8)(frame.height >> 24), (Uint8)(frame.height >> 16),
+		(Uint8)(frame.height >> 8), (Uint8)frame.height,
+		4,	// RGBA
+		0	// sRGB
+	};
+	data.insert(data.end(), header, header + sizeof(header));
+
+	// Chunks
+	Uint8 index[64][4] = {{0}};
+	Uint8 previous[4] = {0, 0, 0, 255};
+	int run(0);
+	std::size_t const end(frame.pixels.size());
+	for (std::size_t position(0) ; position < end ; position += 4)
+	{
+		Uint8 const * pixel(&frame.pixels[position]);
+
+		if (SDL_memcmp(pixel, previous, 4) == 0)
+		{
+			++run;
+			if (run == 62 || position + 4 == end)
+			{
+				data.push_back((Uint8)(QOI_OP_RUN | (run - 1)));
+				run = 0;
+			}
+			continue;
+		}
+
+		if (run > 0)
+		{
+			data.push_back((Uint8)(QOI_OP_RUN | (run - 1)));
+			run = 0;
+		}
+
+		int const hash((pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7
+			+ pixel[3] * 11) % 64);
+		if (SDL_memcmp(index[hash], pixel, 4) == 0)
+			data.push_back((Uint8)(QOI_OP_INDEX | hash));
+		else
+		{
+			SDL_memcpy(index[hash], pixel, 4);
+
+			if (pixel[3] == previous[3])
+			{
+				Sint8 const dr((Sint8)(pixel[0] - previous[0]));
+				Sint8 const dg((Sint8)(pixel[1] - previous[1]));
+				Sint8 const db((Sint8)(pixel[2] - previous[2]));
+				Sint8 const drg((Sint8)(dr - dg));
+				Sint8 const dbg((Sint8)(db - dg));
+
+				if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2)
+					data.push_back((Uint8)(QOI_OP_DIFF
+						| (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+				else if (drg > -9 && drg < 8 && dg > -33 && dg < 32 &&
+					dbg > -9 && dbg < 8)
+				{
+					data.push_back((Uint8)(QOI_OP_LUMA | (dg + 32)));
+					data.push_back((Uint8)((drg + 8) << 4 | (dbg + 8)));
+				}
+				else
+				{
+					data.push_back(QOI_OP_RGB);
+					data.insert(data.end(), pixel, pixel + 3);
+				}
+			}
+			else
+			{
+				data.push_back(QOI_OP_RGBA);
+				data.insert(data.end(), pixel, pixel + 4);
+			}
+		}
+
+		SDL_memcpy(previous, pixel, 4);
+	}
+
+	// End marker
+	Uint8 const padding[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+	data.insert(data.end(), padding, padding + sizeof(padding));
+
+	std::ofstream file(frame.path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<char const *>(data.data()), data.size());
+	if (!file)
+		THROW(Exception, "Cannot write '%s'", frame.path.c_str());
+}
+
+/*!
+ * @param	frame		Frame to write
+ * @throws	Exception	SDL/IMG call error
+ */
+void FrameCapture::writePNG(Frame & frame)
+{
+	SDL_Surface * surface(SDL_CreateRGBSurfaceWithFormatFrom(
+		frame.pixels.data(),
+		frame.width,
+		frame.height,
+		32,
+		frame.width * 4,
+		SDL_PIXELFORMAT_RGBA32));
+	if (surface == nullptr)
+		THROW(Exception,
+			"Cannot wrap captured frame : SDL error '%s'",
+			SDL_GetError());
+
+	int const status(IMG_SavePNG(surface, frame.path.c_str()));
+	SDL_FreeSurface(surface);
+	if (status)
+		THROW(Exception,
+			"Cannot write '%s' : IMG error '%s'",
+			frame.path.c_str(),
+			IMG_GetError());
+}
+
+/*!
+ * The whole rendering output is read back, regardless of current viewport &
+ * logical size. Must be called with the default rendering target bound, before
+ * SDL_RenderPresent().
+ *
+ * @param	renderer	SDL_Renderer to read back from
+ * @param	path		Destination file
+ * @param	format		Destination file format
+ * @returns				Whether the frame was queued (false if dropped)
+ */
+bool FrameCapture::capture(
+	SDL_Renderer * renderer,
+	std::string const & path,
+	Format const format)
+{
+	Frame frame;
+	frame.path = path;
+	frame.format = format;
+
+	// Take a pooled buffer, unless too many frames are in flight
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_inFlight >= _maxPending)
+		{
+			++_dropped;
+			WARNING(SDL_LOG_CATEGORY_APPLICATION,
+				"Dropped capture '%s' : %u frames waiting for encoding",
+				path.c_str(),
+				(unsigned int)_inFlight);
+			return false;
+		}
+
+		++_inFlight;
+		if (!_pool.empty())
+		{
+			frame.pixels = std::move(_pool.back());
+			_pool.pop_back();
+		}
+	}
+
+	// Read the whole output back (viewport is temporarily reset)
+	SDL_Rect viewport{0, 0, 0, 0};
+	int logicalWidth(0);
+	int logicalHeight(0);
+	SDL_RenderGetViewport(renderer, &viewport);
+	SDL_RenderGetLogicalSize(renderer, &logicalWidth, &logicalHeight);
+	SDL_RenderSetViewport(renderer, nullptr);
+
+	bool captured(false);
+	if (SDL_GetRendererOutputSize(renderer, &frame.width, &frame.height))
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot get renderer output size : SDL error '%s'",
+			SDL_GetError());
+	else
+	{
+		frame.pixels.resize((std::size_t)frame.width * frame.height * 4);
+		if (SDL_RenderReadPixels(renderer,
+			nullptr,
+			SDL_PIXELFORMAT_RGBA32,
+			frame.pixels.data(),
+			frame.width * 4))
+			ERROR(SDL_LOG_CATEGORY_ERROR,
+				"Cannot read rendered pixels : SDL error '%s'",
+				SDL_GetError());
+		else
+			captured = true;
+	}
+
+	if (logicalWidth > 0 && logicalHeight > 0)
+		SDL_RenderSetLogicalSize(renderer, logicalWidth, logicalHeight);
+	else
+		SDL_RenderSetViewport(renderer, &viewport);
+
+	// Hand over to the encoder thread
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (captured)
+			_pending.push_back(std::move(frame));
+		else
+		{
+			_pool.push_back(std::move(frame.pixels));
+			--_inFlight;
+		}
+	}
+	_condition.notify_all();
+
+	return captured;
+}
+
+void FrameCapture::flush(void)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_condition.wait(lock, [this] {
+		return (_inFlight == 0);
+	});
+}
+
+std::size_t FrameCapture::getPendingCount(void)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _inFlight;
+}
+
+Uint32 FrameCapture::getDroppedCount(void)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _dropped;
+}
+
+/*!
+ * @param	path	Image file path
+ * @returns			QOI for ".qoi" files (case insensitive), PNG otherwise
+ */
+FrameCapture::Format FrameCapture::formatFromPath(std::string const & path)
+{
+	if (path.size() >= 4 &&
+		SDL_strcasecmp(path.c_str() + path.size() - 4, ".qoi") == 0)
+		return QOI;
+
+	return PNG;
+}
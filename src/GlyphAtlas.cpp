@@ -0,0 +1,480 @@
+#include <VBN/GlyphAtlas.hpp>
+#include <algorithm>
+#include <VBN/Logging.hpp>
+#include <VBN/Exceptions.hpp>
+
+//! Transparent gap kept around glyphs, so that filtering never bleeds
+#define GLYPH_ATLAS_PADDING 1
+
+/*!
+ * @param	renderer	Raw SDL_Renderer to create pages for
+ * @param	pageSize	Width & height of every page
+ * @param	maxPages		Maximum number of pages
+ * @param	premultiplied	Whether to premultiply glyph images by alpha
+ * @throws	Exception		Invalid input parameters
+ */
+GlyphAtlas::GlyphAtlas(
+	SDL_Renderer * renderer,
+	int const pageSize,
+	std::size_t const maxPages,
+	bool const premultiplied) :
+	_sdlRenderer(renderer),
+	_pageSize(pageSize),
+	_maxPages(maxPages),
+	_useStamp(0),
+	_premultiplied(premultiplied),
+	_premultiplyPixels(premultiplied)
+{
+	// Check input parameters
+	if (renderer == nullptr)
+		THROW(Exception, "Received nullptr 'renderer'");
+	if (pageSize <= 0)
+		THROW(Exception, "Received 'pageSize' <= 0");
+	if (maxPages == 0)
+		THROW(Exception, "Received 'maxPages' == 0");
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Build GlyphAtlas %p (%dx%d pages, %u max%s)",
+		this,
+		pageSize,
+		pageSize,
+		(unsigned int)maxPages,
+		premultiplied ? ", premultiplied" : "");
+}
+
+GlyphAtlas::GlyphAtlas(GlyphAtlas && other) :
+	_sdlRenderer(std::move(other._sdlRenderer)),
+	_pageSize(std::move(other._pageSize)),
+	_maxPages(std::move(other._maxPages)),
+	_pages(std::move(other._pages)),
+	_useStamp(std::move(other._useStamp)),
+	_premultiplied(std::move(other._premultiplied)),
+	_premultiplyPixels(std::move(other._premultiplyPixels)),
+	_uploadBuffer(std::move(other._uploadBuffer))
+{
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Move GlyphAtlas %p into new GlyphAtlas %p",
+		&other,
+		this);
+}
+
+GlyphAtlas::~GlyphAtlas(void)
+{
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Delete GlyphAtlas %p",
+		this);
+}
+
+/*!
+ * @throws	Exception	SDL call error
+ */
+void GlyphAtlas::addPage(void)
+{
+	// Pages start fully transparent
+	std::vector<Uint8> const blank((std::size_t)_pageSize * _pageSize * 4, 0);
+	Texture texture(Texture::fromPixels(
+		_sdlRenderer,
+		SDL_PIXELFORMAT_RGBA32,
+		_pageSize,
+		_pageSize,
+		blank.data(),
+		_pageSize * 4));
+	// Fall back to straight alpha if the renderer rejects the premultiplied
+	// blending mode (pages are then created with SDL_BLENDMODE_BLEND)
+	if (_premultiplyPixels &&
+		SDL_SetTextureBlendMode(texture.getSDLTexture(),
+			SDL_ComposeCustomBlendMode(
+				SDL_BLENDFACTOR_ONE,
+				SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+				SDL_BLENDOPERATION_ADD,
+				SDL_BLENDFACTOR_ONE,
+				SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+				SDL_BLENDOPERATION_ADD)))
+	{
+		WARNING(SDL_LOG_CATEGORY_RENDER,
+			"Premultiplied blending unsupported : SDL error '%s', "
+				"using straight alpha",
+			SDL_GetError());
+		_premultiplyPixels = false;
+		texture.setBlendMode(SDL_BLENDMODE_BLEND);
+		for (Page & page : _pages)
+			page.texture.setBlendMode(SDL_BLENDMODE_BLEND);
+	}
+
+	_pages.push_back(Page{
+		std::move(texture),
+		std::vector<Shelf>(),
+		0,
+		0,
+		_useStamp,
+		false,
+		std::vector<SDL_Vertex>(),
+		std::vector<int>()});
+}
+
+/*!
+ * Quads queued on the page are drawn first, as they refer to its former
+ * contents.
+ *
+ * @param	page	Page to clear
+ */
+void GlyphAtlas::clearPage(Page & page)
+{
+	if (!page.vertices.empty())
+	{
+		if (SDL_RenderGeometry(_sdlRenderer,
+			page.texture.getSDLTexture(),
+			page.vertices.data(),
+			(int)page.vertices.size(),
+			page.indices.data(),
+			(int)page.indices.size()))
+			ERROR(SDL_LOG_CATEGORY_ERROR,
+				"Cannot render glyphs : SDL error '%s'",
+				SDL_GetError());
+		page.vertices.clear();
+		page.indices.clear();
+	}
+
+	std::vector<Uint8> const blank((std::size_t)_pageSize * _pageSize * 4, 0);
+	if (SDL_UpdateTexture(page.texture.getSDLTexture(),
+		nullptr,
+		blank.data(),
+		_pageSize * 4))
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot clear glyph atlas page : SDL error '%s'",
+			SDL_GetError());
+
+	page.shelves.clear();
+	page.nextShelfY = 0;
+	++page.generation;
+}
+
+/*!
+ * The shelf wasting the least height is picked ; a new shelf is opened if
+ * none fits.
+ *
+ * @param	page	Page to allocate in
+ * @param	width	Area width (padding included)
+ * @param	height	Area height (padding included)
+ * @param	area	Set to the allocated area on success
+ * @returns			Whether the area could be allocated
+ */
+bool GlyphAtlas::allocateInPage(
+	Page & page,
+	int const width,
+	int const height,
+	SDL_Rect & area)
+{
+	Shelf * best(nullptr);
+	for (Shelf & shelf : page.shelves)
+		if (shelf.height >= height &&
+			shelf.x + width <= _pageSize &&
+			(best == nullptr || shelf.height < best->height))
+			best = &shelf;
+
+	if (best == nullptr)
+	{
+		if (page.nextShelfY + height > _pageSize)
+			return false;
+
+		page.shelves.push_back(Shelf{page.nextShelfY, height, 0});
+		page.nextShelfY += height;
+		best = &page.shelves.back();
+	}
+
+	area = SDL_Rect{best->x, best->y, width, height};
+	best->x += width;
+	return true;
+}
+
+/*!
+ * @param	image		Glyph image (any pixel format)
+ * @returns				Area holding the glyph image
+ * @throws	Exception	Image does not fit in a page, every page is pinned,
+ *						or SDL call error
+ */
+GlyphAtlas::Region GlyphAtlas::insert(SDL_Surface * image)
+{
+	// Check input parameters
+	if (image == nullptr)
+		THROW(Exception, "Received nullptr 'image'");
+
+	int const width(image->w + GLYPH_ATLAS_PADDING);
+	int const height(image->h + GLYPH_ATLAS_PADDING);
+	if (width > _pageSize || height > _pageSize)
+		THROW(Exception,
+			"Glyph %dx%d does not fit in %dx%d atlas pages",
+			image->w,
+			image->h,
+			_pageSize,
+			_pageSize);
+
+	// Try existing pages, then a new page, then evict the least recently used
+	SDL_Rect area{0, 0, 0, 0};
+	std::size_t index(0);
+	while (index < _pages.size() &&
+		!allocateInPage(_pages[index], width, height, area))
+		++index;
+
+	if (index == _pages.size())
+	{
+		if (_pages.size() < _maxPages)
+			addPage();
+		else
+		{
+			std::size_t victim(_pages.size());
+			for (std::size_t candidate(0) ; candidate < _pages.size() ; ++candidate)
+				if (!_pages[candidate].pinned &&
+					(victim == _pages.size() ||
+					_pages[candidate].lastUse < _pages[victim].lastUse))
+					victim = candidate;
+			if (victim == _pages.size())
+				THROW(Exception, "Glyph atlas is full (every page is pinned)");
+
+			DEBUG(SDL_LOG_CATEGORY_RENDER,
+				"Evict glyph atlas %p page %u",
+				this,
+				(unsigned int)victim);
+			clearPage(_pages[victim]);
+			index = victim;
+		}
+		allocateInPage(_pages[index], width, height, area);
+	}
+
+	Page & page(_pages[index]);
+	page.lastUse = ++_useStamp;
+
+	// Upload glyph pixels (padding stays transparent)
+	SDL_Surface * converted(image->format->format == SDL_PIXELFORMAT_RGBA32 ?
+		image :
+		SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0));
+	if (converted == nullptr)
+		THROW(Exception,
+			"Cannot convert glyph image : SDL error '%s'",
+			SDL_GetError());
+
+	void const * source(converted->pixels);
+	int pitch(converted->pitch);
+	if (_premultiplyPixels)
+	{
+		_uploadBuffer.resize((std::size_t)image->w * image->h * 4);
+		if (SDL_PremultiplyAlpha(image->w, image->h,
+			SDL_PIXELFORMAT_RGBA32, converted->pixels, converted->pitch,
+			SDL_PIXELFORMAT_RGBA32, _uploadBuffer.data(), image->w * 4))
+		{
+			if (converted != image)
+				SDL_FreeSurface(converted);
+			THROW(Exception,
+				"Cannot premultiply glyph image : SDL error '%s'",
+				SDL_GetError());
+		}
+		source = _uploadBuffer.data();
+		pitch = image->w * 4;
+	}
+
+	SDL_Rect const pixels{area.x, area.y, image->w, image->h};
+	int const status(SDL_UpdateTexture(page.texture.getSDLTexture(),
+		&pixels,
+		source,
+		pitch));
+	if (converted != image)
+		SDL_FreeSurface(converted);
+	if (status)
+		THROW(Exception,
+			"Cannot upload glyph image : SDL error '%s'",
+			SDL_GetError());
+
+	return Region{(Uint16)index, page.generation, pixels};
+}
+
+/*!
+ * @param	region	Area returned by insert()
+ * @returns			Whether the area was not evicted since
+ */
+bool GlyphAtlas::isValid(Region const & region) const
+{
+	return (region.page < _pages.size() &&
+		_pages[region.page].generation == region.generation);
+}
+
+void GlyphAtlas::touch(Uint16 const page)
+{
+	_pages[page].lastUse = ++_useStamp;
+}
+
+/*!
+ * Pinned pages are never cleared : pin pages holding glyphs which must stay
+ * resident. One page (created or not) always stays evictable for the other
+ * glyphs : no page is pinned if 'pages' would take the last one.
+ *
+ * @param	pages		Indices of the pages to pin
+ * @throws	Exception	Invalid input parameters, or no evictable page would
+ *						be left
+ */
+void GlyphAtlas::pinPages(std::vector<Uint16> const & pages)
+{
+	std::size_t pinned(0);
+	for (Page const & page : _pages)
+		if (page.pinned)
+			++pinned;
+
+	std::vector<Uint16> added;
+	for (Uint16 const page : pages)
+	{
+		if (page >= _pages.size())
+			THROW(Exception, "Received out of range page %u", (unsigned int)page);
+		if (!_pages[page].pinned &&
+			std::find(added.begin(), added.end(), page) == added.end())
+			added.push_back(page);
+	}
+	if (pinned + added.size() >= _maxPages)
+		THROW(Exception,
+			"Cannot pin %u glyph atlas pages : %u of %u pages already pinned",
+			(unsigned int)added.size(),
+			(unsigned int)pinned,
+			(unsigned int)_maxPages);
+
+	for (Uint16 const page : added)
+		_pages[page].pinned = true;
+}
+
+/*!
+ * Premultiplied atlases premultiply 'color' as well, so that alpha modulation
+ * keeps working.
+ *
+ * @param	region		Glyph area to draw
+ * @param	destination	Destination quad in the rendering space
+ * @param	color		Color & alpha modulation
+ */
+void GlyphAtlas::addQuad(
+	Region const & region,
+	SDL_FRect const & destination,
+	SDL_Color const & color)
+{
+	Page & page(_pages[region.page]);
+
+	SDL_Color vertexColor(color);
+	if (_premultiplyPixels)
+	{
+		vertexColor.r = (Uint8)(color.r * color.a / 255);
+		vertexColor.g = (Uint8)(color.g * color.a / 255);
+		vertexColor.b = (Uint8)(color.b * color.a / 255);
+	}
+
+	float const size(_pageSize);
+	float const left(destination.x), top(destination.y);
+	float const right(left + destination.w), bottom(top + destination.h);
+	float const u0(region.area.x / size), v0(region.area.y / size);
+	float const u1((region.area.x + region.area.w) / size);
+	float const v1((region.area.y + region.area.h) / size);
+
+	int const first((int)page.vertices.size());
+	page.vertices.push_back(SDL_Vertex{{left, top}, vertexColor, {u0, v0}});
+	page.vertices.push_back(SDL_Vertex{{right, top}, vertexColor, {u1, v0}});
+	page.vertices.push_back(SDL_Vertex{{right, bottom}, vertexColor, {u1, v1}});
+	page.vertices.push_back(SDL_Vertex{{left, bottom}, vertexColor, {u0, v1}});
+
+	int const indices[6] = {
+		first, first + 1, first + 2,
+		first, first + 2, first + 3};
+	page.indices.insert(page.indices.end(), indices, indices + 6);
+}
+
+/*!
+ * @returns	Draw calls issued & pages they read from
+ */
+GlyphAtlas::FlushStats GlyphAtlas::flush(void)
+{
+	FlushStats stats{0, 0, nullptr, nullptr};
+	for (Page & page : _pages)
+	{
+		if (page.vertices.empty())
+			continue;
+
+		if (SDL_RenderGeometry(_sdlRenderer,
+			page.texture.getSDLTexture(),
+			page.vertices.data(),
+			(int)page.vertices.size(),
+			page.indices.data(),
+			(int)page.indices.size()))
+			ERROR(SDL_LOG_CATEGORY_ERROR,
+				"Cannot render glyphs : SDL error '%s'",
+				SDL_GetError());
+
+		++stats.drawCalls;
+		stats.quads += (Uint32)page.vertices.size() / 4;
+		if (stats.firstTexture == nullptr)
+			stats.firstTexture = page.texture.getSDLTexture();
+		stats.lastTexture = page.texture.getSDLTexture();
+
+		// Keep storage for next batch
+		page.vertices.clear();
+		page.indices.clear();
+	}
+
+	return stats;
+}
+
+bool GlyphAtlas::hasQueuedQuads(void) const
+{
+	for (Page const & page : _pages)
+		if (!page.vertices.empty())
+			return true;
+
+	return false;
+}
+
+std::size_t GlyphAtlas::getPageCount(void) const
+{
+	return _pages.size();
+}
+
+/*!
+ * @param	index	Page index
+ * @returns			Raw pointer to the page Texture
+ * @throws	Exception	Invalid input parameters
+ */
+Texture * GlyphAtlas::getPage(std::size_t const index)
+{
+	// Check input parameters
+	if (index >= _pages.size())
+		THROW(Exception, "Received out of range 'index' %u", (unsigned int)index);
+
+	return &_pages[index].texture;
+}
+
+int GlyphAtlas::getPageSize(void) const
+{
+	return _pageSize;
+}
+
+bool GlyphAtlas::isPremultiplied(void) const
+{
+	return _premultiplied;
+}
+
+/*!
+ * Used area sums the filled part of each shelf, over the whole shelf height :
+ * only space right of the last glyph of a shelf, and below the last shelf,
+ * counts as free.
+ *
+ * @returns	Page count & allocated area
+ */
+GlyphAtlas::Occupancy GlyphAtlas::getOccupancy(void) const
+{
+	Occupancy occupancy{
+		_pages.size(),
+		_maxPages,
+		0,
+		0,
+		_pages.size() * _pageSize * _pageSize};
+	for (Page const & page : _pages)
+	{
+		if (page.pinned)
+			++occupancy.pinnedPageCount;
+		for (Shelf const & shelf : page.shelves)
+			occupancy.usedArea += (std::size_t)shelf.x * shelf.height;
+	}
+
+	return occupancy;
+}
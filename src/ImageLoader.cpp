@@ -0,0 +1,142 @@
+#include <VBN/ImageLoader.hpp>
+#include <VBN/Logging.hpp>
+#include <VBN/Exceptions.hpp>
+
+/*!
+ * @param	threadCount		Number of worker threads to start
+ * @throws	Exception		Invalid input parameters
+ */
+ImageLoader::ImageLoader(unsigned int const threadCount) :
+	_running(0),
+	_stopping(false)
+{
+	// Check input parameters
+	if (threadCount == 0)
+		THROW(Exception, "Received 'threadCount' == 0");
+
+	for (unsigned int index(0) ; index < threadCount ; ++index)
+		_workers.emplace_back(&ImageLoader::work, this);
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Build ImageLoader %p (%u threads)",
+		this,
+		threadCount);
+}
+
+/*!
+ * Jobs which are not decoded yet are dropped : their futures report a broken
+ * promise.
+ */
+ImageLoader::~ImageLoader(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+		_pending.clear();
+	}
+	_condition.notify_all();
+
+	for (std::thread & worker : _workers)
+		worker.join();
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Delete ImageLoader %p",
+		this);
+}
+
+void ImageLoader::work(void)
+{
+	for (;;)
+	{
+		Job job;
+
+		// Wait for a job
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, [this] {
+				return (_stopping || !_pending.empty());
+			});
+			if (_stopping)
+				return;
+
+			job = std::move(_pending.front());
+			_pending.pop_front();
+			++_running;
+		}
+
+		// Decode & convert outside of the lock
+		try
+		{
+			Surface image(Surface::fromImage(job.path));
+			job.surface = std::unique_ptr<Surface>(
+				new Surface(image.convert(job.format)));
+		}
+		catch (...)
+		{
+			job.error = std::current_exception();
+		}
+
+		// Hand over to the main thread
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_done.push_back(std::move(job));
+			--_running;
+		}
+	}
+}
+
+/*!
+ * @param	name	Name of the Texture to build
+ * @param	path	Path to image file
+ * @param	format	Pixel format to convert the image to
+ * @returns			A future holding the uploaded Texture once collected jobs
+ *					are processed
+ * @throws	Exception	Invalid input parameters
+ */
+std::shared_future<Texture *> ImageLoader::load(
+	std::string const & name,
+	std::string const & path,
+	Uint32 const format)
+{
+	// Check input parameters
+	if (path.empty())
+		THROW(Exception, "Received empty 'path'");
+
+	Job job;
+	job.name = name;
+	job.path = path;
+	job.format = format;
+	std::shared_future<Texture *> future(job.promise.get_future().share());
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_pending.push_back(std::move(job));
+	}
+	_condition.notify_one();
+
+	return future;
+}
+
+/*!
+ * @param	count	Maximum number of jobs to take
+ * @returns			Decoded (or failed) jobs, oldest first
+ */
+std::vector<ImageLoader::Job> ImageLoader::collect(std::size_t const count)
+{
+	std::vector<Job> jobs;
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	while (!_done.empty() && jobs.size() < count)
+	{
+		jobs.push_back(std::move(_done.front()));
+		_done.pop_front();
+	}
+
+	return jobs;
+}
+
+std::size_t ImageLoader::getBacklog(void)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return (_pending.size() + _running + _done.size());
+}
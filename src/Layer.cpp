@@ -0,0 +1,121 @@
+#include <VBN/Layer.hpp>
+#include <VBN/Logging.hpp>
+#include <VBN/Exceptions.hpp>
+
+/*!
+ * @param	renderer	Raw pointer to the SDL_Renderer to use
+ * @param	width		Layer width
+ * @param	height		Layer height
+ * @param	painter		Callback issuing the Layer's draw calls
+ * @throws	Exception	Invalid input parameters or SDL call error
+ */
+Layer::Layer(
+	SDL_Renderer * renderer,
+	int const width,
+	int const height,
+	Painter const & painter) :
+	_texture(Texture::fromScratch(
+		renderer,
+		SDL_PIXELFORMAT_RGBA32,
+		SDL_TEXTUREACCESS_TARGET,
+		width,
+		height)),
+	_painter(painter),
+	_dirty(true),
+	_revision(0)
+{
+	// Check input parameters
+	if (!painter)
+		THROW(Exception, "Received empty 'painter'");
+
+	// Painting with SDL_BLENDMODE_BLEND into a transparent target leaves
+	// premultiplied colors : composite them as such, or a translucent pixel
+	// would be darkened twice by its alpha. Fall back to straight alpha if
+	// the renderer rejects the custom blending mode.
+	if (SDL_SetTextureBlendMode(_texture.getSDLTexture(),
+		SDL_ComposeCustomBlendMode(
+			SDL_BLENDFACTOR_ONE,
+			SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+			SDL_BLENDOPERATION_ADD,
+			SDL_BLENDFACTOR_ONE,
+			SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+			SDL_BLENDOPERATION_ADD)))
+	{
+		WARNING(SDL_LOG_CATEGORY_RENDER,
+			"Premultiplied blending unsupported : SDL error '%s', "
+				"translucent Layer pixels will be darkened",
+			SDL_GetError());
+		_texture.setBlendMode(SDL_BLENDMODE_BLEND);
+	}
+
+	// Log
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Build Layer %p (%dx%d)",
+		this,
+		width,
+		height);
+}
+
+Layer::Layer(Layer && other) :
+	_texture(std::move(other._texture)),
+	_painter(std::move(other._painter)),
+	_dirty(std::move(other._dirty)),
+	_revision(std::move(other._revision))
+{
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Move Layer %p into new Layer %p",
+		&other,
+		this);
+}
+
+Layer::~Layer(void)
+{
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Delete Layer %p",
+		this);
+}
+
+void Layer::invalidate(void)
+{
+	_dirty = true;
+}
+
+void Layer::validate(void)
+{
+	_dirty = false;
+	++_revision;
+}
+
+bool Layer::isDirty(void) const
+{
+	return _dirty;
+}
+
+Texture & Layer::getTexture(void)
+{
+	return _texture;
+}
+
+Uint32 Layer::getRevision(void) const
+{
+	return _revision;
+}
+
+Layer::Painter const & Layer::getPainter(void) const
+{
+	return _painter;
+}
+
+/*!
+ * @param	painter		New callback issuing the Layer's draw calls
+ * @throws	Exception	Invalid input parameters
+ */
+void Layer::setPainter(Painter const & painter)
+{
+	// Check input parameters
+	if (!painter)
+		THROW(Exception, "Received empty 'painter'");
+
+	_painter = painter;
+	_dirty = true;
+}
@@ -1,9 +1,11 @@
 #include <VBN/Logging.hpp>
 #include <iostream>
 #include <sstream>
+#include <mutex>
 
 unsigned int Logger::_maxBufferLines = 24;
 std::deque<std::string> VBN_LogBuffer;
+std::mutex VBN_LogMutex;
 
 void Logger::log(SDL_LogPriority priority, int category, char const * format, ...)
 {
@@ -13,6 +15,7 @@ void Logger::log(SDL_LogPriority priority, int category, char const * format, ..
 	char buffer[SDL_MAX_LOG_MESSAGE] = "";
 	vsnprintf(buffer, SDL_MAX_LOG_MESSAGE - 1, format, ap);
 
+	std::lock_guard<std::mutex> lock(VBN_LogMutex);
 	VBN_LogBuffer.push_front(buffer);
 	while (VBN_LogBuffer.size() > _maxBufferLines)
 		VBN_LogBuffer.pop_back();
@@ -23,6 +26,7 @@ void Logger::log(SDL_LogPriority priority, int category, char const * format, ..
 std::string Logger::lastLogs(void)
 {
 	std::ostringstream s;
+	std::lock_guard<std::mutex> lock(VBN_LogMutex);
 
 	std::deque<std::string>::reverse_iterator line;
 	for (line = VBN_LogBuffer.rbegin() ; line != VBN_LogBuffer.rend() ; ++line)
@@ -0,0 +1,215 @@
+#include <VBN/PrimitiveBatch.hpp>
+#include <VBN/Logging.hpp>
+#include <cmath>
+
+PrimitiveBatch::PrimitiveBatch(void)
+{
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Build PrimitiveBatch %p",
+		this);
+}
+
+PrimitiveBatch::PrimitiveBatch(PrimitiveBatch && other) :
+	_vertices(std::move(other._vertices)),
+	_indices(std::move(other._indices))
+{
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Move PrimitiveBatch %p into new PrimitiveBatch %p",
+		&other,
+		this);
+}
+
+PrimitiveBatch::~PrimitiveBatch(void)
+{
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Delete PrimitiveBatch %p",
+		this);
+}
+
+void PrimitiveBatch::clear(void)
+{
+	_vertices.clear();
+	_indices.clear();
+}
+
+bool PrimitiveBatch::isEmpty(void) const
+{
+	return _indices.empty();
+}
+
+/*!
+ * @param	a		First corner
+ * @param	b		Second corner
+ * @param	c		Third corner (opposite to a)
+ * @param	d		Fourth corner (opposite to b)
+ * @param	color	Quad color
+ */
+void PrimitiveBatch::addQuad(
+	SDL_FPoint const & a,
+	SDL_FPoint const & b,
+	SDL_FPoint const & c,
+	SDL_FPoint const & d,
+	SDL_Color const & color)
+{
+	int const first((int)_vertices.size());
+
+	_vertices.push_back(SDL_Vertex{a, color, SDL_FPoint{0.f, 0.f}});
+	_vertices.push_back(SDL_Vertex{b, color, SDL_FPoint{0.f, 0.f}});
+	_vertices.push_back(SDL_Vertex{c, color, SDL_FPoint{0.f, 0.f}});
+	_vertices.push_back(SDL_Vertex{d, color, SDL_FPoint{0.f, 0.f}});
+
+	_indices.push_back(first);
+	_indices.push_back(first + 1);
+	_indices.push_back(first + 2);
+	_indices.push_back(first);
+	_indices.push_back(first + 2);
+	_indices.push_back(first + 3);
+}
+
+/*!
+ * @param	x		X coordinate
+ * @param	y		Y coordinate
+ * @param	color	Point color
+ */
+void PrimitiveBatch::addPoint(int const x, int const y, SDL_Color const & color)
+{
+	addFilledRect(SDL_Rect{x, y, 1, 1}, color);
+}
+
+/*!
+ * The line is converted into a quad centered on the pixel centers of its end
+ * points, extended by half a pixel at both ends so that they are covered.
+ *
+ * @param	x1			Start X coordinate
+ * @param	y1			Start Y coordinate
+ * @param	x2			End X coordinate
+ * @param	y2			End Y coordinate
+ * @param	color		Line color
+ * @param	thickness	Line thickness in pixels
+ */
+void PrimitiveBatch::addLine(
+	int const x1,
+	int const y1,
+	int const x2,
+	int const y2,
+	SDL_Color const & color,
+	float const thickness)
+{
+	float const dx((float)(x2 - x1)), dy((float)(y2 - y1));
+	float const length(std::sqrt(dx * dx + dy * dy));
+
+	// Degenerate line : single point
+	if (length == 0.f)
+	{
+		addPoint(x1, y1, color);
+		return;
+	}
+
+	// Unit direction & half-thickness normal
+	float const ux(dx / length), uy(dy / length);
+	float const nx(-uy * thickness * .5f), ny(ux * thickness * .5f);
+
+	// Pixel-centered end points, extended by half a pixel
+	float const ax((float)x1 + .5f - ux * .5f), ay((float)y1 + .5f - uy * .5f);
+	float const bx((float)x2 + .5f + ux * .5f), by((float)y2 + .5f + uy * .5f);
+
+	addQuad(
+		SDL_FPoint{ax + nx, ay + ny},
+		SDL_FPoint{bx + nx, by + ny},
+		SDL_FPoint{bx - nx, by - ny},
+		SDL_FPoint{ax - nx, ay - ny},
+		color);
+}
+
+/*!
+ * @param	rectangle	Rectangle to outline
+ * @param	color		Outline color
+ */
+void PrimitiveBatch::addRect(SDL_Rect const & rectangle, SDL_Color const & color)
+{
+	if (rectangle.w <= 0 || rectangle.h <= 0)
+		return;
+
+	// Top & bottom edges, then left & right edges without the corners
+	addFilledRect(SDL_Rect{rectangle.x, rectangle.y, rectangle.w, 1}, color);
+	if (rectangle.h > 1)
+		addFilledRect(SDL_Rect{
+				rectangle.x,
+				rectangle.y + rectangle.h - 1,
+				rectangle.w,
+				1},
+			color);
+	if (rectangle.h > 2)
+	{
+		addFilledRect(SDL_Rect{
+				rectangle.x,
+				rectangle.y + 1,
+				1,
+				rectangle.h - 2},
+			color);
+		if (rectangle.w > 1)
+			addFilledRect(SDL_Rect{
+					rectangle.x + rectangle.w - 1,
+					rectangle.y + 1,
+					1,
+					rectangle.h - 2},
+				color);
+	}
+}
+
+/*!
+ * @param	rectangle	Rectangle to fill
+ * @param	color		Fill color
+ */
+void PrimitiveBatch::addFilledRect(
+	SDL_Rect const & rectangle,
+	SDL_Color const & color)
+{
+	if (rectangle.w <= 0 || rectangle.h <= 0)
+		return;
+
+	float const left((float)rectangle.x);
+	float const top((float)rectangle.y);
+	float const right((float)(rectangle.x + rectangle.w));
+	float const bottom((float)(rectangle.y + rectangle.h));
+
+	addQuad(
+		SDL_FPoint{left, top},
+		SDL_FPoint{right, top},
+		SDL_FPoint{right, bottom},
+		SDL_FPoint{left, bottom},
+		color);
+}
+
+/*!
+ * @param	a		First corner
+ * @param	b		Second corner
+ * @param	c		Third corner
+ * @param	color	Triangle color
+ */
+void PrimitiveBatch::addTriangle(
+	SDL_FPoint const & a,
+	SDL_FPoint const & b,
+	SDL_FPoint const & c,
+	SDL_Color const & color)
+{
+	int const first((int)_vertices.size());
+
+	_vertices.push_back(SDL_Vertex{a, color, SDL_FPoint{0.f, 0.f}});
+	_vertices.push_back(SDL_Vertex{b, color, SDL_FPoint{0.f, 0.f}});
+	_vertices.push_back(SDL_Vertex{c, color, SDL_FPoint{0.f, 0.f}});
+
+	_indices.push_back(first);
+	_indices.push_back(first + 1);
+	_indices.push_back(first + 2);
+}
+
+std::vector<SDL_Vertex> const & PrimitiveBatch::getVertices(void) const
+{
+	return _vertices;
+}
+
+std::vector<int> const & PrimitiveBatch::getIndices(void) const
+{
+	return _indices;
+}
@@ -0,0 +1,309 @@
+#include <VBN/RenderCommand.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace
+{
+	double const PI(3.14159265358979323846);
+
+	bool operator == (SDL_Rect const & a, SDL_Rect const & b)
+	{
+		return (a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h);
+	}
+
+	bool operator == (SDL_Point const & a, SDL_Point const & b)
+	{
+		return (a.x == b.x && a.y == b.y);
+	}
+
+	bool operator == (SDL_Color const & a, SDL_Color const & b)
+	{
+		return (a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a);
+	}
+
+	bool operator == (SDL_FPoint const & a, SDL_FPoint const & b)
+	{
+		return (a.x == b.x && a.y == b.y);
+	}
+
+	bool operator == (SDL_Vertex const & a, SDL_Vertex const & b)
+	{
+		return (a.position == b.position
+			&& a.color == b.color
+			&& a.tex_coord == b.tex_coord);
+	}
+
+	template <typename T>
+	bool operator == (std::vector<T> const & a, std::vector<T> const & b)
+	{
+		if (a.size() != b.size())
+			return false;
+
+		for (std::size_t index(0) ; index < a.size() ; ++index)
+			if (!(a[index] == b[index]))
+				return false;
+
+		return true;
+	}
+
+	//! Mix a value into a FNV-1a style hash
+	void combine(std::size_t & hash, std::size_t const value)
+	{
+		hash = (hash ^ value) * (std::size_t)1099511628211ull;
+	}
+
+	std::size_t hashColor(SDL_Color const & color)
+	{
+		return ((std::size_t)color.r << 24 | (std::size_t)color.g << 16
+			| (std::size_t)color.b << 8 | (std::size_t)color.a);
+	}
+
+	std::size_t hashRect(SDL_Rect const & rect)
+	{
+		std::size_t hash((std::size_t)14695981039346656037ull);
+		combine(hash, (std::size_t)(unsigned)rect.x);
+		combine(hash, (std::size_t)(unsigned)rect.y);
+		combine(hash, (std::size_t)(unsigned)rect.w);
+		combine(hash, (std::size_t)(unsigned)rect.h);
+		return hash;
+	}
+
+	//! Extend [minX;maxX] x [minY;maxY] to include a point
+	void include(
+		float const x, float const y,
+		float & minX, float & minY,
+		float & maxX, float & maxY,
+		bool & empty)
+	{
+		if (empty || x < minX) minX = x;
+		if (empty || y < minY) minY = y;
+		if (empty || x > maxX) maxX = x;
+		if (empty || y > maxY) maxY = y;
+		empty = false;
+	}
+}
+
+/*!
+ * @param	type	Kind of draw call
+ */
+RenderCommand::RenderCommand(Type const type) :
+	type(type),
+	color{0, 0, 0, 0},
+	blendMode(SDL_BLENDMODE_NONE),
+	texture(nullptr),
+	revision(0),
+	modulation{255, 255, 255, 255},
+	source{0, 0, 0, 0},
+	destination{0, 0, 0, 0},
+	start{0, 0},
+	end{0, 0},
+	angle(0.),
+	center{0, 0},
+	flip(SDL_FLIP_NONE),
+	scale{1.f, 1.f},
+	font(nullptr),
+	bounds{0, 0, 0, 0}
+{
+}
+
+/*!
+ * Extended copies are bounded by their rotated destination rectangle, lines by
+ * the rectangle enclosing both end points ; whole-canvas commands (CLEAR, FILL)
+ * are bounded by the canvas itself.
+ *
+ * @param	canvas	Rectangle covering the whole rendering space
+ * @returns			Rectangle enclosing every pixel the draw call may touch
+ */
+SDL_Rect RenderCommand::computeBounds(SDL_Rect const & canvas) const
+{
+	switch (type)
+	{
+		case CLEAR:
+		case FILL:
+			return canvas;
+
+		case DRAW_LINE:
+			return SDL_Rect{
+				std::min(start.x, end.x),
+				std::min(start.y, end.y),
+				std::abs(end.x - start.x) + 1,
+				std::abs(end.y - start.y) + 1};
+
+		case DRAW_POINTS:
+		case DRAW_LINES:
+		case DRAW_RECTS:
+		case FILL_RECTS:
+		case GEOMETRY:
+		{
+			float minX(0.f), minY(0.f), maxX(0.f), maxY(0.f);
+			bool empty(true);
+
+			// Points & rectangles cover whole pixels
+			for (SDL_Point const & point : points)
+				include((float)point.x, (float)point.y,
+					minX, minY, maxX, maxY, empty);
+			for (SDL_Rect const & rect : rects)
+			{
+				include((float)rect.x, (float)rect.y,
+					minX, minY, maxX, maxY, empty);
+				include((float)(rect.x + rect.w - 1),
+					(float)(rect.y + rect.h - 1),
+					minX, minY, maxX, maxY, empty);
+			}
+			for (SDL_Vertex const & vertex : vertices)
+				include(vertex.position.x, vertex.position.y,
+					minX, minY, maxX, maxY, empty);
+
+			if (empty)
+				return SDL_Rect{0, 0, 0, 0};
+
+			int const left((int)std::floor(minX));
+			int const top((int)std::floor(minY));
+			return SDL_Rect{
+				left,
+				top,
+				(int)std::floor(maxX) - left + 1,
+				(int)std::floor(maxY) - top + 1};
+		}
+
+		case COPY_EX:
+		{
+			// Rotate destination corners around the rotation center
+			double const radians(angle * PI / 180.);
+			double const cosine(std::cos(radians)), sine(std::sin(radians));
+			double const cornersX[4] = {
+				- (double)center.x,
+				(double)(destination.w - center.x),
+				(double)(destination.w - center.x),
+				- (double)center.x};
+			double const cornersY[4] = {
+				- (double)center.y,
+				- (double)center.y,
+				(double)(destination.h - center.y),
+				(double)(destination.h - center.y)};
+
+			double minX(0.), minY(0.), maxX(0.), maxY(0.);
+			for (int corner(0) ; corner < 4 ; ++corner)
+			{
+				double const x(cornersX[corner] * cosine
+					- cornersY[corner] * sine);
+				double const y(cornersX[corner] * sine
+					+ cornersY[corner] * cosine);
+
+				if (corner == 0 || x < minX) minX = x;
+				if (corner == 0 || x > maxX) maxX = x;
+				if (corner == 0 || y < minY) minY = y;
+				if (corner == 0 || y > maxY) maxY = y;
+			}
+
+			int const originX(destination.x + center.x);
+			int const originY(destination.y + center.y);
+			int const left(originX + (int)std::floor(minX));
+			int const top(originY + (int)std::floor(minY));
+
+			return SDL_Rect{
+				left,
+				top,
+				originX + (int)std::ceil(maxX) - left,
+				originY + (int)std::ceil(maxY) - top};
+		}
+
+		default:
+			return destination;
+	}
+}
+
+/*!
+ * The derived 'bounds' field and tasks are not compared (tasks are only
+ * recorded in render thread mode).
+ *
+ * @param	other	Command to compare with
+ * @returns			true if both commands draw the same pixels
+ */
+bool RenderCommand::operator == (RenderCommand const & other) const
+{
+	return (type == other.type
+		&& color == other.color
+		&& blendMode == other.blendMode
+		&& texture == other.texture
+		&& revision == other.revision
+		&& modulation == other.modulation
+		&& source == other.source
+		&& destination == other.destination
+		&& start == other.start
+		&& end == other.end
+		&& angle == other.angle
+		&& center == other.center
+		&& flip == other.flip
+		&& scale == other.scale
+		&& font == other.font
+		&& text == other.text
+		&& layout == other.layout
+		&& points == other.points
+		&& rects == other.rects
+		&& vertices == other.vertices
+		&& indices == other.indices);
+}
+
+/*!
+ * Batch contents (points, rectangles, vertices, indices) only contribute their
+ * size : commands sharing a hash still have to be compared with operator ==.
+ *
+ * @returns		Hash of the command contents, equal for equal commands
+ */
+std::size_t RenderCommand::hash(void) const
+{
+	std::size_t result((std::size_t)14695981039346656037ull);
+
+	combine(result, (std::size_t)type);
+	combine(result, hashColor(color));
+	combine(result, (std::size_t)blendMode);
+	combine(result, (std::size_t)texture);
+	combine(result, (std::size_t)revision);
+	combine(result, hashColor(modulation));
+	combine(result, hashRect(source));
+	combine(result, hashRect(destination));
+	combine(result, hashRect(SDL_Rect{start.x, start.y, end.x, end.y}));
+	combine(result, std::hash<double>()(angle));
+	combine(result, hashRect(SDL_Rect{center.x, center.y, flip, 0}));
+	combine(result, std::hash<float>()(scale.x));
+	combine(result, std::hash<float>()(scale.y));
+	combine(result, (std::size_t)font);
+	combine(result, std::hash<std::string>()(text));
+	combine(result, (std::size_t)layout.get());
+	combine(result, points.size());
+	combine(result, rects.size());
+	combine(result, vertices.size());
+	combine(result, indices.size());
+
+	return result;
+}
+
+bool RenderCommand::operator != (RenderCommand const & other) const
+{
+	return !(*this == other);
+}
+
+/*!
+ * @returns		Whether the command changes renderer state instead of drawing
+ */
+bool RenderCommand::isStateChange(void) const
+{
+	return (type == SET_LOGICAL_SIZE ||
+		type == SET_VIEWPORT ||
+		type == RESET_VIEWPORT ||
+		type == SET_SCALE);
+}
+
+/*!
+ * State changes & tasks have lasting effects (renderer state, uploaded or
+ * repainted textures) that later frames rely on.
+ *
+ * @returns		Whether the command must be executed even if the frame which
+ *				recorded it is replaced before being executed
+ */
+bool RenderCommand::isPersistent(void) const
+{
+	return (isStateChange() || type == TASK);
+}
@@ -3,6 +3,98 @@
 #include <VBN/Logging.hpp>
 #include <VBN/Exceptions.hpp>
 #include <VBN/Introspection.hpp>
+#include <SDL2/SDL_timer.h>
+#include <algorithm>
+#include <climits>
+#include <iterator>
+
+#define MAX_DAMAGE_REGIONS 32
+#define MAX_LOADER_THREADS 4
+#define MAX_PENDING_CAPTURES 4
+#define TEXT_LAYOUT_IDLE_FRAMES 120
+#define UNBUDGETED_UPLOADS_PER_FRAME 4
+
+namespace
+{
+	//! Visible area meaning "cull nothing"
+	SDL_Rect const UNCULLED_AREA{INT_MIN / 2, INT_MIN / 2, INT_MAX, INT_MAX};
+
+	/*!
+	 * @param	texture				Texture to update
+	 * @param	modulation			Color & alpha modulation to apply
+	 * @param	blendMode			Blending mode to apply
+	 * @param	previousModulation	Replaced color & alpha modulation
+	 * @param	previousBlendMode	Replaced blending mode
+	 * @returns						true if the texture state was changed
+	 */
+	bool swapTextureState(
+		SDL_Texture * texture,
+		SDL_Color const & modulation,
+		SDL_BlendMode const blendMode,
+		SDL_Color & previousModulation,
+		SDL_BlendMode & previousBlendMode)
+	{
+		SDL_GetTextureColorMod(texture,
+			&previousModulation.r,
+			&previousModulation.g,
+			&previousModulation.b);
+		SDL_GetTextureAlphaMod(texture, &previousModulation.a);
+		SDL_GetTextureBlendMode(texture, &previousBlendMode);
+
+		if (previousModulation.r == modulation.r
+			&& previousModulation.g == modulation.g
+			&& previousModulation.b == modulation.b
+			&& previousModulation.a == modulation.a
+			&& previousBlendMode == blendMode)
+			return false;
+
+		SDL_SetTextureColorMod(texture, modulation.r, modulation.g, modulation.b);
+		SDL_SetTextureAlphaMod(texture, modulation.a);
+		SDL_SetTextureBlendMode(texture, blendMode);
+		return true;
+	}
+}
+
+/*!
+ * @param	kind	Kind of source (other fields are left empty)
+ */
+Renderer::TextureSource::TextureSource(Kind const kind) :
+	kind(kind),
+	size(0),
+	color{0, 0, 0, 0},
+	lastUsedFrame(0),
+	pinned(false)
+{
+}
+
+/*!
+ * @param	name	Name of the Texture to build
+ * @param	source	Source to build the Texture from
+ */
+Renderer::PendingUpload::PendingUpload(
+	std::string const & name,
+	TextureSource const & source) :
+	name(name),
+	source(source),
+	surface(nullptr)
+{
+}
+
+/*!
+ * @param	upload	Texture creation to hand over
+ * @param	frame	Frame whose commands hold the creation task
+ */
+Renderer::ThreadedUpload::ThreadedUpload(
+	PendingUpload && upload,
+	Uint32 const frame) :
+	upload(std::move(upload)),
+	texture(nullptr),
+	error(nullptr),
+	ticks(0),
+	frame(frame),
+	dropped(false)
+{
+}
 
 /*!
  * @param	window		Raw pointer to the SDL_Window for which the Renderer is
@@ -21,7 +113,43 @@ Renderer::Renderer(
 	std::shared_ptr<TrueTypeFontManager> ttfManager) :
 	_renderer(nullptr, &SDL_DestroyRenderer),
 	_bitmapFontManager(nullptr),
-	_trueTypeFontManager(ttfManager)
+	_trueTypeFontManager(ttfManager),
+	_drawColor{0, 0, 0, 255},
+	_blendMode(SDL_BLENDMODE_NONE),
+	_layerDepth(0),
+	_cullingStats{0, 0},
+	_lastCullingStats{0, 0},
+	_renderStats{0, 0, 0, 0, 0, 0, 0, 0.0f},
+	_lastRenderStats{0, 0, 0, 0, 0, 0, 0, 0.0f},
+	_renderStartTicks(SDL_GetPerformanceCounter()),
+	_lastTexture(nullptr),
+	_lastBlendMode(SDL_BLENDMODE_NONE),
+	_pendingTextAtlas(nullptr),
+	_textLayoutStamp(0),
+	_frame(0),
+	_textureBytes(0),
+	_textureBudget(0),
+	_textureIdleFrames(1),
+	_imageLoader(nullptr),
+	_uploadFormat(SDL_PIXELFORMAT_ARGB8888),
+	_uploadBudgetBytes(0),
+	_uploadBudgetMicroseconds(0),
+	_uploadBytesSpent(0),
+	_uploadTicksSpent(0),
+	_frameQueued(false),
+	_queuedFrame(0),
+	_renderThreadStopping(false),
+	_completedFrames(0),
+	_droppedFrames(0),
+	_renderThreadViewport{0, 0, 0, 0},
+	_visibleArea{0, 0, 0, 0},
+	_stateChangeFrame(0),
+	_integerScaling(true),
+	_renderScale(1.0f),
+	_scaledTargetDestination{0, 0, 0, 0},
+	_frameCapture(nullptr),
+	_captureInterval(0),
+	_captureFormat(FrameCapture::PNG)
 {
 	// Check input parameters
 	if (!window)
@@ -62,6 +190,8 @@ Renderer::Renderer(
 
 Renderer::~Renderer(void)
 {
+	disableRenderThread();
+
 	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
 		"Delete Renderer %p (SDL_Renderer %p)",
 		this,
@@ -86,7 +216,7 @@ void Renderer::addLatin1TextTexture(
 	SDL_Color const & color)
 {
 	// Check input parameters
-	if(_textures.find(textureName) != _textures.end())
+	if (hasTexture(textureName))
 		THROW(Exception,
 			"Cannot override existing texture '%s'",
 			textureName);
@@ -96,15 +226,12 @@ void Renderer::addLatin1TextTexture(
 		THROW(Exception, "Received 'size' <= 0");
 
 	// Attempt text rendering & storage into the Textures map
-	_textures.emplace(
-		make_pair(textureName,
-			Texture::fromLatin1Text(
-				_trueTypeFontManager,
-				_renderer.get(),
-				text,
-				fontName,
-				size,
-				color)));
+	TextureSource source{TextureSource::LATIN1_TEXT};
+	source.fontName = fontName;
+	source.text = text;
+	source.size = size;
+	source.color = color;
+	storeTexture(textureName, source);
 }
 
 /*!
@@ -125,7 +252,7 @@ void Renderer::addUTF8TextTexture(
 		SDL_Color const & color)
 {
 	// Check input parameters
-	if(_textures.find(textureName) != _textures.end())
+	if (hasTexture(textureName))
 		THROW(Exception,
 			"Cannot override existing texture '%s'",
 			textureName);
@@ -135,15 +262,12 @@ void Renderer::addUTF8TextTexture(
 		THROW(Exception, "Received 'size' <= 0");
 
 	// Attempt text rendering & storage into the Textures map
-	_textures.emplace(
-		make_pair(textureName,
-			Texture::fromUTF8Text(
-				_trueTypeFontManager,
-				_renderer.get(),
-				text,
-				fontName,
-				size,
-				color)));
+	TextureSource source{TextureSource::UTF8_TEXT};
+	source.fontName = fontName;
+	source.text = text;
+	source.size = size;
+	source.color = color;
+	storeTexture(textureName, source);
 }
 
 /*!
@@ -157,240 +281,1588 @@ void Renderer::addImageTexture(
 	std::string const & path)
 {
 	// Check input parameters
-	if (_textures.find(textureName) != _textures.end())
+	if (hasTexture(textureName))
 		THROW(Exception,
 			"Cannot override existing texture '%s'",
 			textureName);
 	if (path.empty())
 		THROW(Exception, "Received empty 'path'");
 
-	// Instantiate Surface from image & convert into Texture (may throw)
-	Surface image(Surface::fromImage(path));
-
-	// Store Texture into internal map
-	_textures.emplace(
-		make_pair(textureName,
-			Texture::fromSurface(_renderer.get(), image)));
+	// Load image into Texture (may throw) & store it into internal map
+	TextureSource source{TextureSource::IMAGE};
+	source.path = path;
+	storeTexture(textureName, source);
 }
 
 /*!
- * @param	name	Name of the Texture to query
- * @returns			The appropriate Texture for the input name, nullptr if not
- *					found
+ * The pack stays mapped for the Renderer's lifetime : each of its images is
+ * stored as a Texture named after the image, uploaded straight from mapped
+ * memory without decoding (and reloaded the same way after eviction). Packs
+ * are built offline with tools/TexturePacker.cpp.
+ *
+ * @param	path		Path to the texture pack file
+ * @throws	Exception	Invalid input parameters, invalid pack or SDL call
+ *						error
  */
-Texture * Renderer::getTexture(std::string const & name)
+void Renderer::addTexturePack(std::string const & path)
 {
-	// Lookup
-	if(_textures.find(name) == _textures.end()) /* Miss */
-		return nullptr;
-	else /* Hit */
-		return (&_textures.at(name));
+	// Check input parameters
+	if (_texturePacks.find(path) != _texturePacks.end())
+		THROW(Exception,
+			"Cannot override existing texture pack '%s'",
+			path.c_str());
+
+	// Map & validate pack (may throw), then check every name before storing
+	// anything
+	TexturePack pack(TexturePack::fromFile(path));
+	for (std::size_t index(0) ; index < pack.getCount() ; ++index)
+		if (hasTexture(pack.getEntry(index).name))
+			THROW(Exception,
+				"Cannot override existing texture '%s'",
+				pack.getEntry(index).name);
+
+	auto packIterator = _texturePacks.emplace(
+		make_pair(path, std::move(pack))).first;
+	TexturePack const & storedPack(packIterator->second);
+
+	// Store every image, or none of them
+	std::size_t stored(0);
+	try
+	{
+		for ( ; stored < storedPack.getCount() ; ++stored)
+		{
+			TextureSource source{TextureSource::PACKED};
+			source.path = path;
+			source.entry = storedPack.getEntry(stored).name;
+			storeTexture(source.entry, source);
+		}
+	}
+	catch (...)
+	{
+		for (std::size_t index(0) ; index < stored ; ++index)
+			forgetTexture(storedPack.getEntry(index).name);
+		_texturePacks.erase(packIterator);
+		throw;
+	}
 }
 
 /*!
- * @param	text		Text to print (Latin1)
- * @param	fontName	Name of the font to use
- * @param	size		Text size
- * @param	color		Text color
- * @param	destination	Destination rectangle (will crop)
- * @throws	Exception	Invalid input parameters or SDL/TTF call error
+ * Decoding and pixel format conversion happen on worker threads ; the decoded
+ * image is then uploaded on the main thread (render thread mode : by the render
+ * thread) by the upload scheduler (see setUploadBudget() ; without budget,
+ * UNBUDGETED_UPLOADS_PER_FRAME images are uploaded per frame). The returned
+ * future holds the stored Texture, or the decoding exception.
  *
- * @todo	Unify API / handle UTF-8 BMF
+ * @param	textureName		Name to give to the newly created Texture in the
+ *							Renderer's internal storage
+ * @param	path			Path to image file
+ * @returns					A future holding the Texture once uploaded
+ * @throws	Exception		Invalid input parameters
  */
-void Renderer::printText(
-	std::string const & text,
-	std::string const & fontName,
-	int const size,
-	SDL_Color const & color,
-	SDL_Rect const & destination)
+std::shared_future<Texture *> Renderer::addImageTextureAsync(
+	std::string const & textureName,
+	std::string const & path)
 {
 	// Check input parameters
-	if (fontName.empty())
-		THROW(Exception, "Received empty 'fontName'");
-	if (size <= 0)
-		THROW(Exception, "Received 'size' <= 0");
+	if (hasTexture(textureName))
+		THROW(Exception,
+			"Cannot override existing texture '%s'",
+			textureName.c_str());
+	if (path.empty())
+		THROW(Exception, "Received empty 'path'");
 
-	// Try retrieving BitmapFont
-	BitmapFont * font(_bitmapFontManager->getFont(fontName, size));
-	if (font) /* Hit */
-		// Render
-		font->renderText(text, color, destination);
-	else /* Miss */
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot print dynamic text : missing font '%s' size '%d'",
-			fontName.c_str(),
-			size);
+	// Start worker threads on first use
+	if (!_imageLoader)
+	{
+		int const cpuCount(SDL_GetCPUCount());
+		_imageLoader = std::unique_ptr<ImageLoader>(new ImageLoader(
+			cpuCount > 2 ?
+				std::min(cpuCount - 1, MAX_LOADER_THREADS) :
+				1));
+
+		// Convert images to a format the renderer accepts without conversion
+		std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+		SDL_RendererInfo info;
+		if (SDL_GetRendererInfo(_renderer.get(), &info) == 0)
+			for (Uint32 index(0) ; index < info.num_texture_formats ; ++index)
+				if (!SDL_ISPIXELFORMAT_FOURCC(info.texture_formats[index]) &&
+					SDL_ISPIXELFORMAT_ALPHA(info.texture_formats[index]))
+				{
+					_uploadFormat = info.texture_formats[index];
+					break;
+				}
+	}
+
+	_loadingTextures.insert(textureName);
+	return _imageLoader->load(textureName, path, _uploadFormat);
 }
 
 /*!
- * @param	fontName		Name of the font to use
- * @param	size			Debug text size
- * @param	xDest			X destination (top left pixel)
- * @param	yDest			Y destination (top left pixel)
- * @throws	Exception		Invalid input parameters or SDL/TTF call error
+ * Texture creations are queued instead of being executed right away as soon
+ * as a budget is set : add...Texture() calls then only validate their
+ * parameters, and errors are logged when the Texture is actually built. At
+ * each present(), queued Texture objects are built & uploaded, oldest first,
+ * until either budget is spent (at least one upload happens per frame).
+ * Texture objects needed for the current frame (copied or queried) are built
+ * on the spot, ahead of the queue, and count against the budget.
+ * Without any budget, Texture creations run right away, and asynchronously
+ * decoded images are still uploaded UNBUDGETED_UPLOADS_PER_FRAME per frame
+ * (loading many images at once then does not hitch a single frame).
+ * In render thread mode, scheduled Texture objects are created by the render
+ * thread along with the next frame, and stored one frame later : the time it
+ * spends counts against the budget of the frame storing them.
  *
- * @todo	Remove, at some point
+ * @param	bytes			Maximum bytes uploaded per frame (0 = unlimited)
+ * @param	microseconds	Maximum time spent uploading per frame
+ *							(0 = unlimited)
  */
-void Renderer::printDebugText(
-	std::string const & fontName,
-	int const size,
-	int const xDest,
-	int const yDest)
+void Renderer::setUploadBudget(
+	std::size_t const bytes,
+	Uint32 const microseconds)
 {
-	BitmapFont * font = _bitmapFontManager->getFont(fontName, size);
-	if (font)
-		font->renderDebug(xDest, yDest);
-	else
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot print debug text : missing font '%s' size '%d'",
-			fontName,
-			size);
+	_uploadBudgetBytes = bytes;
+	_uploadBudgetMicroseconds = microseconds;
 }
 
-/*!
- * @param	red		Red component
- * @param	green	Green component
- * @param	blue	Blue component
- * @param	blue	Alpha component
- */
-void Renderer::setDrawColor(
-	Uint8 const red,
-	Uint8 const green,
-	Uint8 const blue,
-	Uint8 const alpha)
+std::size_t Renderer::getPendingTextureLoads(void) const
 {
-	if (SDL_SetRenderDrawColor(_renderer.get(), red, green, blue, alpha))
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot set renderer draw color : SDL error '%s'",
-			SDL_GetError());
+	return _loadingTextures.size();
 }
 
 /*!
- * @param	color	SDL_Color to use
+ * @param	upload	Pending Texture creation
+ * @returns			The stored Texture, nullptr on failure (the promise then
+ *					holds the exception)
  */
-void Renderer::setDrawColor(SDL_Color const & color)
+Texture * Renderer::performUpload(PendingUpload & upload)
 {
-	if (SDL_SetRenderDrawColor(_renderer.get(),
-		color.r,
-		color.g,
-		color.b,
-		color.a))
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot set renderer draw color : SDL error '%s'",
-			SDL_GetError());
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	Uint64 const start(SDL_GetPerformanceCounter());
+	Texture * texture(nullptr);
+
+	_loadingTextures.erase(upload.name);
+
+	try
+	{
+		auto textureIterator = _textures.emplace(
+			make_pair(upload.name,
+				upload.surface ?
+					Texture::fromSurface(_renderer.get(), *upload.surface) :
+					buildTexture(upload.source))).first;
+		texture = &textureIterator->second;
+
+		// Keep source for reload after eviction
+		auto sourceIterator = _textureSources.emplace(
+			make_pair(upload.name, upload.source)).first;
+		sourceIterator->second.lastUsedFrame = _frame;
+
+		std::size_t const bytes(texture->getSize());
+		_textureBytes += bytes;
+		_uploadBytesSpent += bytes;
+		countUpload(bytes);
+
+		upload.promise.set_value(texture);
+	}
+	catch (Exception const & exc)
+	{
+		EXCEPT(exc);
+		upload.promise.set_exception(std::current_exception());
+	}
+
+	_uploadTicksSpent += SDL_GetPerformanceCounter() - start;
+	return texture;
 }
 
-void Renderer::setBlendMode(SDL_BlendMode const & blendMode)
+/*!
+ * Render thread mode : images are decoded (or texts printed) by the calling
+ * thread, only the Texture creation is left to the render thread. The Texture
+ * is stored by a later processUploads() call (see collectUploads()).
+ *
+ * @param	upload	Pending Texture creation
+ */
+void Renderer::handOverUpload(PendingUpload && upload)
 {
-	if (SDL_SetRenderDrawBlendMode(_renderer.get(), blendMode))
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot set renderer blend mode : SDL eror '%s'",
-			SDL_GetError());
+	Uint64 const start(SDL_GetPerformanceCounter());
+	SDL_Renderer * renderer(_renderer.get());
+
+	// present() already queued this frame's commands : the task belongs to
+	// the next one
+	std::shared_ptr<ThreadedUpload> threaded(
+		new ThreadedUpload(std::move(upload), _frame + 1));
+	PendingUpload & pending(threaded->upload);
+	std::function<Texture(void)> build;
+	try
+	{
+		if (!pending.surface && pending.source.kind == TextureSource::PACKED)
+		{
+			TexturePack const * pack(nullptr);
+			TexturePack::Entry const * entry(
+				&findPackedEntry(pending.source, pack));
+			_uploadBytesSpent += (std::size_t)entry->pitch * entry->height;
+			build = [renderer, pack, entry] (void) {
+				return Texture::fromPixels(
+					renderer,
+					entry->format,
+					entry->width,
+					entry->height,
+					pack->getPixels(*entry),
+					entry->pitch);
+			};
+		}
+		else
+		{
+			if (!pending.surface)
+				pending.surface = std::unique_ptr<Surface>(
+					new Surface(buildSurface(pending.source)));
+			Surface * surface(pending.surface.get());
+			_uploadBytesSpent += (std::size_t)surface->getSurface()->pitch
+				* surface->getSurface()->h;
+			build = [renderer, surface] (void) {
+				return Texture::fromSurface(renderer, *surface);
+			};
+		}
+	}
+	catch (Exception const & exc)
+	{
+		EXCEPT(exc);
+		_loadingTextures.erase(pending.name);
+		pending.promise.set_exception(std::current_exception());
+		return;
+	}
+
+	recordTask([this, threaded, build] (void) {
+		Uint64 const start(SDL_GetPerformanceCounter());
+		try
+		{
+			threaded->texture = std::unique_ptr<Texture>(new Texture(build()));
+			countUpload(threaded->texture->getSize());
+		}
+		catch (Exception const & exc)
+		{
+			EXCEPT(exc);
+			threaded->error = std::current_exception();
+		}
+		threaded->ticks = SDL_GetPerformanceCounter() - start;
+	});
+	_threadedUploads.push_back(threaded);
+	_uploadTicksSpent += SDL_GetPerformanceCounter() - start;
 }
 
-void Renderer::setLogicalSize(int const w, int const h)
+/*!
+ * Stores the Textures created by frames the render thread completed, and
+ * charges their creation time to the current frame's upload budget.
+ */
+void Renderer::collectUploads(void)
 {
-	if (SDL_RenderSetLogicalSize(_renderer.get(), w, h))
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot set renderer logical size : SDL error '%s'",
-			SDL_GetError());
+	Uint32 const completedFrames(getCompletedFrames());
+	while (!_threadedUploads.empty() &&
+		_threadedUploads.front()->frame < completedFrames)
+	{
+		std::shared_ptr<ThreadedUpload> threaded(_threadedUploads.front());
+		_threadedUploads.pop_front();
+		PendingUpload & upload(threaded->upload);
+		_uploadTicksSpent += threaded->ticks;
+
+		// Forgotten meanwhile : only release the Texture
+		if (threaded->dropped)
+		{
+			std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+			threaded->texture.reset();
+			continue;
+		}
+
+		_loadingTextures.erase(upload.name);
+		if (threaded->error)
+		{
+			upload.promise.set_exception(threaded->error);
+			continue;
+		}
+
+		auto textureIterator = _textures.emplace(
+			make_pair(upload.name, std::move(*threaded->texture))).first;
+		Texture * texture(&textureIterator->second);
+
+		// Keep source for reload after eviction
+		auto sourceIterator = _textureSources.emplace(
+			make_pair(upload.name, upload.source)).first;
+		sourceIterator->second.lastUsedFrame = _frame;
+		_textureBytes += texture->getSize();
+
+		upload.promise.set_value(texture);
+	}
 }
 
-void Renderer::setViewport(SDL_Rect const & viewport)
+void Renderer::processUploads(void)
 {
-	if (SDL_RenderSetViewport(_renderer.get(), &viewport))
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot set renderer viewport : SDL error '%s'",
-			SDL_GetError());
+	// Store Textures created by the render thread
+	collectUploads();
+
+	// Queue decoded images (failed ones are reported right away)
+	if (_imageLoader)
+		for (ImageLoader::Job & job : _imageLoader->collect(SIZE_MAX))
+		{
+			if (job.error)
+			{
+				_loadingTextures.erase(job.name);
+				job.promise.set_exception(job.error);
+				continue;
+			}
+
+			PendingUpload upload{job.name, TextureSource{TextureSource::IMAGE}};
+			upload.source.path = job.path;
+			upload.surface = std::move(job.surface);
+			upload.promise = std::move(job.promise);
+			_uploadQueue.push_back(std::move(upload));
+		}
+
+	// Spend what is left of the frame's budget
+	Uint64 const budgetTicks((Uint64)_uploadBudgetMicroseconds
+		* SDL_GetPerformanceFrequency() / 1000000);
+	bool const budgeted(_uploadBudgetBytes != 0 ||
+		_uploadBudgetMicroseconds != 0);
+	std::size_t uploads(0);
+	while (!_uploadQueue.empty())
+	{
+		bool const overBytes(_uploadBudgetBytes != 0 &&
+			_uploadBytesSpent >= _uploadBudgetBytes);
+		bool const overTime(_uploadBudgetMicroseconds != 0 &&
+			_uploadTicksSpent >= budgetTicks);
+		bool const overCount(!budgeted &&
+			uploads >= UNBUDGETED_UPLOADS_PER_FRAME);
+		if (uploads > 0 && (overBytes || overTime || overCount))
+			break;
+
+		PendingUpload upload(std::move(_uploadQueue.front()));
+		_uploadQueue.pop_front();
+		if (_renderThread.joinable())
+			handOverUpload(std::move(upload));
+		else
+			performUpload(upload);
+		++uploads;
+	}
+
+	// Start next frame with a full budget
+	_uploadBytesSpent = 0;
+	_uploadTicksSpent = 0;
 }
 
-void Renderer::resetViewport(void)
+/*!
+ * @param	name	Name of the Texture to query
+ * @returns			The appropriate Texture for the input name, nullptr if not
+ *					found
+ */
+Texture * Renderer::getTexture(std::string const & name)
 {
-	if (SDL_RenderSetViewport(_renderer.get(), nullptr))
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot reset renderer viewport : SDL error '%s'",
-			SDL_GetError());
+	// Lookup (reloads evicted Texture)
+	return useTexture(name);
 }
 
-void Renderer::setScale(float const x, float const y)
+/*!
+ * @param	source		Source to build the Texture from
+ * @returns				A newly created Texture
+ * @throws	Exception	SDL/TTF call error
+ */
+Texture Renderer::buildTexture(TextureSource const & source)
 {
-	if (SDL_RenderSetScale(_renderer.get(), x, y))
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot set renderer scale : SDL error '%s'",
-			SDL_GetError());
+	switch (source.kind)
+	{
+		case TextureSource::LATIN1_TEXT:
+			return Texture::fromLatin1Text(
+				_trueTypeFontManager,
+				_renderer.get(),
+				source.text,
+				source.fontName,
+				source.size,
+				source.color);
+
+		case TextureSource::UTF8_TEXT:
+			return Texture::fromUTF8Text(
+				_trueTypeFontManager,
+				_renderer.get(),
+				source.text,
+				source.fontName,
+				source.size,
+				source.color);
+
+		case TextureSource::PACKED:
+		{
+			TexturePack const * pack(nullptr);
+			TexturePack::Entry const & entry(findPackedEntry(source, pack));
+			return Texture::fromPixels(
+				_renderer.get(),
+				entry.format,
+				entry.width,
+				entry.height,
+				pack->getPixels(entry),
+				entry.pitch);
+		}
+
+		case TextureSource::IMAGE:
+		default:
+		{
+			Surface image(Surface::fromImage(source.path));
+			return Texture::fromSurface(_renderer.get(), image);
+		}
+	}
 }
 
-void Renderer::clear(void)
+/*!
+ * @param	source		Source to build the image from (any but PACKED)
+ * @returns				A newly created Surface holding the image
+ * @throws	Exception	TTF call error or unreadable image
+ */
+Surface Renderer::buildSurface(TextureSource const & source)
 {
-	if(SDL_RenderClear(_renderer.get()))
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot clear renderer : SDL error '%s'",
-			SDL_GetError());
+	switch (source.kind)
+	{
+		case TextureSource::LATIN1_TEXT:
+			return Surface::fromLatin1Text(
+				_trueTypeFontManager,
+				source.text,
+				source.fontName,
+				source.size,
+				source.color);
+
+		case TextureSource::UTF8_TEXT:
+			return Surface::fromUTF8Text(
+				_trueTypeFontManager,
+				source.text,
+				source.fontName,
+				source.size,
+				source.color);
+
+		case TextureSource::IMAGE:
+		default:
+			return Surface::fromImage(source.path);
+	}
 }
 
-void Renderer::fill(void)
+/*!
+ * Stored texture packs are never released : both stay valid for the lifetime
+ * of the Renderer.
+ *
+ * @param	source		PACKED source
+ * @param	pack		Receives the texture pack holding the image
+ * @returns				Texture pack entry describing the image
+ * @throws	Exception	No such image in the texture pack
+ */
+TexturePack::Entry const & Renderer::findPackedEntry(
+	TextureSource const & source,
+	TexturePack const * & pack) const
 {
-	if(SDL_RenderFillRect(_renderer.get(), nullptr))
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot fill renderer canvas : SDL error '%s'",
-			SDL_GetError());
+	pack = &_texturePacks.at(source.path);
+	TexturePack::Entry const * entry(pack->findEntry(source.entry));
+	if (entry == nullptr)
+		THROW(Exception,
+			"No image '%s' in texture pack '%s'",
+			source.entry.c_str(),
+			source.path.c_str());
+
+	return *entry;
 }
 
-void Renderer::fillRect(SDL_Rect const & rectangle)
+/*!
+ * @param	name		Name to give to the Texture in internal storage
+ * @param	source		Source to build the Texture from
+ * @throws	Exception	SDL/TTF call error
+ */
+void Renderer::storeTexture(
+	std::string const & name,
+	TextureSource const & source)
 {
-	if(SDL_RenderFillRect(_renderer.get(), &rectangle))
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot fill rectangle : SDL error '%s'",
-			SDL_GetError());
+	PendingUpload upload{name, source};
+
+	// Defer to the upload scheduler when uploads are budgeted
+	if (_uploadBudgetBytes != 0 || _uploadBudgetMicroseconds != 0)
+	{
+		_loadingTextures.insert(name);
+		_uploadQueue.push_back(std::move(upload));
+		return;
+	}
+
+	// Build right away (rethrow errors to the caller)
+	if (performUpload(upload) == nullptr)
+		upload.promise.get_future().get();
 }
 
-void Renderer::drawRect(SDL_Rect const & rectangle)
+/*!
+ * Used to roll back partially stored batches : the name becomes available
+ * again, whether its Texture was stored, queued or failed to build.
+ *
+ * @param	name	Name of the Texture to drop
+ */
+void Renderer::forgetTexture(std::string const & name)
 {
-	if(SDL_RenderDrawRect(_renderer.get(), &rectangle))
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot draw rectangle : SDL error '%s'",
-			SDL_GetError());
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+
+	auto textureIterator = _textures.find(name);
+	if (textureIterator != _textures.end())
+	{
+		if (textureIterator->second.isLoaded())
+			_textureBytes -= textureIterator->second.getSize();
+		_textures.erase(textureIterator);
+	}
+	_textureSources.erase(name);
+	_loadingTextures.erase(name);
+	_uploadQueue.erase(
+		std::remove_if(
+			_uploadQueue.begin(),
+			_uploadQueue.end(),
+			[&name] (PendingUpload const & upload) {
+				return (upload.name == name);
+			}),
+		_uploadQueue.end());
+	for (auto & threaded : _threadedUploads)
+		if (threaded->upload.name == name)
+			threaded->dropped = true;
 }
 
-void Renderer::drawLine(
-	int const x1,
-	int const y1,
-	int const x2,
-	int const y2)
+/*!
+ * @param	name	Name of the Texture to check
+ * @returns			Whether the name is used by a stored, decoding or queued
+ *					Texture
+ */
+bool Renderer::hasTexture(std::string const & name) const
 {
-	if (SDL_RenderDrawLine(_renderer.get(), x1, y1, x2, y2))
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot draw line : SDL error '%s'",
-			SDL_GetError());
+	return (_textures.find(name) != _textures.end() ||
+		_loadingTextures.find(name) != _loadingTextures.end());
 }
 
 /*!
- * @param	textureName		Name of the Texture to copy on rendering space
- * @param	clipName		Name of the clipping rectangle to use ("" = entire
- *							Texture)
- * @param	destination		Destination rectangle for the rendering
- * @throws	Exception		Invalid input parameters or SDL call error
- *
- * @todo	Add 1:1 version
+ * @param	name	Name of the Texture to use
+ * @returns			The appropriate Texture for the input name, nullptr if not
+ *					found or if reloading failed
  */
-void Renderer::copy(
-	std::string const & textureName,
-	std::string const & clipName,
-	SDL_Rect const & destination)
+Texture * Renderer::useTexture(std::string const & name)
 {
-	// Texture lookup
-	auto textureIterator = _textures.find(textureName);
-	if (textureIterator == _textures.end())
+	// Lookup
+	auto textureIterator = _textures.find(name);
+	if (textureIterator == _textures.end()) /* Miss */
 	{
-		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot copy texture '%s' : not found in _textures",
-			textureName.c_str());
-		return;
+		// Needed for this frame : upload ahead of the queue
+		auto uploadIterator = std::find_if(
+			_uploadQueue.begin(),
+			_uploadQueue.end(),
+			[&name] (PendingUpload const & upload) {
+				return (upload.name == name);
+			});
+		if (uploadIterator == _uploadQueue.end())
+			return nullptr;
+
+		PendingUpload upload(std::move(*uploadIterator));
+		_uploadQueue.erase(uploadIterator);
+		return performUpload(upload);
 	}
 
-	// Clip lookup
-	SDL_Rect * clip = textureIterator->second.getClip(clipName);
-	if (!clip)
+	Texture & texture(textureIterator->second);
+	TextureSource & source(_textureSources.at(name));
+
+	// Transparently reload evicted Texture
+	if (!texture.isLoaded())
+	{
+		std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+		try
+		{
+			texture.reload(buildTexture(source));
+		}
+		catch (Exception const & exc)
+		{
+			EXCEPT(exc);
+			ERROR(SDL_LOG_CATEGORY_ERROR,
+				"Cannot reload evicted texture '%s'",
+				name.c_str());
+			return nullptr;
+		}
+
+		DEBUG(SDL_LOG_CATEGORY_APPLICATION,
+			"Reload evicted texture '%s'",
+			name.c_str());
+
+		_textureBytes += texture.getSize();
+		countUpload(texture.getSize());
+	}
+
+	source.lastUsedFrame = _frame;
+	return (&texture);
+}
+
+/*!
+ * With a non-zero budget, textures are evicted at present() while stored
+ * Texture objects exceed it : least recently used ones first, among those
+ * unused for at least 'idleFrames' frames (and not used as tilesets). Evicted
+ * Texture objects stay valid and are rebuilt from their image file or text
+ * the next time they are drawn or queried.
+ *
+ * @param	bytes		Texture memory budget in bytes (0 = unlimited)
+ * @param	idleFrames	Minimum number of frames a Texture must stay unused
+ *						before it can be evicted (at least 1, so that
+ *						Textures drawn by the current frame are never evicted)
+ * @throws	Exception	Invalid input parameters
+ */
+void Renderer::setTextureBudget(
+	std::size_t const bytes,
+	Uint32 const idleFrames)
+{
+	// Check input parameters
+	if (idleFrames == 0)
+		THROW(Exception, "Received 'idleFrames' == 0");
+
+	_textureBudget = bytes;
+	_textureIdleFrames = idleFrames;
+}
+
+std::size_t Renderer::getTextureBytes(void) const
+{
+	return _textureBytes;
+}
+
+void Renderer::enforceTextureBudget(void)
+{
+	if (_textureBudget == 0 || _textureBytes <= _textureBudget)
+		return;
+
+	// Gather eviction candidates, least recently used first (never used by
+	// a frame the render thread may still execute)
+	Uint32 const completedFrames(getCompletedFrames());
+	std::vector<std::pair<Uint32, std::string>> candidates;
+	for (auto const & source : _textureSources)
+		if (!source.second.pinned &&
+			_frame - source.second.lastUsedFrame >= _textureIdleFrames &&
+			source.second.lastUsedFrame < completedFrames &&
+			_textures.at(source.first).isLoaded())
+			candidates.push_back(
+				make_pair(source.second.lastUsedFrame, source.first));
+	std::sort(candidates.begin(), candidates.end());
+
+	// Evict until within budget
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	for (auto const & candidate : candidates)
+	{
+		if (_textureBytes <= _textureBudget)
+			break;
+
+		Texture & texture(_textures.at(candidate.second));
+		_textureBytes -= texture.getSize();
+		texture.unload();
+
+		DEBUG(SDL_LOG_CATEGORY_APPLICATION,
+			"Evict texture '%s' (unused for %u frames)",
+			candidate.second.c_str(),
+			_frame - candidate.first);
+	}
+}
+
+/*!
+ * @param	textureName		Name to give to the newly created StreamingTexture
+ *							in the Renderer's internal storage
+ * @param	format			Packed pixel format of the StreamingTexture
+ * @param	width			StreamingTexture width
+ * @param	height			StreamingTexture height
+ * @throws	Exception		Invalid input parameters or SDL call error
+ */
+void Renderer::addStreamingTexture(
+	std::string const & textureName,
+	Uint32 const format,
+	int const width,
+	int const height)
+{
+	// Check input parameters
+	if (_streamingTextures.find(textureName) != _streamingTextures.end())
+		THROW(Exception,
+			"Cannot override existing streaming texture '%s'",
+			textureName.c_str());
+
+	// Instantiate StreamingTexture (may throw) & store it into internal map
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	_streamingTextures.emplace(
+		make_pair(textureName,
+			StreamingTexture(_renderer.get(), format, width, height)));
+}
+
+/*!
+ * @param	name	Name of the StreamingTexture to query
+ * @returns			The appropriate StreamingTexture for the input name,
+ *					nullptr if not found
+ */
+StreamingTexture * Renderer::getStreamingTexture(std::string const & name)
+{
+	// Lookup
+	auto textureIterator = _streamingTextures.find(name);
+	if (textureIterator == _streamingTextures.end()) /* Miss */
+		return nullptr;
+	else /* Hit */
+		return (&textureIterator->second);
+}
+
+/*!
+ * @param	layerName		Name to give to the newly created Layer in the
+ *							Renderer's internal storage
+ * @param	width			Layer width
+ * @param	height			Layer height
+ * @param	painter			Callback issuing the Layer's draw calls, replayed
+ *							only when the Layer is dirty
+ * @throws	Exception		Invalid input parameters or SDL call error
+ */
+void Renderer::addLayer(
+	std::string const & layerName,
+	int const width,
+	int const height,
+	Layer::Painter const & painter)
+{
+	// Check input parameters
+	if (_layers.find(layerName) != _layers.end())
+		THROW(Exception,
+			"Cannot override existing layer '%s'",
+			layerName.c_str());
+
+	// Instantiate Layer (may throw) & store it into internal map
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	_layers.emplace(
+		make_pair(layerName,
+			Layer(_renderer.get(), width, height, painter)));
+}
+
+/*!
+ * @param	name	Name of the Layer to query
+ * @returns			The appropriate Layer for the input name, nullptr if not
+ *					found
+ */
+Layer * Renderer::getLayer(std::string const & name)
+{
+	// Lookup
+	auto layerIterator = _layers.find(name);
+	if (layerIterator == _layers.end()) /* Miss */
+		return nullptr;
+	else /* Hit */
+		return (&layerIterator->second);
+}
+
+/*!
+ * Render target contents may be lost by the driver (SDL_RENDER_TARGETS_RESET,
+ * SDL_RENDER_DEVICE_RESET) : this forces every Layer to be repainted on its
+ * next copy.
+ */
+void Renderer::invalidateLayers(void)
+{
+	for (auto & layer : _layers)
+		layer.second.invalidate();
+}
+
+/*!
+ * @param	tileMapName		Name to give to the newly created TileMap in the
+ *							Renderer's internal storage
+ * @param	tilesetName		Name of the stored Texture holding the tiles
+ * @param	tileWidth		Tile width in pixels
+ * @param	tileHeight		Tile height in pixels
+ * @param	columns			Number of tile columns in the map
+ * @param	rows			Number of tile rows in the map
+ * @param	chunkSize		Chunk side, in tiles
+ * @throws	Exception		Invalid input parameters
+ */
+void Renderer::addTileMap(
+	std::string const & tileMapName,
+	std::string const & tilesetName,
+	int const tileWidth,
+	int const tileHeight,
+	int const columns,
+	int const rows,
+	int const chunkSize)
+{
+	// Check input parameters
+	if (_tileMaps.find(tileMapName) != _tileMaps.end())
+		THROW(Exception,
+			"Cannot override existing tile map '%s'",
+			tileMapName.c_str());
+
+	Texture * tileset(useTexture(tilesetName));
+	if (tileset == nullptr)
+		THROW(Exception,
+			"Cannot find tileset texture '%s'",
+			tilesetName.c_str());
+
+	// Instantiate TileMap (may throw) & store it into internal map
+	_tileMaps.emplace(
+		make_pair(tileMapName,
+			TileMap(_renderer.get(),
+				tileset,
+				tileWidth,
+				tileHeight,
+				columns,
+				rows,
+				chunkSize,
+				&_sdlMutex)));
+
+	// Chunks are baked from the tileset at any time : never evict it
+	_textureSources.at(tilesetName).pinned = true;
+}
+
+/*!
+ * @param	name	Name of the TileMap to query
+ * @returns			The appropriate TileMap for the input name, nullptr if not
+ *					found
+ */
+TileMap * Renderer::getTileMap(std::string const & name)
+{
+	// Lookup
+	auto tileMapIterator = _tileMaps.find(name);
+	if (tileMapIterator == _tileMaps.end()) /* Miss */
+		return nullptr;
+	else /* Hit */
+		return (&tileMapIterator->second);
+}
+
+/*!
+ * See Renderer::invalidateLayers()
+ */
+void Renderer::invalidateTileMaps(void)
+{
+	for (auto & tileMap : _tileMaps)
+		tileMap.second.invalidate();
+}
+
+/*!
+ * Flushes pending text, saves the current rendering target & state, then
+ * targets the Layer's Texture and clears it to full transparency.
+ *
+ * @param	texture	Layer render target
+ * @param	saved	Receives the previous rendering target & state
+ * @returns			false if the Layer cannot be targeted (nothing changed)
+ */
+bool Renderer::beginLayerPaint(SDL_Texture * texture, SavedTarget & saved)
+{
+	SDL_Renderer * renderer(_renderer.get());
+	flushText();
+
+	// Viewport & scale may have been set by recorded state changes
+	saved.target = SDL_GetRenderTarget(renderer);
+	SDL_RenderGetScale(renderer, &saved.scale.x, &saved.scale.y);
+	SDL_RenderGetViewport(renderer, &saved.viewport);
+	SDL_RenderGetClipRect(renderer, &saved.clip);
+	saved.clipEnabled = SDL_RenderIsClipEnabled(renderer);
+
+	// Redirect rendering into the Layer
+	if (SDL_SetRenderTarget(renderer, texture))
+	{
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot target layer texture : SDL error '%s'",
+			SDL_GetError());
+		return false;
+	}
+	++_renderStats.targetSwitches;
+
+	// Start from a fully transparent canvas
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+	SDL_RenderClear(renderer);
+	++_renderStats.drawCalls;
+	++_renderStats.primitives;
+
+	return true;
+}
+
+/*!
+ * @param	saved	Rendering target & state saved by beginLayerPaint()
+ */
+void Renderer::endLayerPaint(SavedTarget const & saved)
+{
+	SDL_Renderer * renderer(_renderer.get());
+	flushText();
+
+	if (SDL_SetRenderTarget(renderer, saved.target))
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot restore rendering target : SDL error '%s'",
+			SDL_GetError());
+	SDL_RenderSetScale(renderer, saved.scale.x, saved.scale.y);
+	SDL_RenderSetViewport(renderer, &saved.viewport);
+	SDL_RenderSetClipRect(renderer, saved.clipEnabled ? &saved.clip : nullptr);
+	++_renderStats.targetSwitches;
+}
+
+/*!
+ * Switches the rendering target to the Layer's Texture, clears it to full
+ * transparency, replays the painter, then restores the previous rendering
+ * target and drawing state. Draw calls issued by the painter are always
+ * executed immediately, even in partial redraw mode. Blended draw calls leave
+ * premultiplied colors in the Layer, which is composited accordingly.
+ *
+ * In render thread mode, the painter's draw calls are recorded apart instead
+ * (never culled), and replayed into the Layer by a single task of the current
+ * frame : the calling thread never waits for the render thread.
+ *
+ * @param	layer	Layer to repaint
+ */
+void Renderer::paintLayer(Layer & layer)
+{
+	SDL_Texture * texture(layer.getTexture().getSDLTexture());
+	SDL_Color const previousColor(_drawColor);
+	SDL_BlendMode const previousBlendMode(_blendMode);
+
+	if (_renderThread.joinable())
+	{
+		// Record the painter's draw calls & state changes apart
+		std::shared_ptr<std::vector<RenderCommand>> commands(
+			new std::vector<RenderCommand>());
+		SDL_Rect const previousVisibleArea(_visibleArea);
+		Uint32 const previousStateChangeFrame(_stateChangeFrame);
+		_commands.swap(*commands);
+		_visibleArea = UNCULLED_AREA;
+
+		layer.getPainter()(*this);
+		layer.validate();
+
+		// Layer state changes are undone by the task
+		_commands.swap(*commands);
+		_visibleArea = previousVisibleArea;
+		_stateChangeFrame = previousStateChangeFrame;
+		_drawColor = previousColor;
+		_blendMode = previousBlendMode;
+
+		recordTask([this, texture, commands] (void) {
+			SavedTarget saved;
+			if (!beginLayerPaint(texture, saved))
+				return;
+			for (RenderCommand const & command : *commands)
+				execute(command, nullptr);
+			endLayerPaint(saved);
+		});
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	SavedTarget saved;
+	if (!beginLayerPaint(texture, saved))
+		return;
+
+	// Replay draw calls
+	++_layerDepth;
+	layer.getPainter()(*this);
+	layer.validate();
+	--_layerDepth;
+
+	// Restore previous rendering target & drawing state
+	endLayerPaint(saved);
+	_drawColor = previousColor;
+	_blendMode = previousBlendMode;
+}
+
+/*!
+ * Glyphs missing from the font cache are rasterized on first use.
+ *
+ * @param	text		Text to print (UTF-8)
+ * @param	fontName	Name of the font to use
+ * @param	size		Text size
+ * @param	color		Text color
+ * @param	destination	Destination rectangle (will crop)
+ * @throws	Exception	Invalid input parameters or SDL/TTF call error
+ *
+ * @todo	Unify API
+ */
+void Renderer::printText(
+	std::string const & text,
+	std::string const & fontName,
+	int const size,
+	SDL_Color const & color,
+	SDL_Rect const & destination)
+{
+	// Check input parameters
+	if (fontName.empty())
+		THROW(Exception, "Received empty 'fontName'");
+	if (size <= 0)
+		THROW(Exception, "Received 'size' <= 0");
+
+	// Try retrieving BitmapFont (generated on first use)
+	BitmapFont * font(_bitmapFontManager->findFont(fontName, size));
+	if (font == nullptr)
+	{
+		std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+		font = _bitmapFontManager->getFont(fontName, size);
+	}
+	if (font) /* Hit */
+	{
+		// Render
+		RenderCommand command(makeCommand(RenderCommand::TEXT));
+		command.font = font;
+		command.text = text;
+		command.color = color;
+		command.destination = destination;
+		submit(std::move(command));
+	}
+	else /* Miss */
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot print dynamic text : missing font '%s' size '%d'",
+			fontName.c_str(),
+			size);
+}
+
+/*!
+ * @param	fontName		Name of the font to use
+ * @param	size			Debug text size
+ * @param	xDest			X destination (top left pixel)
+ * @param	yDest			Y destination (top left pixel)
+ * @throws	Exception		Invalid input parameters or SDL/TTF call error
+ *
+ * @todo	Remove, at some point
+ */
+void Renderer::printDebugText(
+	std::string const & fontName,
+	int const size,
+	int const xDest,
+	int const yDest)
+{
+	BitmapFont * font = _bitmapFontManager->findFont(fontName, size);
+	if (font == nullptr)
+	{
+		std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+		font = _bitmapFontManager->getFont(fontName, size);
+	}
+	if (font)
+	{
+		RenderCommand command(makeCommand(RenderCommand::FONT_DEBUG));
+		command.font = font;
+		command.destination = SDL_Rect{
+			xDest,
+			yDest,
+			font->getTexture()->getWidth(),
+			font->getTexture()->getHeight()};
+		submit(std::move(command));
+	}
+	else
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot print debug text : missing font '%s' size '%d'",
+			fontName,
+			size);
+}
+
+/*!
+ * BLENDED fonts are anti-aliased, and still batched into atlas pages : one
+ * font exists per {font,size,mode}, so both modes may be used within a frame.
+ *
+ * @param	renderMode	Render mode of texts printed from now on
+ */
+void Renderer::setTextRenderMode(BitmapFont::RenderMode const renderMode)
+{
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	_bitmapFontManager->setRenderMode(renderMode);
+}
+
+BitmapFont::RenderMode Renderer::getTextRenderMode(void) const
+{
+	return _bitmapFontManager->getRenderMode();
+}
+
+/*!
+ * Fonts first used afterwards are loaded from the directory instead of being
+ * baked again, as long as the font file did not change.
+ *
+ * @param	cacheDirectory	Existing directory ("" disables the cache)
+ */
+void Renderer::setFontCacheDirectory(std::string const & cacheDirectory)
+{
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	_bitmapFontManager->setCacheDirectory(cacheDirectory);
+}
+
+/*!
+ * Fonts of the current text render mode share atlas pages : a low used area
+ * over many pages hints at a smaller preload set, a full atlas at glyph
+ * evictions.
+ *
+ * @returns	Page count & allocated area
+ */
+GlyphAtlas::Occupancy Renderer::getGlyphAtlasOccupancy(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	return _bitmapFontManager->getAtlasOccupancy();
+}
+
+/*!
+ * Fonts are rasterized on worker threads, then uploaded with the current text
+ * render mode & font cache directory : printing them later on does not stall.
+ * The render thread keeps running while fonts are rasterized.
+ *
+ * @param	fonts		{name, size} pairs to bake
+ * @throws	Exception	Invalid input parameters
+ */
+void Renderer::preloadFonts(
+	std::vector<std::pair<std::string, int>> const & fonts)
+{
+	_bitmapFontManager->preload(fonts, &_sdlMutex);
+}
+
+/*!
+ * The returned layout may be printed any number of times with
+ * printText(layout, ...), without measuring or wrapping the text again.
+ *
+ * @param	text		Text to lay out (UTF-8)
+ * @param	fontName	Name of the font to use
+ * @param	size		Text size
+ * @param	width		Maximum line width
+ * @param	height		Maximum layout height (extra lines are dropped)
+ * @param	options		Alignment, line height & ellipsis
+ * @returns				The computed layout, nullptr if the font is missing
+ * @throws	Exception	Invalid input parameters or SDL/TTF call error
+ */
+std::shared_ptr<TextLayout const> Renderer::layoutText(
+	std::string_view const text,
+	std::string const & fontName,
+	int const size,
+	int const width,
+	int const height,
+	TextLayout::Options const & options)
+{
+	// Check input parameters
+	if (fontName.empty())
+		THROW(Exception, "Received empty 'fontName'");
+	if (size <= 0)
+		THROW(Exception, "Received 'size' <= 0");
+
+	// Only font creation needs the renderer : laying out & measuring text
+	// simply excludes the text commands executed meanwhile
+	BitmapFont * font(_bitmapFontManager->findFont(fontName, size));
+	if (font == nullptr)
+	{
+		std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+		font = _bitmapFontManager->getFont(fontName, size);
+	}
+	if (font == nullptr)
+	{
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot lay text out : missing font '%s' size '%d'",
+			fontName.c_str(),
+			size);
+		return nullptr;
+	}
+
+	std::shared_ptr<TextLayout> layout(std::make_shared<TextLayout>());
+	std::lock_guard<std::mutex> lock(_textMutex);
+	font->layoutText(text, width, height, *layout, options);
+	return layout;
+}
+
+/*!
+ * Nothing is drawn nor allocated (once glyphs are cached) : suited to sizing
+ * UI elements every frame.
+ *
+ * @param	text		Text to measure (UTF-8)
+ * @param	fontName	Name of the font to use
+ * @param	size		Text size
+ * @param	width		Maximum line width
+ * @param	height		Maximum layout height (extra lines are dropped)
+ * @param	options		Alignment, line height & ellipsis
+ * @returns				Area the text would cover relative to the layout origin
+ *						(empty if the font is missing)
+ * @throws	Exception	Invalid input parameters or SDL/TTF call error
+ */
+SDL_Rect Renderer::measureText(
+	std::string_view const text,
+	std::string const & fontName,
+	int const size,
+	int const width,
+	int const height,
+	TextLayout::Options const & options)
+{
+	// Check input parameters
+	if (fontName.empty())
+		THROW(Exception, "Received empty 'fontName'");
+	if (size <= 0)
+		THROW(Exception, "Received 'size' <= 0");
+
+	BitmapFont * font(_bitmapFontManager->findFont(fontName, size));
+	if (font == nullptr)
+	{
+		std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+		font = _bitmapFontManager->getFont(fontName, size);
+	}
+	if (font == nullptr)
+	{
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot measure text : missing font '%s' size '%d'",
+			fontName.c_str(),
+			size);
+		return SDL_Rect{0, 0, 0, 0};
+	}
+
+	std::lock_guard<std::mutex> lock(_textMutex);
+	return font->measureText(text, width, height, options);
+}
+
+/*!
+ * @param	layout		Layout returned by layoutText()
+ * @param	color		Text color
+ * @param	xDest		X destination (top left pixel)
+ * @param	yDest		Y destination (top left pixel)
+ * @throws	Exception	Invalid input parameters
+ */
+void Renderer::printText(
+	std::shared_ptr<TextLayout const> const & layout,
+	SDL_Color const & color,
+	int const xDest,
+	int const yDest)
+{
+	// Check input parameters
+	if (!layout)
+		THROW(Exception, "Received nullptr 'layout'");
+
+	RenderCommand command(makeCommand(RenderCommand::TEXT));
+	command.font = layout->getFont();
+	command.layout = layout;
+	command.color = color;
+	command.destination = SDL_Rect{
+		xDest,
+		yDest,
+		layout->getWidth(),
+		layout->getHeight()};
+	submit(std::move(command));
+}
+
+/*!
+ * Layouts are cached by a hash of {text, font, destination size} : texts
+ * printed again with the same parameters are neither measured nor wrapped.
+ * A hash collision simply replaces the cached layout.
+ *
+ * @param	command	TEXT command printing a plain string
+ * @returns			Layout of the command text
+ */
+TextLayout const & Renderer::getTextLayout(RenderCommand const & command)
+{
+	std::size_t key(std::hash<std::string>()(command.text));
+	std::size_t const parts[3] = {
+		std::hash<BitmapFont const *>()(command.font),
+		(std::size_t)command.destination.w,
+		(std::size_t)command.destination.h};
+	for (std::size_t const part : parts)
+		key ^= part + 0x9E3779B9 + (key << 6) + (key >> 2);
+
+	CachedTextLayout & cached(_textLayouts[key]);
+	if (!cached.layout.matches(
+		command.font,
+		command.text,
+		command.destination.w,
+		command.destination.h,
+		TextLayout::Options()))
+		command.font->layoutText(
+			command.text,
+			command.destination.w,
+			command.destination.h,
+			cached.layout);
+	cached.lastUsed = _textLayoutStamp;
+
+	return cached.layout;
+}
+
+/*!
+ * Drops layouts which were not printed during the last
+ * TEXT_LAYOUT_IDLE_FRAMES executed frames.
+ */
+void Renderer::trimTextLayouts(void)
+{
+	std::lock_guard<std::mutex> lock(_textMutex);
+	++_textLayoutStamp;
+	for (auto iterator(_textLayouts.begin()) ; iterator != _textLayouts.end() ; )
+	{
+		if (_textLayoutStamp - iterator->second.lastUsed > TEXT_LAYOUT_IDLE_FRAMES)
+			iterator = _textLayouts.erase(iterator);
+		else
+			++iterator;
+	}
+}
+
+/*!
+ * The drawing color is applied when primitives are executed.
+ *
+ * @param	red		Red component
+ * @param	green	Green component
+ * @param	blue	Blue component
+ * @param	blue	Alpha component
+ */
+void Renderer::setDrawColor(
+	Uint8 const red,
+	Uint8 const green,
+	Uint8 const blue,
+	Uint8 const alpha)
+{
+	_drawColor = SDL_Color{red, green, blue, alpha};
+}
+
+/*!
+ * The drawing color is applied when primitives are executed.
+ *
+ * @param	color	SDL_Color to use
+ */
+void Renderer::setDrawColor(SDL_Color const & color)
+{
+	_drawColor = color;
+}
+
+/*!
+ * The blending mode is applied when primitives are executed.
+ *
+ * @param	blendMode	SDL_BlendMode to use
+ */
+void Renderer::setBlendMode(SDL_BlendMode const & blendMode)
+{
+	_blendMode = blendMode;
+}
+
+/*!
+ * In render thread mode, the change is recorded and applied by the render
+ * thread in order with the surrounding draw calls ; it is applied right away
+ * otherwise.
+ *
+ * @param	w	Logical width
+ * @param	h	Logical height
+ */
+void Renderer::setLogicalSize(int const w, int const h)
+{
+	RenderCommand command(RenderCommand::SET_LOGICAL_SIZE);
+	command.destination = SDL_Rect{0, 0, w, h};
+	submitState(std::move(command));
+}
+
+/*!
+ * See Renderer::setLogicalSize()
+ *
+ * @param	viewport	Drawing area within the rendering target
+ */
+void Renderer::setViewport(SDL_Rect const & viewport)
+{
+	RenderCommand command(RenderCommand::SET_VIEWPORT);
+	command.destination = viewport;
+	submitState(std::move(command));
+}
+
+/*!
+ * See Renderer::setLogicalSize()
+ */
+void Renderer::resetViewport(void)
+{
+	submitState(RenderCommand(RenderCommand::RESET_VIEWPORT));
+}
+
+/*!
+ * See Renderer::setLogicalSize()
+ *
+ * @param	x	Horizontal scale
+ * @param	y	Vertical scale
+ */
+void Renderer::setScale(float const x, float const y)
+{
+	RenderCommand command(RenderCommand::SET_SCALE);
+	command.scale = SDL_FPoint{x, y};
+	submitState(std::move(command));
+}
+
+void Renderer::clear(void)
+{
+	submit(makeCommand(RenderCommand::CLEAR));
+}
+
+void Renderer::fill(void)
+{
+	submit(makeCommand(RenderCommand::FILL));
+}
+
+void Renderer::fillRect(SDL_Rect const & rectangle)
+{
+	RenderCommand command(makeCommand(RenderCommand::FILL_RECT));
+	command.destination = rectangle;
+	submit(std::move(command));
+}
+
+void Renderer::drawRect(SDL_Rect const & rectangle)
+{
+	RenderCommand command(makeCommand(RenderCommand::DRAW_RECT));
+	command.destination = rectangle;
+	submit(std::move(command));
+}
+
+void Renderer::drawLine(
+	int const x1,
+	int const y1,
+	int const x2,
+	int const y2)
+{
+	RenderCommand command(makeCommand(RenderCommand::DRAW_LINE));
+	command.start = SDL_Point{x1, y1};
+	command.end = SDL_Point{x2, y2};
+	submit(std::move(command));
+}
+
+/*!
+ * All points are drawn with a single SDL_RenderDrawPoints() call.
+ *
+ * @param	points	Points to draw
+ */
+void Renderer::drawPoints(std::vector<SDL_Point> const & points)
+{
+	if (points.empty() ||
+		drawImmediately(RenderCommand::DRAW_POINTS,
+			points.data(),
+			points.size()))
+		return;
+
+	RenderCommand command(makeCommand(RenderCommand::DRAW_POINTS));
+	command.points = points;
+	submit(std::move(command));
+}
+
+/*!
+ * Consecutive points are joined with a single SDL_RenderDrawLines() call.
+ *
+ * @param	points	Polyline points
+ */
+void Renderer::drawLines(std::vector<SDL_Point> const & points)
+{
+	if (points.empty() ||
+		drawImmediately(RenderCommand::DRAW_LINES,
+			points.data(),
+			points.size()))
+		return;
+
+	RenderCommand command(makeCommand(RenderCommand::DRAW_LINES));
+	command.points = points;
+	submit(std::move(command));
+}
+
+/*!
+ * All outlines are drawn with a single SDL_RenderDrawRects() call.
+ *
+ * @param	rectangles	Rectangles to outline
+ */
+void Renderer::drawRects(std::vector<SDL_Rect> const & rectangles)
+{
+	if (rectangles.empty() ||
+		drawImmediately(RenderCommand::DRAW_RECTS,
+			rectangles.data(),
+			rectangles.size()))
+		return;
+
+	RenderCommand command(makeCommand(RenderCommand::DRAW_RECTS));
+	command.rects = rectangles;
+	submit(std::move(command));
+}
+
+/*!
+ * All rectangles are filled with a single SDL_RenderFillRects() call.
+ *
+ * @param	rectangles	Rectangles to fill
+ */
+void Renderer::fillRects(std::vector<SDL_Rect> const & rectangles)
+{
+	if (rectangles.empty() ||
+		drawImmediately(RenderCommand::FILL_RECTS,
+			rectangles.data(),
+			rectangles.size()))
+		return;
+
+	RenderCommand command(makeCommand(RenderCommand::FILL_RECTS));
+	command.rects = rectangles;
+	submit(std::move(command));
+}
+
+/*!
+ * The whole batch is drawn with a single SDL_RenderGeometry() call, whatever
+ * the number of different colors it holds.
+ *
+ * @param	batch	Colored primitives to draw
+ */
+void Renderer::drawBatch(PrimitiveBatch const & batch)
+{
+	std::vector<SDL_Vertex> const & vertices(batch.getVertices());
+	std::vector<int> const & indices(batch.getIndices());
+	if (batch.isEmpty() ||
+		drawImmediately(RenderCommand::GEOMETRY,
+			vertices.data(),
+			vertices.size(),
+			indices.empty() ? nullptr : indices.data(),
+			indices.size()))
+		return;
+
+	RenderCommand command(makeCommand(RenderCommand::GEOMETRY));
+	command.vertices = vertices;
+	command.indices = indices;
+	submit(std::move(command));
+}
+
+/*!
+ * @param	textureName		Name of the Texture to copy on rendering space
+ * @param	clipName		Name of the clipping rectangle to use ("" = entire
+ *							Texture)
+ * @param	destination		Destination rectangle for the rendering
+ * @throws	Exception		Invalid input parameters or SDL call error
+ *
+ * @todo	Add 1:1 version
+ */
+void Renderer::copy(
+	std::string const & textureName,
+	std::string const & clipName,
+	SDL_Rect const & destination)
+{
+	// Texture lookup (reloads evicted Texture, skips still decoding ones)
+	Texture * texture(useTexture(textureName));
+	if (texture == nullptr)
+	{
+		// Reload failures are reported by useTexture()
+		if (!hasTexture(textureName))
+			ERROR(SDL_LOG_CATEGORY_ERROR,
+				"Cannot copy texture '%s' : not found in _textures",
+				textureName.c_str());
+		return;
+	}
+
+	// Clip lookup
+	SDL_Rect * clip = texture->getClip(clipName);
+	if (!clip)
+	{
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"No clip '%s' on texture '%s'",
+			clipName.c_str(),
+			textureName.c_str());
+		return;
+	}
+
+	// Rendering attempt
+	RenderCommand command(makeCommand(RenderCommand::COPY));
+	command.texture = texture->getSDLTexture();
+	command.source = *clip;
+	command.destination = destination;
+	submit(std::move(command));
+}
+
+/*!
+ * @param	textureName		Name of the Texture to copy on rendering space
+ * @param	clipName		Name of the clipping rectangle to use ("" = entire
+ *							Texture)
+ * @param	destination		Destination rectangle for the rendering
+ * @param	angle			Angle of rotation in degrees (0 = no rotation)
+ * @param	center			Center of rotation
+ * @param	flip			SDL flip flag
+ * @throws	Exception		Invalid input parameters or SDL call error
+ *
+ * @todo	Add 1:1 version
+ */
+void Renderer::copyEx(
+	std::string const & textureName,
+	std::string const & clipName,
+	SDL_Rect const & destination,
+	double const angle,
+	SDL_Point const & center,
+	SDL_RendererFlip const & flip)
+{
+	// Texture lookup (reloads evicted Texture, skips still decoding ones)
+	Texture * texture(useTexture(textureName));
+	if (texture == nullptr)
+	{
+		// Reload failures are reported by useTexture()
+		if (!hasTexture(textureName))
+			ERROR(SDL_LOG_CATEGORY_ERROR,
+				"Cannot copy texture '%s' : not found in _textures",
+				textureName.c_str());
+		return;
+	}
+
+	// Clip lookup
+	SDL_Rect * clip = texture->getClip(clipName);
+	if (!clip)
 	{
 		ERROR(SDL_LOG_CATEGORY_ERROR,
 			"No clip '%s' on texture '%s'",
@@ -399,75 +1871,1651 @@ void Renderer::copy(
 		return;
 	}
 
-	SDL_Texture * sdlTexture = textureIterator->second.getSDLTexture();
+	// Rendering attempt
+	RenderCommand command(makeCommand(RenderCommand::COPY_EX));
+	command.texture = texture->getSDLTexture();
+	command.source = *clip;
+	command.destination = destination;
+	command.angle = angle;
+	command.center = center;
+	command.flip = flip;
+	submit(std::move(command));
+}
+
+/*!
+ * Pending CPU-side changes are uploaded into the StreamingTexture's back buffer
+ * before the copy, which then uses the freshly swapped front buffer.
+ *
+ * @param	textureName		Name of the StreamingTexture to copy on rendering
+ *							space
+ * @param	destination		Destination rectangle for the rendering
+ */
+void Renderer::copyStreamingTexture(
+	std::string const & textureName,
+	SDL_Rect const & destination)
+{
+	// StreamingTexture lookup
+	auto textureIterator = _streamingTextures.find(textureName);
+	if (textureIterator == _streamingTextures.end())
+	{
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot copy streaming texture '%s' : not found in "
+				"_streamingTextures",
+			textureName.c_str());
+		return;
+	}
+
+	StreamingTexture & streamingTexture(textureIterator->second);
+	if (_renderThread.joinable())
+	{
+		// Upload staged changes on the render thread, before the copy
+		std::shared_ptr<StreamingTexture::Upload> upload(
+			new StreamingTexture::Upload());
+		if (streamingTexture.stage(*upload))
+			recordTask([this, upload] (void) {
+				countUpload(StreamingTexture::upload(*upload));
+			});
+	}
+	else if (streamingTexture.hasPendingChanges())
+	{
+		std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+		countUpload(streamingTexture.commit());
+	}
+
+	Texture & texture(streamingTexture.getTexture());
+	RenderCommand command(makeCommand(RenderCommand::COPY));
+	command.texture = texture.getSDLTexture();
+	command.revision = streamingTexture.getRevision();
+	command.source = SDL_Rect{0, 0, texture.getWidth(), texture.getHeight()};
+	command.destination = destination;
+	submit(std::move(command));
+}
+
+/*!
+ * @param	layerName		Name of the Layer to copy on rendering space
+ * @param	destination		Destination rectangle for the rendering
+ */
+void Renderer::copyLayer(
+	std::string const & layerName,
+	SDL_Rect const & destination)
+{
+	// Layer lookup
+	auto layerIterator = _layers.find(layerName);
+	if (layerIterator == _layers.end())
+	{
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot copy layer '%s' : not found in _layers",
+			layerName.c_str());
+		return;
+	}
+
+	Layer & layer(layerIterator->second);
+
+	// Only replay the Layer's draw calls when its cache is outdated
+	if (layer.isDirty())
+		paintLayer(layer);
+
+	// Composite the cached drawing with a single copy
+	Texture & texture(layer.getTexture());
+	RenderCommand command(makeCommand(RenderCommand::COPY));
+	command.texture = texture.getSDLTexture();
+	command.revision = layer.getRevision();
+	command.source = SDL_Rect{0, 0, texture.getWidth(), texture.getHeight()};
+	command.destination = destination;
+	submit(std::move(command));
+}
+
+/*!
+ * Only chunks intersecting the camera are drawn, one copy per chunk. The
+ * camera area is stretched onto the destination rectangle.
+ *
+ * @param	tileMapName		Name of the TileMap to draw on rendering space
+ * @param	camera			Viewed area, in map pixels
+ * @param	destination		Destination rectangle for the rendering
+ */
+void Renderer::drawTileMap(
+	std::string const & tileMapName,
+	SDL_Rect const & camera,
+	SDL_Rect const & destination)
+{
+	// TileMap lookup
+	auto tileMapIterator = _tileMaps.find(tileMapName);
+	if (tileMapIterator == _tileMaps.end())
+	{
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot draw tile map '%s' : not found in _tileMaps",
+			tileMapName.c_str());
+		return;
+	}
+	if (camera.w <= 0 || camera.h <= 0)
+		return;
+
+	// Bake & cull chunks (may throw ; render thread mode : bakes are run by
+	// the render thread, before the chunks are copied)
+	TileMap::BakeScheduler schedule;
+	if (_renderThread.joinable())
+		schedule = [this] (std::function<void(void)> && bake) {
+			recordTask(std::move(bake));
+		};
+	std::vector<TileMap::ChunkCopy> const & chunks(
+		tileMapIterator->second.prepare(camera, schedule));
+	countBakes(tileMapIterator->second.takeBakeStats());
+
+	for (TileMap::ChunkCopy const & chunk : chunks)
+	{
+		// Scale camera-relative area onto destination (edges computed
+		// separately to avoid seams between chunks)
+		int const left(chunk.destination.x * destination.w / camera.w);
+		int const top(chunk.destination.y * destination.h / camera.h);
+		int const right((chunk.destination.x + chunk.destination.w)
+			* destination.w / camera.w);
+		int const bottom((chunk.destination.y + chunk.destination.h)
+			* destination.h / camera.h);
+
+		RenderCommand command(makeCommand(RenderCommand::COPY));
+		command.texture = chunk.texture;
+		command.revision = chunk.revision;
+		command.source = chunk.source;
+		command.destination = SDL_Rect{
+			destination.x + left,
+			destination.y + top,
+			right - left,
+			bottom - top};
+		submit(std::move(command));
+	}
+}
+
+/*!
+ * @returns		true if draw calls are recorded for later execution (partial
+ *				redraw or render thread mode, outside of Layer painters)
+ */
+bool Renderer::isRecording(void) const
+{
+	return ((_canvas || _renderThread.joinable()) && _layerDepth == 0);
+}
+
+/*!
+ * Primitives capture the current drawing color & blending mode, so that they
+ * can be executed later on with the state they were submitted with.
+ *
+ * @param	type	Kind of draw call
+ * @returns			A new command, ready to be completed & submitted
+ */
+RenderCommand Renderer::makeCommand(RenderCommand::Type const type) const
+{
+	RenderCommand command(type);
+
+	switch (type)
+	{
+		case RenderCommand::CLEAR:
+			command.color = _drawColor;
+		break;
+		case RenderCommand::FILL:
+		case RenderCommand::FILL_RECT:
+		case RenderCommand::DRAW_RECT:
+		case RenderCommand::DRAW_LINE:
+		case RenderCommand::DRAW_POINTS:
+		case RenderCommand::DRAW_LINES:
+		case RenderCommand::DRAW_RECTS:
+		case RenderCommand::FILL_RECTS:
+			command.color = _drawColor;
+			command.blendMode = _blendMode;
+		break;
+		case RenderCommand::GEOMETRY:
+			command.blendMode = _blendMode;
+		break;
+		default:
+		break;
+	}
+
+	return command;
+}
+
+/*!
+ * Copies whose (rotated) destination lies entirely outside the visible area
+ * (canvas in partial redraw mode, current viewport otherwise) are culled
+ * before reaching SDL. In partial redraw mode, remaining draw calls targeting
+ * the canvas are recorded until present() ; they are executed right away
+ * otherwise.
+ *
+ * @param	command		Draw call to process
+ */
+void Renderer::submit(RenderCommand && command)
+{
+	bool const deferred(isRecording());
+
+	// Visible area, in drawing coordinates
+	SDL_Rect visible{0, 0, 0, 0};
+	if (_canvas && _layerDepth == 0)
+	{
+		visible.w = _canvas->getWidth();
+		visible.h = _canvas->getHeight();
+	}
+	else if (deferred)
+		visible = _visibleArea;
+	else
+	{
+		SDL_RenderGetViewport(_renderer.get(), &visible);
+		visible.x = 0;
+		visible.y = 0;
+	}
+	command.bounds = command.computeBounds(visible);
+
+	// Cull off-screen copies
+	if (command.type == RenderCommand::COPY ||
+		command.type == RenderCommand::COPY_EX)
+	{
+		if (!SDL_HasIntersection(&command.bounds, &visible))
+		{
+			++_cullingStats.culled;
+			return;
+		}
+		++_cullingStats.drawn;
+
+		// Record source texture state, so that modulation changes damage the
+		// canvas and replays draw with the state of the original draw call
+		if (_canvas && _layerDepth == 0)
+		{
+			SDL_GetTextureColorMod(command.texture,
+				&command.modulation.r,
+				&command.modulation.g,
+				&command.modulation.b);
+			SDL_GetTextureAlphaMod(command.texture, &command.modulation.a);
+			SDL_GetTextureBlendMode(command.texture, &command.blendMode);
+		}
+	}
+
+	if (deferred)
+		_commands.push_back(std::move(command));
+	else
+		execute(command, nullptr);
+}
+
+/*!
+ * State changes are only recorded in render thread mode : in partial redraw
+ * mode, they apply to the rendering space the canvas is composited onto.
+ * Until the render thread reports a viewport measured after the change, draw
+ * calls are not culled.
+ *
+ * @param	command		State change to process
+ */
+void Renderer::submitState(RenderCommand && command)
+{
+	if (_renderThread.joinable() && _layerDepth == 0)
+	{
+		_commands.push_back(std::move(command));
+		_stateChangeFrame = _frame;
+		_visibleArea = UNCULLED_AREA;
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	execute(command, nullptr);
+}
+
+/*!
+ * Render thread mode only : the task runs on the render thread, in order with
+ * the commands recorded around it, and still runs if its frame is replaced.
+ *
+ * @param	task	SDL_Renderer work to run
+ */
+void Renderer::recordTask(std::function<void(void)> task)
+{
+	RenderCommand command(RenderCommand::TASK);
+	command.task = std::move(task);
+	_commands.push_back(std::move(command));
+}
+
+/*!
+ * Flushes pending text if needed, updates rendering counters and applies the
+ * drawing state of primitives.
+ *
+ * @param	command		Draw call about to be executed
+ * @param	batchSize	Number of points, rectangles or (indexed) vertices of
+ *						a primitive batch, ignored otherwise
+ */
+void Renderer::beginCommand(
+	RenderCommand const & command,
+	std::size_t const batchSize)
+{
+	SDL_Renderer * renderer(_renderer.get());
+
+	// Consecutive texts printed from the same atlas share a single draw call
+	if (command.type != RenderCommand::TEXT ||
+		command.font->getAtlas() != _pendingTextAtlas)
+		flushText();
+
+	countCommand(command, batchSize);
+
+	// Apply drawing state for primitives
+	switch (command.type)
+	{
+		case RenderCommand::CLEAR:
+		case RenderCommand::FILL:
+		case RenderCommand::FILL_RECT:
+		case RenderCommand::DRAW_RECT:
+		case RenderCommand::DRAW_LINE:
+		case RenderCommand::DRAW_POINTS:
+		case RenderCommand::DRAW_LINES:
+		case RenderCommand::DRAW_RECTS:
+		case RenderCommand::FILL_RECTS:
+		case RenderCommand::GEOMETRY:
+			if (SDL_SetRenderDrawColor(renderer,
+				command.color.r,
+				command.color.g,
+				command.color.b,
+				command.color.a))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot set renderer draw color : SDL error '%s'",
+					SDL_GetError());
+			if (SDL_SetRenderDrawBlendMode(renderer, command.blendMode))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot set renderer blend mode : SDL eror '%s'",
+					SDL_GetError());
+		break;
+		default:
+		break;
+	}
+}
+
+/*!
+ * @param	type		Kind of primitive batch (DRAW_POINTS, DRAW_LINES,
+ *						DRAW_RECTS, FILL_RECTS or GEOMETRY)
+ * @param	elements	Points, rectangles or vertices, depending on 'type'
+ * @param	count		Number of elements
+ * @param	indices		Vertex indices (GEOMETRY only, nullptr = none)
+ * @param	indexCount	Number of vertex indices
+ */
+void Renderer::executeBatch(
+	RenderCommand::Type const type,
+	void const * elements,
+	std::size_t const count,
+	int const * indices,
+	std::size_t const indexCount)
+{
+	SDL_Renderer * renderer(_renderer.get());
+
+	switch (type)
+	{
+		case RenderCommand::DRAW_POINTS:
+			if (SDL_RenderDrawPoints(renderer,
+				static_cast<SDL_Point const *>(elements),
+				(int)count))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot draw points : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		case RenderCommand::DRAW_LINES:
+			if (SDL_RenderDrawLines(renderer,
+				static_cast<SDL_Point const *>(elements),
+				(int)count))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot draw lines : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		case RenderCommand::DRAW_RECTS:
+			if (SDL_RenderDrawRects(renderer,
+				static_cast<SDL_Rect const *>(elements),
+				(int)count))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot draw rectangles : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		case RenderCommand::FILL_RECTS:
+			if (SDL_RenderFillRects(renderer,
+				static_cast<SDL_Rect const *>(elements),
+				(int)count))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot fill rectangles : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		case RenderCommand::GEOMETRY:
+			if (SDL_RenderGeometry(renderer,
+				nullptr,
+				static_cast<SDL_Vertex const *>(elements),
+				(int)count,
+				indices,
+				(int)indexCount))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot draw geometry : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		default:
+		break;
+	}
+}
+
+/*!
+ * Outside of recording (immediate mode, Layer painters), primitive batches are
+ * drawn straight from the caller's data instead of being copied into a
+ * RenderCommand first.
+ *
+ * @param	type		Kind of primitive batch
+ * @param	elements	Points, rectangles or vertices, depending on 'type'
+ * @param	count		Number of elements
+ * @param	indices		Vertex indices (GEOMETRY only, nullptr = none)
+ * @param	indexCount	Number of vertex indices
+ * @returns				false if the batch has to be recorded instead
+ */
+bool Renderer::drawImmediately(
+	RenderCommand::Type const type,
+	void const * elements,
+	std::size_t const count,
+	int const * indices,
+	std::size_t const indexCount)
+{
+	if (isRecording())
+		return false;
+
+	RenderCommand const command(makeCommand(type));
+	beginCommand(command, indices ? indexCount : count);
+	executeBatch(type, elements, count, indices, indexCount);
+	return true;
+}
+
+/*!
+ * @param	command		Draw call to execute on the current rendering target
+ * @param	clip		Clipping rectangle currently applied to the rendering
+ *						target (nullptr = none)
+ */
+void Renderer::execute(RenderCommand const & command, SDL_Rect const * clip)
+{
+	SDL_Renderer * renderer(_renderer.get());
+
+	beginCommand(command,
+		command.points.size() + command.rects.size() +
+		(command.indices.empty() ?
+			command.vertices.size() :
+			command.indices.size()));
+
+	switch (command.type)
+	{
+		case RenderCommand::CLEAR:
+			// SDL_RenderClear() ignores clipping : overwrite clip area instead
+			if (clip ?
+				SDL_RenderFillRect(renderer, clip) :
+				SDL_RenderClear(renderer))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot clear renderer : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		case RenderCommand::FILL:
+			if (SDL_RenderFillRect(renderer, nullptr))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot fill renderer canvas : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		case RenderCommand::FILL_RECT:
+			if (SDL_RenderFillRect(renderer, &command.destination))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot fill rectangle : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		case RenderCommand::DRAW_RECT:
+			if (SDL_RenderDrawRect(renderer, &command.destination))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot draw rectangle : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		case RenderCommand::DRAW_LINE:
+			if (SDL_RenderDrawLine(renderer,
+				command.start.x, command.start.y,
+				command.end.x, command.end.y))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot draw line : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		case RenderCommand::DRAW_POINTS:
+		case RenderCommand::DRAW_LINES:
+			executeBatch(command.type,
+				command.points.data(),
+				command.points.size());
+		break;
+
+		case RenderCommand::DRAW_RECTS:
+		case RenderCommand::FILL_RECTS:
+			executeBatch(command.type,
+				command.rects.data(),
+				command.rects.size());
+		break;
+
+		case RenderCommand::GEOMETRY:
+			executeBatch(command.type,
+				command.vertices.data(),
+				command.vertices.size(),
+				command.indices.empty() ? nullptr : command.indices.data(),
+				command.indices.size());
+		break;
+
+		case RenderCommand::COPY:
+		case RenderCommand::COPY_EX:
+		{
+			// Partial redraw replays use the texture state recorded by
+			// submit(), then restore the current one
+			SDL_Color modulation{255, 255, 255, 255};
+			SDL_BlendMode blendMode(SDL_BLENDMODE_NONE);
+			bool const swapped(clip != nullptr && swapTextureState(
+				command.texture,
+				command.modulation,
+				command.blendMode,
+				modulation,
+				blendMode));
+
+			if ((command.type == RenderCommand::COPY ?
+				SDL_RenderCopy(renderer,
+					command.texture, &command.source, &command.destination) :
+				SDL_RenderCopyEx(renderer,
+					command.texture, &command.source, &command.destination,
+					command.angle, &command.center, command.flip)))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot copy texture %p : SDL error '%s'",
+					command.texture,
+					SDL_GetError());
+
+			if (swapped)
+			{
+				SDL_Color recordedModulation;
+				SDL_BlendMode recordedBlendMode;
+				swapTextureState(command.texture,
+					modulation, blendMode,
+					recordedModulation, recordedBlendMode);
+			}
+		}
+		break;
+
+		case RenderCommand::TEXT:
+			// Never let font errors escape (e.g. to the render thread)
+			try
+			{
+				std::lock_guard<std::mutex> lock(_textMutex);
+				command.font->queueLayout(
+					command.layout ? *command.layout : getTextLayout(command),
+					command.color,
+					command.destination.x,
+					command.destination.y);
+			}
+			catch (std::exception const & exc)
+			{
+				EXCEPT(exc);
+			}
+			_pendingTextAtlas = command.font->getAtlas();
+		break;
+
+		case RenderCommand::FONT_DEBUG:
+		{
+			std::lock_guard<std::mutex> lock(_textMutex);
+			Uint32 const outlines((Uint32)command.font->renderDebug(
+				command.destination.x,
+				command.destination.y));
+
+			// One copy per page, then one rectangle per glyph area
+			GlyphAtlas * atlas(command.font->getAtlas());
+			for (std::size_t page(0) ; page < atlas->getPageCount() ; ++page)
+			{
+				SDL_Texture const * texture(atlas->getPage(page)->getSDLTexture());
+				if (texture != _lastTexture)
+					++_renderStats.textureSwitches;
+				_lastTexture = texture;
+			}
+			_renderStats.drawCalls += (Uint32)atlas->getPageCount() + outlines;
+			_renderStats.primitives += (Uint32)atlas->getPageCount() + outlines;
+		}
+		break;
+
+		case RenderCommand::SET_LOGICAL_SIZE:
+			if (SDL_RenderSetLogicalSize(renderer,
+				command.destination.w,
+				command.destination.h))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot set renderer logical size : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		case RenderCommand::SET_VIEWPORT:
+			if (SDL_RenderSetViewport(renderer, &command.destination))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot set renderer viewport : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		case RenderCommand::RESET_VIEWPORT:
+			if (SDL_RenderSetViewport(renderer, nullptr))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot reset renderer viewport : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		case RenderCommand::SET_SCALE:
+			if (SDL_RenderSetScale(renderer, command.scale.x, command.scale.y))
+				ERROR(SDL_LOG_CATEGORY_ERROR,
+					"Cannot set renderer scale : SDL error '%s'",
+					SDL_GetError());
+		break;
+
+		case RenderCommand::TASK:
+			// Never let task errors escape (e.g. to the render thread)
+			try
+			{
+				command.task();
+			}
+			catch (std::exception const & exc)
+			{
+				EXCEPT(exc);
+			}
+		break;
+	}
+}
+
+/*!
+ * Texture switches compare the SDL_Texture actually bound by each draw call.
+ * Text & font debug draw calls are counted when issued, from the atlas pages
+ * they actually read (see flushText() & execute()).
+ *
+ * @param	command		Draw call about to be executed
+ * @param	batchSize	Number of points, rectangles or (indexed) vertices of
+ *						a primitive batch, ignored otherwise
+ */
+void Renderer::countCommand(
+	RenderCommand const & command,
+	std::size_t const batchSize)
+{
+	SDL_Texture const * texture(nullptr);
+
+	switch (command.type)
+	{
+		case RenderCommand::CLEAR:
+		case RenderCommand::FILL:
+		case RenderCommand::FILL_RECT:
+		case RenderCommand::DRAW_RECT:
+		case RenderCommand::DRAW_LINE:
+			_renderStats.drawCalls += 1;
+			_renderStats.primitives += 1;
+		break;
+		case RenderCommand::DRAW_POINTS:
+			_renderStats.drawCalls += 1;
+			_renderStats.primitives += (Uint32)batchSize;
+		break;
+		case RenderCommand::DRAW_LINES:
+			_renderStats.drawCalls += 1;
+			if (batchSize > 1)
+				_renderStats.primitives += (Uint32)batchSize - 1;
+		break;
+		case RenderCommand::DRAW_RECTS:
+		case RenderCommand::FILL_RECTS:
+			_renderStats.drawCalls += 1;
+			_renderStats.primitives += (Uint32)batchSize;
+		break;
+		case RenderCommand::GEOMETRY:
+			_renderStats.drawCalls += 1;
+			_renderStats.primitives += (Uint32)batchSize / 3;
+		break;
+		case RenderCommand::COPY:
+		case RenderCommand::COPY_EX:
+			_renderStats.drawCalls += 1;
+			_renderStats.primitives += 1;
+			texture = command.texture;
+		break;
+		case RenderCommand::TEXT:
+		case RenderCommand::FONT_DEBUG:
+			// Counted once drawn
+			return;
+		case RenderCommand::SET_LOGICAL_SIZE:
+		case RenderCommand::SET_VIEWPORT:
+		case RenderCommand::RESET_VIEWPORT:
+		case RenderCommand::SET_SCALE:
+			// State changes draw nothing
+			return;
+		case RenderCommand::TASK:
+			// Tasks count their own work
+			return;
+	}
+
+	// Textured draw calls : count texture switches
+	if (texture != nullptr)
+	{
+		if (texture != _lastTexture)
+			++_renderStats.textureSwitches;
+		_lastTexture = texture;
+	}
+	// Primitives : count blend mode changes
+	else if (command.type != RenderCommand::CLEAR)
+	{
+		if (command.blendMode != _lastBlendMode)
+			++_renderStats.blendChanges;
+		_lastBlendMode = command.blendMode;
+	}
+}
+
+/*!
+ * Each baked chunk switches the rendering target there and back, and reads
+ * from the tileset texture.
+ *
+ * @param	bakes	TileMap chunk bakes since last counted
+ */
+void Renderer::countBakes(TileMap::BakeStats const & bakes)
+{
+	if (bakes.chunks == 0)
+		return;
+
+	auto count = [this, bakes] (void) {
+		_renderStats.drawCalls += bakes.drawCalls;
+		_renderStats.primitives += bakes.drawCalls;
+		_renderStats.targetSwitches += 2 * bakes.chunks;
+		_renderStats.textureSwitches += bakes.chunks;
+	};
+
+	// Render thread mode : counted by the render thread, after the bakes
+	if (_renderThread.joinable())
+	{
+		recordTask(count);
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	count();
+}
+
+/*!
+ * @param	bytes	Number of bytes uploaded to a texture
+ */
+void Renderer::countUpload(std::size_t const bytes)
+{
+	++_renderStats.uploads;
+	_renderStats.uploadedBytes += bytes;
+}
+
+/*!
+ * Must be called before any rendering state change (target, clipping,
+ * viewport, scale) and before presenting. Counts one draw call per atlas page
+ * drawn and one primitive per glyph quad.
+ */
+void Renderer::flushText(void)
+{
+	if (_pendingTextAtlas == nullptr)
+		return;
+
+	GlyphAtlas::FlushStats const stats(_pendingTextAtlas->flush());
+	_pendingTextAtlas = nullptr;
+	if (stats.drawCalls == 0)
+		return;
+
+	// Pages drawn by a single flush are distinct textures
+	_renderStats.drawCalls += stats.drawCalls;
+	_renderStats.primitives += stats.quads;
+	_renderStats.textureSwitches += stats.drawCalls - 1;
+	if (stats.firstTexture != _lastTexture)
+		++_renderStats.textureSwitches;
+	_lastTexture = stats.lastTexture;
+}
+
+/*!
+ * In partial redraw mode, draw calls are recorded into a command list instead
+ * of being executed right away. At present(), this list is matched in order
+ * with the previous frame's one by content (including source texture
+ * modulation) : every draw call left unmatched on either side damages its
+ * bounds. Damaged regions are then merged, and only the draw calls
+ * intersecting them are replayed, clipped to each region, onto a persistent
+ * canvas Texture. The canvas is finally stretched onto the rendering space
+ * with a single copy.
+ *
+ * Draw calls use canvas coordinates ; renderer scale does not apply to them.
+ * Textures whose contents change without being re-submitted differently must
+ * be reported through invalidateRegion() or invalidateCanvas().
+ *
+ * @param	width		Canvas width
+ * @param	height		Canvas height
+ * @throws	Exception	Invalid input parameters or SDL call error
+ */
+void Renderer::enablePartialRedraw(int const width, int const height)
+{
+	// Check state
+	if (_renderThread.joinable())
+		THROW(Exception, "Cannot enable partial redraw with a render thread");
+	if (_scaledTarget)
+		THROW(Exception, "Cannot enable partial redraw with a scaled target");
+
+	// Attempt canvas instantiation (may throw)
+	_canvas = std::unique_ptr<Texture>(new Texture(
+		Texture::fromScratch(
+			_renderer.get(),
+			SDL_PIXELFORMAT_RGBA32,
+			SDL_TEXTUREACCESS_TARGET,
+			width,
+			height)));
+
+	// The canvas is opaque : overwrite the screen when compositing
+	_canvas->setBlendMode(SDL_BLENDMODE_NONE);
+
+	// Start from scratch
+	_commands.clear();
+	_previousCommands.clear();
+	_previousCommandHashes.clear();
+	_damage.clear();
+	_lastDamage.clear();
+	invalidateCanvas();
+
+	DEBUG(SDL_LOG_CATEGORY_APPLICATION,
+		"Enable partial redraw on Renderer %p (%dx%d canvas)",
+		this,
+		width,
+		height);
+}
+
+void Renderer::disablePartialRedraw(void)
+{
+	// Flush pending draw calls before leaving partial redraw mode
+	if (_canvas)
+		presentCanvas();
+
+	_canvas.reset();
+	_commands.clear();
+	_previousCommands.clear();
+	_previousCommandHashes.clear();
+	_damage.clear();
+	_lastDamage.clear();
+}
+
+bool Renderer::isPartialRedrawEnabled(void) const
+{
+	return (_canvas != nullptr);
+}
+
+/*!
+ * @param	region	Canvas region to redraw at next present()
+ */
+void Renderer::invalidateRegion(SDL_Rect const & region)
+{
+	if (_canvas)
+		addDamage(region);
+}
+
+void Renderer::invalidateCanvas(void)
+{
+	if (_canvas)
+		addDamage(SDL_Rect{0, 0, _canvas->getWidth(), _canvas->getHeight()});
+}
+
+std::vector<SDL_Rect> const & Renderer::getLastDamage(void) const
+{
+	return _lastDamage;
+}
+
+/*!
+ * @returns		Copy culling counters of the last presented frame
+ */
+Renderer::CullingStats Renderer::getCullingStats(void) const
+{
+	return _lastCullingStats;
+}
+
+/*!
+ * @returns		Rendering counters of the last presented frame
+ */
+Renderer::RenderStats Renderer::getRenderStats(void) const
+{
+	std::lock_guard<std::mutex> lock(_statsMutex);
+	return _lastRenderStats;
+}
+
+/*!
+ * Every draw call is rendered into a width x height target Texture, which is
+ * upscaled onto the screen with a single nearest-neighbour copy at present()
+ * time. Fill rate then depends on the target size, not on the window size.
+ *
+ * Draw calls use target coordinates ; logical size & viewport settings only
+ * apply to the final copy. The destination area is centered and recomputed
+ * at every present(), so window resizes need no special handling.
+ *
+ * @param	width			Target width
+ * @param	height			Target height
+ * @param	integerScaling	Upscale by the largest integer factor fitting the
+ *							screen (pixel-perfect), instead of the largest
+ *							ratio-preserving size
+ * @throws	Exception		Invalid state or SDL call error
+ */
+void Renderer::enableScaledTarget(
+	int const width,
+	int const height,
+	bool const integerScaling)
+{
+	// Check state
+	if (_canvas)
+		THROW(Exception, "Cannot enable a scaled target in partial redraw mode");
+
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	flushText();
+	_integerScaling = integerScaling;
+
+	// Keep current target if dimensions match
+	if (_scaledTarget &&
+		_scaledTarget->getWidth() == width &&
+		_scaledTarget->getHeight() == height)
+		return;
+
+	// Attempt target instantiation (may throw)
+	std::unique_ptr<Texture> target(new Texture(
+		Texture::fromScratch(
+			_renderer.get(),
+			SDL_PIXELFORMAT_RGBA32,
+			SDL_TEXTUREACCESS_TARGET,
+			width,
+			height)));
+	target->setBlendMode(SDL_BLENDMODE_NONE);
+
+	_scaledTarget = std::move(target);
+	applyScaledTargetFilter();
+	bindScaledTarget();
+	if (_renderThread.joinable())
+	{
+		std::lock_guard<std::mutex> frameLock(_frameMutex);
+		_renderThreadViewport = SDL_Rect{0, 0, width, height};
+	}
+
+	DEBUG(SDL_LOG_CATEGORY_APPLICATION,
+		"Enable scaled target on Renderer %p (%dx%d, %s scaling)",
+		this,
+		width,
+		height,
+		integerScaling ? "integer" : "nearest");
+}
 
-	// Rendering attempt
-	if (SDL_RenderCopy(_renderer.get(), sdlTexture, clip, &destination))
+void Renderer::disableScaledTarget(void)
+{
+	if (!_scaledTarget)
+		return;
+
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	flushText();
+
+	// Keep draw calls executed since last present() : composite them onto the
+	// screen, where next draw calls go (recorded frames are not executed yet)
+	if (!_renderThread.joinable())
+		presentScaledTarget();
+	else if (SDL_SetRenderTarget(_renderer.get(), nullptr))
 		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot copy texture '%s' with clip '%s' : SDL error '%s'",
-			textureName.c_str(),
-			clipName.c_str(),
+			"Cannot restore rendering target : SDL error '%s'",
 			SDL_GetError());
+	else
+	{
+		SDL_Rect viewport{0, 0, 0, 0};
+		SDL_RenderGetViewport(_renderer.get(), &viewport);
+		std::lock_guard<std::mutex> frameLock(_frameMutex);
+		_renderThreadViewport = SDL_Rect{0, 0, viewport.w, viewport.h};
+	}
+	_scaledTarget.reset();
+}
+
+bool Renderer::isScaledTargetEnabled(void) const
+{
+	return (_scaledTarget != nullptr);
 }
 
 /*!
- * @param	textureName		Name of the Texture to copy on rendering space
- * @param	clipName		Name of the clipping rectangle to use ("" = entire
- *							Texture)
- * @param	destination		Destination rectangle for the rendering
- * @param	angle			Angle of rotation in degrees (0 = no rotation)
- * @param	center			Center of rotation
- * @param	flip			SDL flip flag
- * @throws	Exception		Invalid input parameters or SDL call error
+ * @returns		Screen rectangle (in rendering space coordinates) the scaled
+ *				target was copied to during last present()
+ */
+SDL_Rect Renderer::getScaledTargetDestination(void) const
+{
+	return _scaledTargetDestination;
+}
+
+/*!
+ * Below 1, draw calls of the scaled target mode are rendered into the
+ * top-left part of the target only (fill rate scales with scale squared),
+ * then upscaled with linear filtering. Draw calls keep using target
+ * coordinates.
  *
- * @todo	Add 1:1 version
+ * @param	scale		Fraction of the target resolution to render at
+ * @throws	Exception	Invalid input parameters
  */
-void Renderer::copyEx(
-	std::string const & textureName,
-	std::string const & clipName,
-	SDL_Rect const & destination,
-	double const angle,
-	SDL_Point const & center,
-	SDL_RendererFlip const & flip)
+void Renderer::setRenderScale(float const scale)
+{
+	// Check input parameters
+	if (!(scale > 0.0f && scale <= 1.0f))
+		THROW(Exception, "Received 'scale' out of ]0, 1] range");
+
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	if (scale == _renderScale)
+		return;
+
+	_renderScale = scale;
+	if (_scaledTarget)
+	{
+		applyScaledTargetFilter();
+		if (SDL_GetRenderTarget(_renderer.get()) == _scaledTarget->getSDLTexture())
+			SDL_RenderSetScale(_renderer.get(), _renderScale, _renderScale);
+	}
+}
+
+float Renderer::getRenderScale(void) const
+{
+	return _renderScale;
+}
+
+/*!
+ * @param	space	Rendering space size (viewport) to fit the target into
+ * @returns			Destination rectangle for the scaled target
+ */
+SDL_Rect Renderer::computeScaledTargetDestination(SDL_Rect const & space) const
+{
+	SDL_Rect destination{0, 0, 0, 0};
+	int const outputWidth(space.w);
+	int const outputHeight(space.h);
+
+	int const width(_scaledTarget->getWidth());
+	int const height(_scaledTarget->getHeight());
+	if (_integerScaling &&
+		outputWidth >= width &&
+		outputHeight >= height)
+	{
+		int const factor(std::min(outputWidth / width, outputHeight / height));
+		destination.w = width * factor;
+		destination.h = height * factor;
+	}
+	else if (outputWidth * height <= outputHeight * width)
+	{
+		// Output is narrower than the target : fit width
+		destination.w = outputWidth;
+		destination.h = height * outputWidth / width;
+	}
+	else
+	{
+		destination.w = width * outputHeight / height;
+		destination.h = outputHeight;
+	}
+	destination.x = (outputWidth - destination.w) / 2;
+	destination.y = (outputHeight - destination.h) / 2;
+
+	return destination;
+}
+
+void Renderer::bindScaledTarget(void)
+{
+	if (!_scaledTarget)
+		return;
+
+	if (SDL_SetRenderTarget(_renderer.get(), _scaledTarget->getSDLTexture()))
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot target scaled target texture : SDL error '%s'",
+			SDL_GetError());
+	else
+		SDL_RenderSetScale(_renderer.get(), _renderScale, _renderScale);
+}
+
+/*!
+ * Full resolution targets are upscaled pixel-perfect, reduced ones smoothly
+ */
+void Renderer::applyScaledTargetFilter(void)
+{
+	SDL_ScaleMode const scaleMode(_renderScale < 1.0f ?
+		SDL_ScaleModeLinear :
+		SDL_ScaleModeNearest);
+
+	if (SDL_SetTextureScaleMode(_scaledTarget->getSDLTexture(), scaleMode))
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot set scaled target scale mode : SDL error '%s'",
+			SDL_GetError());
+}
+
+/*!
+ * @todo	Handle errors
+ */
+void Renderer::presentScaledTarget(void)
 {
-	// Texture lookup
-	auto textureIterator = _textures.find(textureName);
-	if (textureIterator == _textures.end())
+	SDL_Renderer * renderer(_renderer.get());
+	flushText();
+
+	// Back to the screen (viewport & logical size are restored by SDL)
+	if (SDL_SetRenderTarget(renderer, nullptr))
 	{
 		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot copy texture '%s' : not found in _textures",
-			textureName.c_str());
+			"Cannot restore rendering target : SDL error '%s'",
+			SDL_GetError());
 		return;
 	}
+	_renderStats.targetSwitches += 2;
 
-	// Clip lookup
-	SDL_Rect * clip = textureIterator->second.getClip(clipName);
-	if (!clip)
-	{
+	// Rendered part of the target, fitted into the rendering space
+	SDL_Rect space{0, 0, 0, 0};
+	SDL_RenderGetViewport(renderer, &space);
+	SDL_Rect const source{0, 0,
+		std::min(_scaledTarget->getWidth(),
+			(int)SDL_ceilf(_scaledTarget->getWidth() * _renderScale)),
+		std::min(_scaledTarget->getHeight(),
+			(int)SDL_ceilf(_scaledTarget->getHeight() * _renderScale))};
+	_scaledTargetDestination = computeScaledTargetDestination(space);
+
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+	SDL_RenderClear(renderer);
+	if (SDL_RenderCopy(renderer,
+		_scaledTarget->getSDLTexture(),
+		&source,
+		&_scaledTargetDestination))
 		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"No clip '%s' on texture '%s'",
-			clipName.c_str(),
-			textureName.c_str());
+			"Cannot copy scaled target : SDL error '%s'",
+			SDL_GetError());
+	_renderStats.drawCalls += 2;
+	_renderStats.primitives += 2;
+	_lastTexture = _scaledTarget->getSDLTexture();
+}
+
+/*!
+ * @param	region	Canvas region to redraw (cropped to canvas bounds)
+ */
+void Renderer::addDamage(SDL_Rect const & region)
+{
+	SDL_Rect const canvas{0, 0, _canvas->getWidth(), _canvas->getHeight()};
+	SDL_Rect cropped;
+
+	if (SDL_IntersectRect(&region, &canvas, &cropped))
+		_damage.push_back(cropped);
+}
+
+/*!
+ * Two regions are merged when they overlap, or when their bounding rectangle
+ * is not bigger than their summed areas. Past MAX_DAMAGE_REGIONS regions, all
+ * of them are merged into their bounding rectangle.
+ */
+void Renderer::mergeDamage(void)
+{
+	if (_damage.size() > MAX_DAMAGE_REGIONS)
+	{
+		SDL_Rect bounds(_damage.front());
+		for (SDL_Rect const & region : _damage)
+			SDL_UnionRect(&bounds, &region, &bounds);
+
+		_damage.assign(1, bounds);
 		return;
 	}
 
-	SDL_Texture * sdlTexture = textureIterator->second.getSDLTexture();
+	bool merged(true);
+	while (merged)
+	{
+		merged = false;
+		for (std::size_t i(0) ; i < _damage.size() && !merged ; ++i)
+			for (std::size_t j(i + 1) ; j < _damage.size() && !merged ; ++j)
+			{
+				SDL_Rect & a(_damage[i]);
+				SDL_Rect & b(_damage[j]);
+				SDL_Rect bounds;
+				SDL_UnionRect(&a, &b, &bounds);
 
-	// Rendering attempt
-	if (SDL_RenderCopyEx(_renderer.get(),
-		sdlTexture, clip, &destination,
-		angle, &center, flip))
+				if (SDL_HasIntersection(&a, &b) ||
+					bounds.w * bounds.h <= a.w * a.h + b.w * b.h)
+				{
+					a = bounds;
+					_damage.erase(_damage.begin() + j);
+					merged = true;
+				}
+			}
+	}
+}
+
+/*!
+ * @todo	Handle errors
+ */
+void Renderer::presentCanvas(void)
+{
+	SDL_Renderer * renderer(_renderer.get());
+
+	// Match every draw call with an identical one of last frame, in drawing
+	// order : unmatched draw calls (new, changed, reordered or gone) damage
+	// their bounds, so that inserting a draw call only damages its own area
+	std::vector<bool> matched(_previousCommands.size(), false);
+	std::size_t next(0);
+	_commandHashes.clear();
+	for (std::size_t index(0) ; index < _commands.size() ; ++index)
+	{
+		RenderCommand const & command(_commands[index]);
+		std::size_t const hash(command.hash());
+		_commandHashes.emplace_back(hash, index);
+
+		auto candidate(std::lower_bound(
+			_previousCommandHashes.begin(),
+			_previousCommandHashes.end(),
+			std::make_pair(hash, next)));
+		for ( ;
+			candidate != _previousCommandHashes.end() &&
+			candidate->first == hash ;
+			++candidate)
+			if (_previousCommands[candidate->second] == command)
+				break;
+
+		if (candidate != _previousCommandHashes.end() &&
+			candidate->first == hash)
+		{
+			matched[candidate->second] = true;
+			next = candidate->second + 1;
+		}
+		else
+			addDamage(command.bounds);
+	}
+	for (std::size_t index(0) ; index < _previousCommands.size() ; ++index)
+		if (!matched[index])
+			addDamage(_previousCommands[index].bounds);
+	std::sort(_commandHashes.begin(), _commandHashes.end());
+
+	mergeDamage();
+
+	// Replay intersecting draw calls, clipped to each damaged region
+	if (!_damage.empty())
+	{
+		if (SDL_SetRenderTarget(renderer, _canvas->getSDLTexture()))
+			ERROR(SDL_LOG_CATEGORY_ERROR,
+				"Cannot target canvas texture : SDL error '%s'",
+				SDL_GetError());
+		else
+		{
+			_renderStats.targetSwitches += 2;
+			for (SDL_Rect const & region : _damage)
+			{
+				SDL_RenderSetClipRect(renderer, &region);
+				for (RenderCommand const & command : _commands)
+					if (SDL_HasIntersection(&command.bounds, &region))
+						execute(command, &region);
+				flushText();
+			}
+
+			SDL_RenderSetClipRect(renderer, nullptr);
+			SDL_SetRenderTarget(renderer, nullptr);
+		}
+	}
+
+	// Composite canvas onto the (viewport-restored) rendering space
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+	SDL_RenderClear(renderer);
+	if (SDL_RenderCopy(renderer, _canvas->getSDLTexture(), nullptr, nullptr))
 		ERROR(SDL_LOG_CATEGORY_ERROR,
-			"Cannot copy texture '%s' with clip '%s' : SDL error '%s'",
-			textureName.c_str(),
-			clipName.c_str(),
+			"Cannot copy canvas : SDL error '%s'",
 			SDL_GetError());
+	_renderStats.drawCalls += 2;
+	_renderStats.primitives += 2;
+	_lastTexture = _canvas->getSDLTexture();
+
+	// Prepare next frame
+	_lastDamage.swap(_damage);
+	_damage.clear();
+	_previousCommands.swap(_commands);
+	_previousCommandHashes.swap(_commandHashes);
+	_commands.clear();
 }
 
 /*!
+ * In render thread mode, the frame is handed over to the render thread and
+ * this call returns right away : it never waits for SDL_RenderPresent().
+ *
  * @todo	Handle errors
  */
 void Renderer::present(void)
 {
-	SDL_RenderPresent(_renderer.get());
-}
\ No newline at end of file
+	if (_renderThread.joinable())
+		queueFrame();
+
+	// Publish & reset per-frame counters
+	_lastCullingStats = _cullingStats;
+	_cullingStats = CullingStats{0, 0};
+
+	if (!_renderThread.joinable())
+	{
+		std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+		flushText();
+		if (_canvas)
+			presentCanvas();
+		else if (_scaledTarget)
+			presentScaledTarget();
+		trimTextLayouts();
+		publishRenderStats();
+		captureFrame(_frame);
+		SDL_RenderPresent(_renderer.get());
+		bindScaledTarget();
+	}
+
+	// Drawing is over for this frame : run queued uploads & evict unused
+	// textures if needed
+	processUploads();
+	enforceTextureBudget();
+	++_frame;
+
+	// Next frame starts rendering now (render thread : when executed)
+	if (!_renderThread.joinable())
+		_renderStartTicks = SDL_GetPerformanceCounter();
+}
+
+/*!
+ * Must be called right before SDL_RenderPresent() : batched draw calls are
+ * flushed to the driver first, so that their cost is not left to presentation
+ * and is included in the measured rendering time.
+ */
+void Renderer::publishRenderStats(void)
+{
+	if (SDL_RenderFlush(_renderer.get()))
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot flush renderer : SDL error '%s'",
+			SDL_GetError());
+	_renderStats.renderMilliseconds =
+		(float)(SDL_GetPerformanceCounter() - _renderStartTicks) * 1000.0f
+		/ (float)SDL_GetPerformanceFrequency();
+
+	std::lock_guard<std::mutex> lock(_statsMutex);
+	_lastRenderStats = _renderStats;
+	_renderStats = RenderStats{0, 0, 0, 0, 0, 0, 0, 0.0f};
+}
+
+/*!
+ * @returns		Index following the last frame executed by the render thread
+ *				(render thread mode), or following the current frame
+ */
+Uint32 Renderer::getCompletedFrames(void) const
+{
+	if (_renderThread.joinable())
+		return _completedFrames;
+	else
+		return (_frame + 1);
+}
+
+/*!
+ * The render thread always executes the latest presented frame : a frame it
+ * did not take yet is replaced (and counted as dropped) instead of making the
+ * game thread wait. State changes & tasks of a replaced frame are kept, ahead
+ * of the new frame's commands, so that they are never lost.
+ */
+void Renderer::queueFrame(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(_frameMutex);
+		if (_frameQueued)
+		{
+			++_droppedFrames;
+			_queuedCommands.erase(
+				std::remove_if(_queuedCommands.begin(), _queuedCommands.end(),
+					[](RenderCommand const & command) {
+						return !command.isPersistent();
+					}),
+				_queuedCommands.end());
+			_queuedCommands.insert(_queuedCommands.end(),
+				std::make_move_iterator(_commands.begin()),
+				std::make_move_iterator(_commands.end()));
+		}
+		else
+			_queuedCommands.swap(_commands);
+		_queuedFrame = _frame;
+		_frameQueued = true;
+
+		// Measured viewport predates recorded state changes : do not cull
+		_visibleArea = (_completedFrames > _stateChangeFrame ?
+			_renderThreadViewport :
+			UNCULLED_AREA);
+	}
+	_frameCondition.notify_all();
+
+	// Recycle replaced storage for next frame
+	_commands.clear();
+}
+
+void Renderer::renderLoop(void)
+{
+	for (;;)
+	{
+		Uint32 frame(0);
+
+		// Wait for a frame (pending frame is executed before exiting)
+		{
+			std::unique_lock<std::mutex> lock(_frameMutex);
+			_frameCondition.wait(lock, [this] {
+				return (_frameQueued || _renderThreadStopping);
+			});
+			if (!_frameQueued)
+				return;
+
+			_executedCommands.swap(_queuedCommands);
+			frame = _queuedFrame;
+			_frameQueued = false;
+		}
+
+		// Execute & present
+		SDL_Rect viewport{0, 0, 0, 0};
+		{
+			std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+			_renderStartTicks = SDL_GetPerformanceCounter();
+			for (RenderCommand const & command : _executedCommands)
+				execute(command, nullptr);
+			flushText();
+			trimTextLayouts();
+			if (_scaledTarget)
+				presentScaledTarget();
+			publishRenderStats();
+			captureFrame(frame);
+			SDL_RenderPresent(_renderer.get());
+			bindScaledTarget();
+			SDL_RenderGetViewport(_renderer.get(), &viewport);
+		}
+
+		// Signal completion (fence)
+		{
+			std::lock_guard<std::mutex> lock(_frameMutex);
+			_renderThreadViewport = SDL_Rect{0, 0, viewport.w, viewport.h};
+			_completedFrames = frame + 1;
+		}
+		_frameCondition.notify_all();
+	}
+}
+
+/*!
+ * Draw calls are then recorded, and executed by a dedicated thread when the
+ * frame is presented ; the game thread records frame N+1 while frame N is
+ * executed. Viewport, logical size & scale changes are recorded along with
+ * draw calls, and so are streaming texture commits, Layer repaints, TileMap
+ * chunk bakes & scheduled Texture creations, as tasks the render thread runs in
+ * order with them : the game thread never waits for a frame being presented.
+ * Other SDL_Renderer accesses (immediate Texture creation, first allocation of
+ * a TileMap chunk, font baking...) are serialized with the render thread and
+ * preserve its rendering state.
+ * Direct SDL calls on Renderer objects (e.g. Texture modulation) must be
+ * guarded with lockRenderer().
+ *
+ * OpenGL contexts cannot be shared between threads on most platforms : this
+ * mode is meant for Direct3D, Metal or software renderers.
+ *
+ * @throws	Exception	Partial redraw mode is enabled
+ */
+void Renderer::enableRenderThread(void)
+{
+	// Check state
+	if (_renderThread.joinable())
+		return;
+	if (_canvas)
+		THROW(Exception, "Cannot enable a render thread in partial redraw mode");
+
+	SDL_RendererInfo info;
+	if (SDL_GetRendererInfo(_renderer.get(), &info) == 0 &&
+		SDL_strncmp(info.name, "opengl", 6) == 0)
+		WARNING(SDL_LOG_CATEGORY_RENDER,
+			"Render thread enabled on '%s' renderer : context may not be "
+				"usable from several threads",
+			info.name);
+
+	// Initial culling area
+	SDL_Rect viewport{0, 0, 0, 0};
+	SDL_RenderGetViewport(_renderer.get(), &viewport);
+	_visibleArea = SDL_Rect{0, 0, viewport.w, viewport.h};
+	_renderThreadViewport = _visibleArea;
+	_stateChangeFrame = 0;
+
+	_frameQueued = false;
+	_renderThreadStopping = false;
+	_completedFrames = _frame;
+	_renderThread = std::thread(&Renderer::renderLoop, this);
+
+	DEBUG(SDL_LOG_CATEGORY_APPLICATION,
+		"Enable render thread on Renderer %p",
+		this);
+}
+
+void Renderer::disableRenderThread(void)
+{
+	if (!_renderThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(_frameMutex);
+		_renderThreadStopping = true;
+	}
+	_frameCondition.notify_all();
+	_renderThread.join();
+
+	// Execute draw calls recorded since last present()
+	for (RenderCommand const & command : _commands)
+		execute(command, nullptr);
+	flushText();
+	_commands.clear();
+	_queuedCommands.clear();
+	_executedCommands.clear();
+}
+
+bool Renderer::isRenderThreadEnabled(void) const
+{
+	return _renderThread.joinable();
+}
+
+Uint32 Renderer::getFrameIndex(void) const
+{
+	return _frame;
+}
+
+/*!
+ * @param	frame	Index of a presented frame (see getFrameIndex())
+ * @returns			Whether the frame, or a later one, was executed
+ */
+bool Renderer::isFrameComplete(Uint32 const frame) const
+{
+	return (frame < getCompletedFrames());
+}
+
+void Renderer::finish(void)
+{
+	std::unique_lock<std::mutex> lock(_frameMutex);
+	_frameCondition.wait(lock, [this] {
+		return (!_renderThread.joinable() || _completedFrames >= _frame);
+	});
+}
+
+Uint32 Renderer::getDroppedFrames(void) const
+{
+	return _droppedFrames;
+}
+
+/*!
+ * Batched text glyphs are drawn first, so that direct SDL calls keep their
+ * place in the drawing order.
+ *
+ * @returns		A lock on the SDL_Renderer, held until destroyed
+ */
+std::unique_lock<std::recursive_mutex> Renderer::lockRenderer(void)
+{
+	std::unique_lock<std::recursive_mutex> lock(_sdlMutex);
+	flushText();
+	return lock;
+}
+
+/*!
+ * Called with the default rendering target bound, right before
+ * SDL_RenderPresent() (back buffer contents are undefined afterwards).
+ *
+ * @param	frame	Index of the frame being presented
+ */
+void Renderer::captureFrame(Uint32 const frame)
+{
+	bool const continuous(_captureInterval && frame % _captureInterval == 0);
+	if (_screenshotPath.empty() && !continuous)
+		return;
+
+	if (!_frameCapture)
+		_frameCapture = std::unique_ptr<FrameCapture>(
+			new FrameCapture(MAX_PENDING_CAPTURES));
+
+	if (!_screenshotPath.empty())
+	{
+		_frameCapture->capture(_renderer.get(),
+			_screenshotPath,
+			FrameCapture::formatFromPath(_screenshotPath));
+		_screenshotPath.clear();
+	}
+	if (continuous)
+	{
+		char index[16];
+		SDL_snprintf(index, sizeof(index), "%06u", (unsigned int)frame);
+		_frameCapture->capture(_renderer.get(),
+			_capturePrefix + index
+				+ (_captureFormat == FrameCapture::QOI ? ".qoi" : ".png"),
+			_captureFormat);
+	}
+}
+
+/*!
+ * Readback happens while presenting ; encoding & writing happen on a
+ * background thread.
+ *
+ * @param	path		Destination file (".qoi" for QOI, PNG otherwise)
+ * @throws	Exception	Invalid input parameters
+ */
+void Renderer::captureScreenshot(std::string const & path)
+{
+	// Check input parameters
+	if (path.empty())
+		THROW(Exception, "Received empty 'path'");
+
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	_screenshotPath = path;
+}
+
+/*!
+ * Frames whose index (see getFrameIndex()) is a multiple of 'interval' are
+ * saved as "<prefix><6-digit frame index>.<png|qoi>", e.g. for visual
+ * regression tests. Frames are dropped (with a warning) rather than stalling
+ * the renderer when encoding cannot keep up.
+ *
+ * @param	prefix		Path & file name prefix
+ * @param	interval	Save one frame every 'interval' frames
+ * @param	format		Image file format
+ * @throws	Exception	Invalid input parameters
+ */
+void Renderer::startFrameCapture(
+	std::string const & prefix,
+	Uint32 const interval,
+	FrameCapture::Format const format)
+{
+	// Check input parameters
+	if (interval == 0)
+		THROW(Exception, "Received 'interval' == 0");
+
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	_capturePrefix = prefix;
+	_captureInterval = interval;
+	_captureFormat = format;
+}
+
+void Renderer::stopFrameCapture(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(_sdlMutex);
+	_captureInterval = 0;
+}
+
+/*!
+ * In render thread mode, frames presented but not executed yet are not waited
+ * for (see finish()).
+ */
+void Renderer::flushCaptures(void)
+{
+	if (_frameCapture)
+		_frameCapture->flush();
+}
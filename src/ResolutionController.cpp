@@ -0,0 +1,168 @@
+#include <VBN/ResolutionController.hpp>
+#include <VBN/Window.hpp>
+#include <VBN/Renderer.hpp>
+#include <VBN/Logging.hpp>
+#include <VBN/Exceptions.hpp>
+#include <algorithm>
+
+//! Weight of the latest frame in the smoothed frame duration
+#define RESOLUTION_SMOOTHING 0.1f
+//! Downscale when smoothed frames take more than this fraction of the budget
+#define RESOLUTION_DOWN_THRESHOLD 0.95f
+//! Upscale when smoothed frames take less than this fraction of the budget
+#define RESOLUTION_UP_THRESHOLD 0.75f
+//! Consecutive slow frames before downscaling
+#define RESOLUTION_DOWN_FRAMES 5
+//! Consecutive fast frames before upscaling
+#define RESOLUTION_UP_FRAMES 60
+//! Render scale decrement
+#define RESOLUTION_DOWN_STEP 0.1f
+//! Render scale increment
+#define RESOLUTION_UP_STEP 0.05f
+
+/*!
+ * @param	window				Raw pointer to the Window to drive
+ * @param	targetMilliseconds	Frame duration budget
+ * @param	minScale			Lowest render scale allowed (]0, 1])
+ * @param	maxScale			Highest render scale allowed ([minScale, 1])
+ * @throws	Exception			Invalid input parameters
+ */
+ResolutionController::ResolutionController(
+	Window * window,
+	Uint32 const targetMilliseconds,
+	float const minScale,
+	float const maxScale) :
+	_window(window),
+	_targetMilliseconds(0),
+	_minScale(1.0f),
+	_maxScale(1.0f),
+	_averageMilliseconds(0.0f),
+	_slowFrames(0),
+	_fastFrames(0),
+	_completedFrames(0)
+{
+	// Check input parameters
+	if (!window)
+		THROW(Exception, "Received nullptr 'window'");
+
+	setTargetMilliseconds(targetMilliseconds);
+	setScaleRange(minScale, maxScale);
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Build ResolutionController %p (Window %p, %u ms)",
+		this,
+		window,
+		targetMilliseconds);
+}
+
+ResolutionController::~ResolutionController(void)
+{
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Delete ResolutionController %p",
+		this);
+}
+
+/*!
+ * Reads the rendering time of the last frame the Window's Renderer completed
+ * (presentation & vsync wait excluded, see Renderer::RenderStats) : a frame
+ * already accounted for is skipped.
+ */
+void ResolutionController::update(void)
+{
+	Renderer * renderer(_window->getRenderer());
+	Uint32 const completedFrames(renderer->getCompletedFrames());
+	if (completedFrames == _completedFrames)
+		return;
+	_completedFrames = completedFrames;
+	float const frameMilliseconds(
+		renderer->getRenderStats().renderMilliseconds);
+
+	// Smooth out isolated spikes
+	if (_averageMilliseconds == 0.0f)
+		_averageMilliseconds = frameMilliseconds;
+	else
+		_averageMilliseconds += RESOLUTION_SMOOTHING
+			* (frameMilliseconds - _averageMilliseconds);
+
+	// Count consecutive frames beyond each threshold
+	float const load(_averageMilliseconds / _targetMilliseconds);
+	_slowFrames = (load > RESOLUTION_DOWN_THRESHOLD) ? _slowFrames + 1 : 0;
+	_fastFrames = (load < RESOLUTION_UP_THRESHOLD) ? _fastFrames + 1 : 0;
+
+	float const scale(_window->getRenderScale());
+	float newScale(scale);
+	if (_slowFrames >= RESOLUTION_DOWN_FRAMES)
+		newScale = std::max(_minScale, scale - RESOLUTION_DOWN_STEP);
+	else if (_fastFrames >= RESOLUTION_UP_FRAMES)
+		newScale = std::min(_maxScale, scale + RESOLUTION_UP_STEP);
+
+	if (_slowFrames >= RESOLUTION_DOWN_FRAMES ||
+		_fastFrames >= RESOLUTION_UP_FRAMES)
+	{
+		// Let the new scale settle before judging it
+		_slowFrames = 0;
+		_fastFrames = 0;
+	}
+
+	if (newScale != scale)
+	{
+		DEBUG(SDL_LOG_CATEGORY_RENDER,
+			"Render scale %.2f -> %.2f (%.1f ms / %u ms)",
+			scale,
+			newScale,
+			_averageMilliseconds,
+			_targetMilliseconds);
+		_window->setRenderScale(newScale);
+
+		// Durations measured at the previous scale no longer apply : reseed
+		// from the next frame
+		_averageMilliseconds = 0.0f;
+	}
+}
+
+/*!
+ * @param	targetMilliseconds	Frame duration budget
+ * @throws	Exception			Invalid input parameters
+ */
+void ResolutionController::setTargetMilliseconds(
+	Uint32 const targetMilliseconds)
+{
+	// Check input parameters
+	if (targetMilliseconds == 0)
+		THROW(Exception, "Received 'targetMilliseconds' == 0");
+
+	_targetMilliseconds = targetMilliseconds;
+	_slowFrames = 0;
+	_fastFrames = 0;
+}
+
+/*!
+ * The current render scale is clamped into the new range right away.
+ *
+ * @param	minScale	Lowest render scale allowed (]0, 1])
+ * @param	maxScale	Highest render scale allowed ([minScale, 1])
+ * @throws	Exception	Invalid input parameters
+ */
+void ResolutionController::setScaleRange(
+	float const minScale,
+	float const maxScale)
+{
+	// Check input parameters
+	if (!(minScale > 0.0f && minScale <= 1.0f))
+		THROW(Exception, "Received 'minScale' out of ]0, 1] range");
+	if (!(maxScale >= minScale && maxScale <= 1.0f))
+		THROW(Exception, "Received 'maxScale' out of ['minScale', 1] range");
+
+	_minScale = minScale;
+	_maxScale = maxScale;
+
+	float const scale(_window->getRenderScale());
+	float const clamped(std::min(_maxScale, std::max(_minScale, scale)));
+	if (clamped != scale)
+		_window->setRenderScale(clamped);
+}
+
+float ResolutionController::getAverageMilliseconds(void) const
+{
+	return _averageMilliseconds;
+}
@@ -0,0 +1,408 @@
+#include <VBN/StreamingTexture.hpp>
+#include <VBN/Logging.hpp>
+#include <VBN/Exceptions.hpp>
+#include <cstring>
+#include <utility>
+
+/*!
+ * @param	renderer	Raw pointer to the SDL_Renderer to use
+ * @param	format		Packed pixel format (FourCC formats are not supported)
+ * @param	width		Texture width
+ * @param	height		Texture height
+ * @throws	Exception	Invalid input parameters or SDL call error
+ */
+StreamingTexture::StreamingTexture(
+	SDL_Renderer * renderer,
+	Uint32 const format,
+	int const width,
+	int const height) :
+	_front(Texture::fromScratch(
+		renderer, format, SDL_TEXTUREACCESS_STREAMING, width, height)),
+	_back(Texture::fromScratch(
+		renderer, format, SDL_TEXTUREACCESS_STREAMING, width, height)),
+	_pitch(0),
+	_bytesPerPixel(SDL_BYTESPERPIXEL(format)),
+	_lockedRegion{0, 0, 0, 0},
+	_locked(false),
+	_pendingRegion{0, 0, 0, 0},
+	_staleRegion{0, 0, 0, 0},
+	_revision(0),
+	_colorAlphaMod{255, 255, 255, 255},
+	_blendMode(SDL_ISPIXELFORMAT_ALPHA(format) ?
+		SDL_BLENDMODE_BLEND :
+		SDL_BLENDMODE_NONE)
+{
+	// Check input parameters
+	if (SDL_ISPIXELFORMAT_FOURCC(format) || _bytesPerPixel <= 0)
+		THROW(Exception,
+			"Unsupported pixel format '%s'",
+			SDL_GetPixelFormatName(format));
+
+	// Allocate zeroed system memory copy ; both Textures must be initialized
+	_pitch = width * _bytesPerPixel;
+	_pixels.assign((std::size_t)_pitch * height, 0);
+	_pendingRegion = SDL_Rect{0, 0, width, height};
+	_staleRegion = _pendingRegion;
+
+	applyState(_front);
+	applyState(_back);
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Build StreamingTexture %p (%dx%d %s)",
+		this,
+		width,
+		height,
+		SDL_GetPixelFormatName(format));
+}
+
+StreamingTexture::StreamingTexture(StreamingTexture && other) :
+	_front(std::move(other._front)),
+	_back(std::move(other._back)),
+	_pixels(std::move(other._pixels)),
+	_pitch(std::move(other._pitch)),
+	_bytesPerPixel(std::move(other._bytesPerPixel)),
+	_lockedRegion(std::move(other._lockedRegion)),
+	_locked(std::move(other._locked)),
+	_pendingRegion(std::move(other._pendingRegion)),
+	_staleRegion(std::move(other._staleRegion)),
+	_revision(std::move(other._revision)),
+	_colorAlphaMod(std::move(other._colorAlphaMod)),
+	_blendMode(std::move(other._blendMode))
+{
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Move StreamingTexture %p into new StreamingTexture %p",
+		&other,
+		this);
+}
+
+StreamingTexture::~StreamingTexture(void)
+{
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Delete StreamingTexture %p",
+		this);
+}
+
+/*!
+ * @param	region		Region to crop (nullptr = whole texture)
+ * @returns				Region cropped to the texture bounds
+ * @throws	Exception	Region lies outside of the texture
+ */
+SDL_Rect StreamingTexture::cropRegion(SDL_Rect const * region) const
+{
+	SDL_Rect const whole{0, 0, _front.getWidth(), _front.getHeight()};
+	if (region == nullptr)
+		return whole;
+
+	SDL_Rect cropped;
+	if (!SDL_IntersectRect(region, &whole, &cropped))
+		THROW(Exception,
+			"Region (%d;%d;%d;%d) lies outside of the texture",
+			region->x,
+			region->y,
+			region->w,
+			region->h);
+
+	return cropped;
+}
+
+/*!
+ * @param	region	Region to extend (w or h <= 0 means empty)
+ * @param	other	Region to cover
+ */
+void StreamingTexture::extendRegion(SDL_Rect & region, SDL_Rect const & other)
+{
+	if (region.w <= 0 || region.h <= 0)
+		region = other;
+	else
+		SDL_UnionRect(&region, &other, &region);
+}
+
+/*!
+ * @param	texture		Texture to update
+ */
+void StreamingTexture::applyState(Texture & texture) const
+{
+	if (SDL_SetTextureColorMod(texture.getSDLTexture(),
+		_colorAlphaMod.r,
+		_colorAlphaMod.g,
+		_colorAlphaMod.b) ||
+		SDL_SetTextureAlphaMod(texture.getSDLTexture(), _colorAlphaMod.a))
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Failed to set color and alpha : SDL error '%s'",
+			SDL_GetError());
+
+	texture.setBlendMode(_blendMode);
+}
+
+/*!
+ * The returned memory is a system memory copy of the pixels : it holds the
+ * current contents and may be read as well as written. Only one region may be
+ * locked at a time.
+ *
+ * @param	region		Region to lock (nullptr = whole texture)
+ * @param	pitch		Receives the number of bytes per pixel row
+ * @returns				Pointer to the top-left pixel of the region
+ * @throws	Exception	Already locked or invalid region
+ */
+void * StreamingTexture::lock(SDL_Rect const * region, int & pitch)
+{
+	if (_locked)
+		THROW(Exception, "StreamingTexture is already locked");
+
+	_lockedRegion = cropRegion(region);
+	_locked = true;
+
+	pitch = _pitch;
+	return (_pixels.data()
+		+ _lockedRegion.y * _pitch
+		+ _lockedRegion.x * _bytesPerPixel);
+}
+
+void StreamingTexture::unlock(void)
+{
+	if (!_locked)
+	{
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot unlock StreamingTexture %p : not locked",
+			this);
+		return;
+	}
+
+	_locked = false;
+	extendRegion(_pendingRegion, _lockedRegion);
+}
+
+/*!
+ * @param	region		Region to overwrite (nullptr = whole texture)
+ * @param	pixels		Source pixels, in the texture's pixel format
+ * @param	pitch		Number of bytes per source pixel row
+ * @throws	Exception	Invalid input parameters
+ */
+void StreamingTexture::update(
+	SDL_Rect const * region,
+	void const * pixels,
+	int const pitch)
+{
+	// Check input parameters
+	if (pixels == nullptr)
+		THROW(Exception, "Received nullptr 'pixels'");
+
+	SDL_Rect const destination(cropRegion(region));
+	std::size_t const rowSize((std::size_t)destination.w * _bytesPerPixel);
+	Uint8 const * sourceRow(static_cast<Uint8 const *>(pixels));
+
+	// Copy row by row into system memory
+	for (int row(0) ; row < destination.h ; ++row)
+	{
+		std::memcpy(
+			_pixels.data()
+				+ (destination.y + row) * _pitch
+				+ destination.x * _bytesPerPixel,
+			sourceRow,
+			rowSize);
+		sourceRow += pitch;
+	}
+
+	extendRegion(_pendingRegion, destination);
+}
+
+bool StreamingTexture::hasPendingChanges(void) const
+{
+	return (_pendingRegion.w > 0 && _pendingRegion.h > 0);
+}
+
+/*!
+ * The back Texture must receive both the pending changes and the changes it
+ * missed during previous commit().
+ *
+ * @param	upload	Receives the area to upload into the back Texture
+ * @returns			Whether changes are pending & the pixels are not locked
+ */
+bool StreamingTexture::prepareCommit(SDL_Rect & upload) const
+{
+	if (!hasPendingChanges())
+		return false;
+	if (_locked)
+	{
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot commit StreamingTexture %p : still locked",
+			this);
+		return false;
+	}
+
+	upload = _staleRegion;
+	extendRegion(upload, _pendingRegion);
+	return true;
+}
+
+/*!
+ * @param	region				Region of the pixels to copy
+ * @param	destination			Destination of the top-left pixel
+ * @param	destinationPitch	Bytes per destination row
+ */
+void StreamingTexture::copyPixels(
+	SDL_Rect const & region,
+	Uint8 * destination,
+	int const destinationPitch) const
+{
+	std::size_t const rowSize((std::size_t)region.w * _bytesPerPixel);
+	for (int row(0) ; row < region.h ; ++row)
+	{
+		std::memcpy(
+			destination,
+			_pixels.data()
+				+ (region.y + row) * _pitch
+				+ region.x * _bytesPerPixel,
+			rowSize);
+		destination += destinationPitch;
+	}
+}
+
+void StreamingTexture::swapBuffers(void)
+{
+	// The former front Texture misses the pending changes
+	std::swap(_front, _back);
+	_staleRegion = _pendingRegion;
+	_pendingRegion = SDL_Rect{0, 0, 0, 0};
+	++_revision;
+}
+
+/*!
+ * The back Texture receives both the pending changes and the changes it missed
+ * during previous commit(), then becomes the front Texture.
+ *
+ * @returns		Number of bytes uploaded
+ */
+std::size_t StreamingTexture::commit(void)
+{
+	SDL_Rect upload{0, 0, 0, 0};
+	if (!prepareCommit(upload))
+		return 0;
+
+	// Upload through streaming access into the back Texture
+	void * texturePixels(nullptr);
+	int texturePitch(0);
+	if (SDL_LockTexture(_back.getSDLTexture(),
+		&upload,
+		&texturePixels,
+		&texturePitch))
+	{
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot lock streaming texture : SDL error '%s'",
+			SDL_GetError());
+		return 0;
+	}
+
+	copyPixels(upload, static_cast<Uint8 *>(texturePixels), texturePitch);
+	SDL_UnlockTexture(_back.getSDLTexture());
+	swapBuffers();
+
+	return ((std::size_t)upload.w * _bytesPerPixel * upload.h);
+}
+
+/*!
+ * Same as commit(), except that the back Texture is not touched : the changed
+ * pixels are copied into 'upload' instead, and the buffers are swapped right
+ * away. upload() must then run before the front Texture is next drawn.
+ *
+ * @param	upload	Receives the staged changes
+ * @returns			Whether changes were staged
+ */
+bool StreamingTexture::stage(Upload & upload)
+{
+	if (!prepareCommit(upload.region))
+		return false;
+
+	int const pitch(upload.region.w * _bytesPerPixel);
+	upload.texture = _back.getSDLTexture();
+	upload.pixels.resize((std::size_t)pitch * upload.region.h);
+	copyPixels(upload.region, upload.pixels.data(), pitch);
+	swapBuffers();
+
+	return true;
+}
+
+/*!
+ * Must run on the thread owning the SDL_Renderer.
+ *
+ * @param	upload	Changes staged by stage()
+ * @returns			Number of bytes uploaded
+ */
+std::size_t StreamingTexture::upload(Upload const & upload)
+{
+	void * texturePixels(nullptr);
+	int texturePitch(0);
+	if (SDL_LockTexture(upload.texture,
+		&upload.region,
+		&texturePixels,
+		&texturePitch))
+	{
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot lock streaming texture : SDL error '%s'",
+			SDL_GetError());
+		return 0;
+	}
+
+	std::size_t const rowSize(upload.pixels.size() / upload.region.h);
+	Uint8 const * sourceRow(upload.pixels.data());
+	Uint8 * destinationRow(static_cast<Uint8 *>(texturePixels));
+	for (int row(0) ; row < upload.region.h ; ++row)
+	{
+		std::memcpy(destinationRow, sourceRow, rowSize);
+		sourceRow += rowSize;
+		destinationRow += texturePitch;
+	}
+
+	SDL_UnlockTexture(upload.texture);
+	return upload.pixels.size();
+}
+
+/*!
+ * @param	color	Color & alpha modulation, applied to both Textures
+ */
+void StreamingTexture::setColorAlphaMod(SDL_Color const & color)
+{
+	_colorAlphaMod = color;
+	applyState(_front);
+	applyState(_back);
+}
+
+SDL_Color StreamingTexture::getColorAlphaMod(void) const
+{
+	return _colorAlphaMod;
+}
+
+/*!
+ * @param	blendMode	Blending mode, applied to both Textures
+ */
+void StreamingTexture::setBlendMode(SDL_BlendMode const & blendMode)
+{
+	_blendMode = blendMode;
+	applyState(_front);
+	applyState(_back);
+}
+
+SDL_BlendMode StreamingTexture::getBlendMode(void) const
+{
+	return _blendMode;
+}
+
+Texture & StreamingTexture::getTexture(void)
+{
+	return _front;
+}
+
+Uint32 StreamingTexture::getRevision(void) const
+{
+	return _revision;
+}
+
+int StreamingTexture::getWidth(void) const
+{
+	return _front.getWidth();
+}
+
+int StreamingTexture::getHeight(void) const
+{
+	return _front.getHeight();
+}
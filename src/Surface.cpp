@@ -146,6 +146,27 @@ Surface Surface::fromImage(std::string const & path)
 	return Surface(surface);
 }
 
+/*!
+ * @param	format	Pixel format of the new Surface
+ * @returns			A newly created Surface with converted contents
+ * @throws			SDL call error
+ */
+Surface Surface::convert(Uint32 const format)
+{
+	// Try converting raw SDL_Surface
+	SDL_Surface * surface(
+		SDL_ConvertSurfaceFormat(_rawSurface.get(), format, 0));
+
+	// Check for conversion errors
+	if (surface == nullptr)
+		THROW(Exception,
+			"Cannot convert SDL_Surface : SDL error '%s'",
+			SDL_GetError());
+
+	// Return encapsulated Surface
+	return Surface(surface);
+}
+
 /*!
  * @param	width	Surface width
  * @param	height	Surface height
@@ -0,0 +1,83 @@
+#include <VBN/TextLayout.hpp>
+
+bool TextLayout::Options::operator == (Options const & other) const
+{
+	return (alignment == other.alignment &&
+		lineHeight == other.lineHeight &&
+		ellipsis == other.ellipsis);
+}
+
+TextLayout::TextLayout(void) :
+	_font(nullptr),
+	_width(0),
+	_height(0),
+	_bounds{0, 0, 0, 0}
+{
+}
+
+/*!
+ * @param	font	Font to print with
+ * @param	text	Text to print
+ * @param	width	Maximum line width
+ * @param	height	Maximum layout height
+ * @param	options	Layout parameters
+ * @returns			true if the layout can be drawn as is
+ */
+bool TextLayout::matches(
+	BitmapFont const * font,
+	std::string_view const text,
+	int const width,
+	int const height,
+	Options const & options) const
+{
+	return (_font == font &&
+		_width == width &&
+		_height == height &&
+		_options == options &&
+		_text == text);
+}
+
+BitmapFont * TextLayout::getFont(void) const
+{
+	return _font;
+}
+
+std::string const & TextLayout::getText(void) const
+{
+	return _text;
+}
+
+int TextLayout::getWidth(void) const
+{
+	return _width;
+}
+
+int TextLayout::getHeight(void) const
+{
+	return _height;
+}
+
+TextLayout::Options const & TextLayout::getOptions(void) const
+{
+	return _options;
+}
+
+std::vector<TextLayout::PlacedGlyph> const & TextLayout::getGlyphs(void) const
+{
+	return _glyphs;
+}
+
+std::vector<SDL_Rect> const & TextLayout::getLineBounds(void) const
+{
+	return _lineBounds;
+}
+
+int TextLayout::getLineCount(void) const
+{
+	return (int)_lineBounds.size();
+}
+
+SDL_Rect const & TextLayout::getBounds(void) const
+{
+	return _bounds;
+}
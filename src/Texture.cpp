@@ -17,7 +17,9 @@ Texture::Texture(SDL_Texture * rawTexture) :
 	_pixelFormat(0),
 	_access(0),
 	_width(0),
-	_height(0)
+	_height(0),
+	_savedColorAlphaMod{255, 255, 255, 255},
+	_savedBlendMode(SDL_BLENDMODE_NONE)
 {
 	// Check input parameters
 	if(rawTexture == nullptr)
@@ -47,7 +49,9 @@ Texture::Texture(Texture && other) :
 	_pixelFormat(std::move(other._pixelFormat)),
 	_access(std::move(other._access)),
 	_width(std::move(other._width)),
-	_height(std::move(other._height))
+	_height(std::move(other._height)),
+	_savedColorAlphaMod(std::move(other._savedColorAlphaMod)),
+	_savedBlendMode(std::move(other._savedBlendMode))
 {
 	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
 		"Move Texture %p (SDL_Texture %p) into new Texture %p",
@@ -65,6 +69,8 @@ Texture & Texture::operator=(Texture && other)
 	this->_access = std::move(other._access);
 	this->_width = std::move(other._width);
 	this->_height = std::move(other._height);
+	this->_savedColorAlphaMod = std::move(other._savedColorAlphaMod);
+	this->_savedBlendMode = std::move(other._savedBlendMode);
 
 	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
 		"Move (assign) Texture %p (SDL_Texture %p) into Texture %p",
@@ -108,6 +114,11 @@ Uint32 Texture::getPixelFormat(void) const
 	return _pixelFormat;
 }
 
+std::size_t Texture::getSize(void) const
+{
+	return ((std::size_t)_width * _height * SDL_BYTESPERPIXEL(_pixelFormat));
+}
+
 void Texture::setColorAlphaMod(SDL_Color const & color)
 {
 	if(SDL_SetTextureColorMod(_rawTexture.get(),
@@ -140,6 +151,76 @@ SDL_Color Texture::getColorAlphaMod(void) const
 	return rgba;
 }
 
+void Texture::setBlendMode(SDL_BlendMode const & blendMode)
+{
+	if(SDL_SetTextureBlendMode(_rawTexture.get(), blendMode))
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Failed to set blend mode : SDL error '%s'",
+			SDL_GetError());
+}
+
+/*!
+ * Frees the texture memory while keeping the Texture instance (and thus every
+ * pointer to it) valid : dimensions, clips, color-alpha modulation and
+ * blending mode are preserved for reload().
+ */
+void Texture::unload(void)
+{
+	if (!_rawTexture)
+		return;
+
+	_savedColorAlphaMod = getColorAlphaMod();
+	if (SDL_GetTextureBlendMode(_rawTexture.get(), &_savedBlendMode))
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Failed to get blend mode : SDL error '%s'",
+			SDL_GetError());
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Unload Texture %p (SDL_Texture %p)",
+		this,
+		_rawTexture.get());
+
+	_rawTexture.reset();
+}
+
+bool Texture::isLoaded(void) const
+{
+	return (_rawTexture != nullptr);
+}
+
+/*!
+ * @param	replacement		Texture rebuilt from the same source ; its
+ *							SDL_Texture is moved into this instance, clips are
+ *							kept
+ * @throws	Exception		Replacement has no SDL_Texture
+ */
+void Texture::reload(Texture && replacement)
+{
+	// Check input parameters
+	if (!replacement._rawTexture)
+		THROW(Exception, "Received unloaded 'replacement'");
+
+	_rawTexture = std::move(replacement._rawTexture);
+	_pixelFormat = replacement._pixelFormat;
+	_access = replacement._access;
+	_width = replacement._width;
+	_height = replacement._height;
+	_clips[""] = SDL_Rect{0, 0, _width, _height};
+
+	// Restore modulation & blending
+	setColorAlphaMod(_savedColorAlphaMod);
+	if (SDL_SetTextureAlphaMod(_rawTexture.get(), _savedColorAlphaMod.a))
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Failed to set alpha mod : SDL error '%s'",
+			SDL_GetError());
+	setBlendMode(_savedBlendMode);
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Reload Texture %p (SDL_Texture %p)",
+		this,
+		_rawTexture.get());
+}
+
 /*!
  * @param	ttfManager		Shared reference on a valid TrueTypeFontManager from
  *							which to extract the TrueTypeFont to use
@@ -300,6 +381,50 @@ Texture Texture::fromScratch(
 	return Texture(rawTexture);
 }
 
+/*!
+ * Pixels are uploaded as-is : no conversion happens on the CPU. Formats with
+ * an alpha channel get the blend blending mode, as with fromSurface().
+ *
+ * @param	renderer	Raw pointer to the SDL_Renderer to use
+ * @param	format		Pixel format of 'pixels'
+ * @param	width		Width
+ * @param	height		Height
+ * @param	pixels		Pixel rows
+ * @param	pitch		Bytes per pixel row
+ * @returns				A static Texture holding the input pixels
+ * @throws	Exception	Invalid input parameters or SDL error
+ */
+Texture Texture::fromPixels(
+	SDL_Renderer * renderer,
+	Uint32 const format,
+	int const width,
+	int const height,
+	void const * pixels,
+	int const pitch)
+{
+	// Check input parameters
+	if (pixels == nullptr)
+		THROW(Exception, "Received nullptr 'pixels'");
+
+	// Attempt creation (may throw) & upload
+	Texture texture(fromScratch(
+		renderer,
+		format,
+		SDL_TEXTUREACCESS_STATIC,
+		width,
+		height));
+
+	if (SDL_UpdateTexture(texture.getSDLTexture(), nullptr, pixels, pitch))
+		THROW(Exception,
+			"Cannot upload SDL_Texture pixels : SDL error '%s'",
+			SDL_GetError());
+
+	if (SDL_ISPIXELFORMAT_ALPHA(format))
+		texture.setBlendMode(SDL_BLENDMODE_BLEND);
+
+	return texture;
+}
+
 /*!
  * @param	name		Human-readable name to associate with the clipping
  *						rectangle
@@ -0,0 +1,273 @@
+#include <VBN/TexturePack.hpp>
+#include <VBN/Logging.hpp>
+#include <VBN/Exceptions.hpp>
+#include <SDL2/SDL_pixels.h>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(TexturePack::Header) == 16,
+	"Unexpected TexturePack::Header layout");
+static_assert(sizeof(TexturePack::Entry) == TEXTURE_PACK_NAME_SIZE + 32,
+	"Unexpected TexturePack::Entry layout");
+
+/*!
+ * The main constructor for this class is private, external callers should use
+ * the "from...()" factories instead.
+ *
+ * @param	path		Path to the pack file to map
+ * @throws	Exception	File cannot be opened or mapped
+ */
+TexturePack::TexturePack(std::string const & path) :
+	_path(path),
+	_data(nullptr),
+	_size(0)
+#ifdef _WIN32
+	, _mapping(nullptr)
+#endif
+{
+#ifdef _WIN32
+	HANDLE file(CreateFileA(path.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		nullptr));
+	if (file == INVALID_HANDLE_VALUE)
+		THROW(Exception,
+			"Cannot open texture pack '%s' : error %lu",
+			path.c_str(),
+			GetLastError());
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+		THROW(Exception,
+			"Cannot get texture pack '%s' size : error %lu",
+			path.c_str(),
+			GetLastError());
+	}
+	_size = (std::size_t)fileSize.QuadPart;
+
+	_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (_mapping == nullptr)
+		THROW(Exception,
+			"Cannot map texture pack '%s' : error %lu",
+			path.c_str(),
+			GetLastError());
+
+	_data = static_cast<Uint8 const *>(
+		MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (_data == nullptr)
+	{
+		CloseHandle(_mapping);
+		THROW(Exception,
+			"Cannot map texture pack '%s' : error %lu",
+			path.c_str(),
+			GetLastError());
+	}
+#else
+	int const file(open(path.c_str(), O_RDONLY));
+	if (file < 0)
+		THROW(Exception,
+			"Cannot open texture pack '%s' : %s",
+			path.c_str(),
+			strerror(errno));
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0)
+	{
+		close(file);
+		THROW(Exception,
+			"Cannot get texture pack '%s' size : %s",
+			path.c_str(),
+			strerror(errno));
+	}
+	_size = (std::size_t)fileStat.st_size;
+
+	void * data(_size ?
+		mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, file, 0) :
+		MAP_FAILED);
+	close(file);
+	if (data == MAP_FAILED)
+		THROW(Exception,
+			"Cannot map texture pack '%s' : %s",
+			path.c_str(),
+			_size ? strerror(errno) : "empty file");
+	_data = static_cast<Uint8 const *>(data);
+#endif
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Build TexturePack %p ('%s', %u bytes)",
+		this,
+		path.c_str(),
+		(unsigned int)_size);
+}
+
+TexturePack::TexturePack(TexturePack && other) :
+	_path(std::move(other._path)),
+	_data(std::move(other._data)),
+	_size(std::move(other._size)),
+	_entries(std::move(other._entries))
+#ifdef _WIN32
+	, _mapping(std::move(other._mapping))
+#endif
+{
+	other._data = nullptr;
+	other._size = 0;
+#ifdef _WIN32
+	other._mapping = nullptr;
+#endif
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Move TexturePack %p into new TexturePack %p",
+		&other,
+		this);
+}
+
+TexturePack::~TexturePack(void)
+{
+	if (_data != nullptr)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(_data);
+		CloseHandle(_mapping);
+#else
+		munmap(const_cast<Uint8 *>(_data), _size);
+#endif
+	}
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Delete TexturePack %p",
+		this);
+}
+
+/*!
+ * @throws	Exception	Truncated or inconsistent pack file
+ */
+void TexturePack::validate(void)
+{
+	// Header
+	if (_size < sizeof(Header))
+		THROW(Exception, "Truncated texture pack '%s'", _path.c_str());
+
+	Header const & header(*reinterpret_cast<Header const *>(_data));
+	if (std::memcmp(header.magic, TEXTURE_PACK_MAGIC, sizeof(header.magic)))
+		THROW(Exception, "Invalid texture pack '%s'", _path.c_str());
+	if (header.version != TEXTURE_PACK_VERSION)
+		THROW(Exception,
+			"Unsupported texture pack '%s' version %u",
+			_path.c_str(),
+			header.version);
+	if (header.byteOrder != TEXTURE_PACK_BYTE_ORDER)
+		THROW(Exception,
+			"Texture pack '%s' was built with another byte order",
+			_path.c_str());
+	if ((_size - sizeof(Header)) / sizeof(Entry) < header.count)
+		THROW(Exception, "Truncated texture pack '%s' index", _path.c_str());
+
+	// Index
+	for (std::size_t index(0) ; index < header.count ; ++index)
+	{
+		Entry const & entry(getEntry(index));
+
+		if (entry.name[TEXTURE_PACK_NAME_SIZE - 1] != '\0')
+			THROW(Exception,
+				"Invalid entry name in texture pack '%s'",
+				_path.c_str());
+		if (SDL_ISPIXELFORMAT_FOURCC(entry.format) ||
+			SDL_BYTESPERPIXEL(entry.format) == 0 ||
+			entry.width <= 0 ||
+			entry.height <= 0 ||
+			entry.pitch < entry.width * (Sint32)SDL_BYTESPERPIXEL(entry.format) ||
+			entry.size < (Uint64)entry.pitch * entry.height ||
+			entry.offset > _size ||
+			entry.size > _size - entry.offset)
+			THROW(Exception,
+				"Invalid entry '%s' in texture pack '%s'",
+				entry.name,
+				_path.c_str());
+
+		if (!_entries.emplace(entry.name, index).second)
+			THROW(Exception,
+				"Duplicate entry '%s' in texture pack '%s'",
+				entry.name,
+				_path.c_str());
+	}
+}
+
+std::size_t TexturePack::getCount(void) const
+{
+	return reinterpret_cast<Header const *>(_data)->count;
+}
+
+/*!
+ * @param	index	Position of the record in the index
+ * @returns			The requested index record
+ * @throws	Exception	Invalid input parameters
+ */
+TexturePack::Entry const & TexturePack::getEntry(std::size_t const index) const
+{
+	// Check input parameters
+	if (index >= getCount())
+		THROW(Exception, "Received out of range 'index' %u", (unsigned int)index);
+
+	return reinterpret_cast<Entry const *>(_data + sizeof(Header))[index];
+}
+
+/*!
+ * @param	name	Name of the wanted image
+ * @returns			Raw pointer to the index record if it exists, nullptr
+ *					otherwise
+ */
+TexturePack::Entry const * TexturePack::findEntry(std::string const & name) const
+{
+	auto entryIterator = _entries.find(name);
+	if (entryIterator == _entries.end())
+		return nullptr;
+
+	return (&getEntry(entryIterator->second));
+}
+
+/*!
+ * @param	entry	Index record of the image
+ * @returns			Pointer to the first pixel row (mapped memory)
+ */
+void const * TexturePack::getPixels(Entry const & entry) const
+{
+	return (_data + entry.offset);
+}
+
+std::string const & TexturePack::getPath(void) const
+{
+	return _path;
+}
+
+/*!
+ * @param	path		Path to the pack file
+ * @returns				A TexturePack mapping the file
+ * @throws	Exception	File cannot be mapped, or is not a valid pack
+ */
+TexturePack TexturePack::fromFile(std::string const & path)
+{
+	// Check input parameters
+	if (path.empty())
+		THROW(Exception, "Received empty 'path'");
+
+	// Map file (unmapped by the destructor if validation fails)
+	TexturePack pack(path);
+	pack.validate();
+
+	return pack;
+}
@@ -0,0 +1,449 @@
+#include <VBN/TileMap.hpp>
+#include <VBN/Logging.hpp>
+#include <VBN/Exceptions.hpp>
+#include <algorithm>
+
+Uint16 const TileMap::EMPTY_TILE;
+
+/*!
+ * @param	renderer	Raw pointer to the SDL_Renderer to bake chunks on
+ * @param	tileset		Texture holding the tiles (must outlive the TileMap)
+ * @param	tileWidth	Tile width in pixels
+ * @param	tileHeight	Tile height in pixels
+ * @param	columns		Number of tile columns in the map
+ * @param	rows		Number of tile rows in the map
+ * @param	chunkSize	Chunk side, in tiles
+ * @param	rendererMutex	Mutex to hold while creating chunk Textures &
+ *							running bakes which are not scheduled, when the
+ *							SDL_Renderer is shared with another thread
+ *							(nullptr = none)
+ * @throws	Exception	Invalid input parameters
+ */
+TileMap::TileMap(
+	SDL_Renderer * renderer,
+	Texture * tileset,
+	int const tileWidth,
+	int const tileHeight,
+	int const columns,
+	int const rows,
+	int const chunkSize,
+	std::recursive_mutex * rendererMutex) :
+	_sdlRenderer(renderer),
+	_rendererMutex(rendererMutex),
+	_tileset(tileset),
+	_tilesetColumns(0),
+	_tileWidth(tileWidth),
+	_tileHeight(tileHeight),
+	_columns(columns),
+	_rows(rows),
+	_chunkSize(chunkSize),
+	_chunkColumns(0),
+	_chunkRows(0),
+	_bakeStats{0, 0}
+{
+	// Check input parameters
+	if (renderer == nullptr)
+		THROW(Exception, "Received nullptr 'renderer'");
+	if (tileset == nullptr)
+		THROW(Exception, "Received nullptr 'tileset'");
+	if (tileWidth <= 0)
+		THROW(Exception, "Received 'tileWidth' <= 0");
+	if (tileHeight <= 0)
+		THROW(Exception, "Received 'tileHeight' <= 0");
+	if (columns <= 0)
+		THROW(Exception, "Received 'columns' <= 0");
+	if (rows <= 0)
+		THROW(Exception, "Received 'rows' <= 0");
+	if (chunkSize <= 0 || chunkSize * chunkSize > EMPTY_TILE)
+		THROW(Exception, "Received out-of-range 'chunkSize'");
+
+	_tilesetColumns = _tileset->getWidth() / _tileWidth;
+	if (_tilesetColumns <= 0)
+		THROW(Exception, "Tileset is narrower than a single tile");
+
+	// Allocate empty grid & outdated chunks
+	_chunkColumns = (_columns + _chunkSize - 1) / _chunkSize;
+	_chunkRows = (_rows + _chunkSize - 1) / _chunkSize;
+	_tiles.assign(_columns * _rows, EMPTY_TILE);
+	_chunks.resize(_chunkColumns * _chunkRows);
+	for (Chunk & chunk : _chunks)
+	{
+		chunk.fullyDirty = true;
+		chunk.revision = 0;
+	}
+
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Build TileMap %p (%dx%d tiles, %dx%d chunks)",
+		this,
+		_columns,
+		_rows,
+		_chunkColumns,
+		_chunkRows);
+}
+
+TileMap::TileMap(TileMap && other) :
+	_sdlRenderer(std::move(other._sdlRenderer)),
+	_rendererMutex(std::move(other._rendererMutex)),
+	_tileset(std::move(other._tileset)),
+	_tilesetColumns(std::move(other._tilesetColumns)),
+	_tileWidth(std::move(other._tileWidth)),
+	_tileHeight(std::move(other._tileHeight)),
+	_columns(std::move(other._columns)),
+	_rows(std::move(other._rows)),
+	_chunkSize(std::move(other._chunkSize)),
+	_chunkColumns(std::move(other._chunkColumns)),
+	_chunkRows(std::move(other._chunkRows)),
+	_tiles(std::move(other._tiles)),
+	_chunks(std::move(other._chunks)),
+	_visible(std::move(other._visible)),
+	_bakeStats(std::move(other._bakeStats))
+{
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Move TileMap %p into new TileMap %p",
+		&other,
+		this);
+}
+
+TileMap::~TileMap(void)
+{
+	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
+		"Delete TileMap %p",
+		this);
+}
+
+/*!
+ * Only the tile's cell is re-baked in its chunk, the next time the chunk
+ * becomes visible.
+ *
+ * @param	column		Tile column
+ * @param	row			Tile row
+ * @param	index		Tileset index (TileMap::EMPTY_TILE = no tile)
+ * @throws	Exception	Invalid input parameters
+ */
+void TileMap::setTile(int const column, int const row, Uint16 const index)
+{
+	// Check input parameters
+	if (column < 0 || column >= _columns)
+		THROW(Exception, "Received out-of-range 'column' %d", column);
+	if (row < 0 || row >= _rows)
+		THROW(Exception, "Received out-of-range 'row' %d", row);
+
+	Uint16 & tile(_tiles[row * _columns + column]);
+	if (tile == index)
+		return;
+	tile = index;
+
+	// Schedule tile re-bake ; fall back to a full chunk re-bake when most of
+	// the chunk changed
+	Chunk & chunk(_chunks[(row / _chunkSize) * _chunkColumns
+		+ column / _chunkSize]);
+	if (chunk.fullyDirty)
+		return;
+	if ((int)chunk.dirtyTiles.size() >= (_chunkSize * _chunkSize) / 4)
+	{
+		chunk.fullyDirty = true;
+		chunk.dirtyTiles.clear();
+	}
+	else
+		chunk.dirtyTiles.push_back(
+			(row % _chunkSize) * _chunkSize + column % _chunkSize);
+}
+
+/*!
+ * @param	column		Tile column
+ * @param	row			Tile row
+ * @returns				Tileset index of the tile
+ * @throws	Exception	Invalid input parameters
+ */
+Uint16 TileMap::getTile(int const column, int const row) const
+{
+	// Check input parameters
+	if (column < 0 || column >= _columns)
+		THROW(Exception, "Received out-of-range 'column' %d", column);
+	if (row < 0 || row >= _rows)
+		THROW(Exception, "Received out-of-range 'row' %d", row);
+
+	return _tiles[row * _columns + column];
+}
+
+void TileMap::invalidate(void)
+{
+	for (Chunk & chunk : _chunks)
+	{
+		chunk.fullyDirty = true;
+		chunk.dirtyTiles.clear();
+	}
+}
+
+int TileMap::getWidth(void) const
+{
+	return _columns * _tileWidth;
+}
+
+int TileMap::getHeight(void) const
+{
+	return _rows * _tileHeight;
+}
+
+/*!
+ * @param	bake	Chunk bake to add the copy to
+ * @param	column	Tile column
+ * @param	row		Tile row
+ * @param	chunk	Chunk area (in map pixels) covered by the chunk Texture
+ */
+void TileMap::bakeTile(
+	Bake & bake,
+	int const column,
+	int const row,
+	SDL_Rect const & chunk)
+{
+	Uint16 const index(_tiles[row * _columns + column]);
+	if (index == EMPTY_TILE)
+		return;
+
+	SDL_Rect const source{
+		(index % _tilesetColumns) * _tileWidth,
+		(index / _tilesetColumns) * _tileHeight,
+		_tileWidth,
+		_tileHeight};
+	SDL_Rect const destination{
+		column * _tileWidth - chunk.x,
+		row * _tileHeight - chunk.y,
+		_tileWidth,
+		_tileHeight};
+
+	++_bakeStats.drawCalls;
+	bake.copies.push_back(std::make_pair(source, destination));
+}
+
+/*!
+ * Restores the previous rendering target (& its scale, viewport & clipping)
+ * and the tileset blending mode.
+ *
+ * @param	bake	Chunk bake to execute
+ */
+void TileMap::runBake(Bake const & bake)
+{
+	// Redirect rendering into the chunk
+	SDL_Texture * previousTarget(SDL_GetRenderTarget(bake.renderer));
+	float previousScaleX(1.0f);
+	float previousScaleY(1.0f);
+	SDL_RenderGetScale(bake.renderer, &previousScaleX, &previousScaleY);
+	SDL_Rect previousViewport{0, 0, 0, 0};
+	SDL_RenderGetViewport(bake.renderer, &previousViewport);
+	SDL_Rect previousClip{0, 0, 0, 0};
+	SDL_RenderGetClipRect(bake.renderer, &previousClip);
+	SDL_bool const previousClipEnabled(SDL_RenderIsClipEnabled(bake.renderer));
+	if (SDL_SetRenderTarget(bake.renderer, bake.target))
+	{
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot target chunk texture : SDL error '%s'",
+			SDL_GetError());
+		return;
+	}
+
+	// Cleared pixels must be fully transparent
+	SDL_SetRenderDrawColor(bake.renderer, 0, 0, 0, 0);
+	SDL_SetRenderDrawBlendMode(bake.renderer, SDL_BLENDMODE_NONE);
+
+	// Tiles never overlap within a chunk : copy their pixels as is, so that
+	// translucent tiles are only blended once, when the chunk is drawn
+	SDL_BlendMode tilesetBlendMode(SDL_BLENDMODE_BLEND);
+	SDL_GetTextureBlendMode(bake.tileset, &tilesetBlendMode);
+	SDL_SetTextureBlendMode(bake.tileset, SDL_BLENDMODE_NONE);
+
+	if (bake.clear)
+		SDL_RenderClear(bake.renderer);
+	if (!bake.cells.empty())
+		SDL_RenderFillRects(bake.renderer,
+			bake.cells.data(),
+			(int)bake.cells.size());
+	for (auto const & copy : bake.copies)
+		if (SDL_RenderCopy(bake.renderer,
+			bake.tileset,
+			&copy.first,
+			&copy.second))
+			ERROR(SDL_LOG_CATEGORY_ERROR,
+				"Cannot bake tile at (%d;%d) : SDL error '%s'",
+				copy.second.x,
+				copy.second.y,
+				SDL_GetError());
+
+	SDL_SetTextureBlendMode(bake.tileset, tilesetBlendMode);
+
+	// Restore previous rendering target (& its scale, viewport & clipping)
+	if (SDL_SetRenderTarget(bake.renderer, previousTarget))
+		ERROR(SDL_LOG_CATEGORY_ERROR,
+			"Cannot restore rendering target : SDL error '%s'",
+			SDL_GetError());
+	SDL_RenderSetScale(bake.renderer, previousScaleX, previousScaleY);
+	SDL_RenderSetViewport(bake.renderer, &previousViewport);
+	SDL_RenderSetClipRect(bake.renderer,
+		previousClipEnabled ? &previousClip : nullptr);
+}
+
+/*!
+ * Chunk Textures are created on first bake. Fully outdated chunks are cleared
+ * and re-baked ; otherwise only the individually changed tiles are cleared &
+ * re-baked. Bakes only read the tile indices when prepared : a scheduled bake
+ * is not affected by later tile changes.
+ *
+ * @param	chunkColumn		Chunk column
+ * @param	chunkRow		Chunk row
+ * @param	schedule		Runs the bake later (empty = bake right away)
+ */
+void TileMap::bakeChunk(
+	int const chunkColumn,
+	int const chunkRow,
+	BakeScheduler const & schedule)
+{
+	Chunk & chunk(_chunks[chunkRow * _chunkColumns + chunkColumn]);
+
+	// Tile range covered by the chunk (edge chunks may be smaller)
+	int const firstColumn(chunkColumn * _chunkSize);
+	int const firstRow(chunkRow * _chunkSize);
+	int const lastColumn(std::min(firstColumn + _chunkSize, _columns));
+	int const lastRow(std::min(firstRow + _chunkSize, _rows));
+	SDL_Rect const area{
+		firstColumn * _tileWidth,
+		firstRow * _tileHeight,
+		(lastColumn - firstColumn) * _tileWidth,
+		(lastRow - firstRow) * _tileHeight};
+
+	// Lazily create chunk Texture (may throw)
+	if (!chunk.texture)
+	{
+		std::unique_lock<std::recursive_mutex> lock;
+		if (_rendererMutex != nullptr)
+			lock = std::unique_lock<std::recursive_mutex>(*_rendererMutex);
+
+		chunk.texture = std::unique_ptr<Texture>(new Texture(
+			Texture::fromScratch(
+				_sdlRenderer,
+				SDL_PIXELFORMAT_RGBA32,
+				SDL_TEXTUREACCESS_TARGET,
+				area.w,
+				area.h)));
+		chunk.texture->setBlendMode(SDL_BLENDMODE_BLEND);
+		chunk.fullyDirty = true;
+	}
+
+	// Prepare SDL calls from current tile indices
+	std::shared_ptr<Bake> bake(new Bake{
+		_sdlRenderer,
+		chunk.texture->getSDLTexture(),
+		_tileset->getSDLTexture(),
+		chunk.fullyDirty,
+		std::vector<SDL_Rect>(),
+		std::vector<std::pair<SDL_Rect, SDL_Rect>>()});
+
+	++_bakeStats.chunks;
+	if (chunk.fullyDirty)
+	{
+		++_bakeStats.drawCalls;
+		for (int row(firstRow) ; row < lastRow ; ++row)
+			for (int column(firstColumn) ; column < lastColumn ; ++column)
+				bakeTile(*bake, column, row, area);
+	}
+	else
+	{
+		if (!chunk.dirtyTiles.empty())
+			++_bakeStats.drawCalls;
+		for (Uint16 const offset : chunk.dirtyTiles)
+		{
+			int const column(firstColumn + offset % _chunkSize);
+			int const row(firstRow + offset / _chunkSize);
+			bake->cells.push_back(SDL_Rect{
+				column * _tileWidth - area.x,
+				row * _tileHeight - area.y,
+				_tileWidth,
+				_tileHeight});
+			bakeTile(*bake, column, row, area);
+		}
+	}
+
+	chunk.fullyDirty = false;
+	chunk.dirtyTiles.clear();
+	++chunk.revision;
+
+	// Execute (bake shared with the scheduled function, which must be copyable)
+	if (schedule)
+	{
+		schedule([bake] (void) {
+			runBake(*bake);
+		});
+		return;
+	}
+
+	std::unique_lock<std::recursive_mutex> lock;
+	if (_rendererMutex != nullptr)
+		lock = std::unique_lock<std::recursive_mutex>(*_rendererMutex);
+	runBake(*bake);
+}
+
+/*!
+ * Only chunks intersecting the camera are considered : outdated ones are
+ * re-baked, then their visible part is computed.
+ *
+ * @param	camera		Viewed area, in map pixels
+ * @param	schedule	Runs chunk bakes later, before the returned chunks are
+ *						drawn (empty = bake right away)
+ * @returns				Visible chunk areas (valid until next call)
+ */
+std::vector<TileMap::ChunkCopy> const & TileMap::prepare(
+	SDL_Rect const & camera,
+	BakeScheduler const & schedule)
+{
+	_visible.clear();
+
+	// Crop camera to map bounds
+	SDL_Rect const map{0, 0, getWidth(), getHeight()};
+	SDL_Rect view;
+	if (!SDL_IntersectRect(&camera, &map, &view))
+		return _visible;
+
+	// Visible chunk range
+	int const chunkWidth(_chunkSize * _tileWidth);
+	int const chunkHeight(_chunkSize * _tileHeight);
+	int const firstChunkColumn(view.x / chunkWidth);
+	int const firstChunkRow(view.y / chunkHeight);
+	int const lastChunkColumn((view.x + view.w - 1) / chunkWidth);
+	int const lastChunkRow((view.y + view.h - 1) / chunkHeight);
+
+	for (int chunkRow(firstChunkRow) ; chunkRow <= lastChunkRow ; ++chunkRow)
+		for (int chunkColumn(firstChunkColumn) ;
+			chunkColumn <= lastChunkColumn ;
+			++chunkColumn)
+		{
+			Chunk & chunk(_chunks[chunkRow * _chunkColumns + chunkColumn]);
+			if (!chunk.texture || chunk.fullyDirty || !chunk.dirtyTiles.empty())
+				bakeChunk(chunkColumn, chunkRow, schedule);
+
+			SDL_Rect const area{
+				chunkColumn * chunkWidth,
+				chunkRow * chunkHeight,
+				chunk.texture->getWidth(),
+				chunk.texture->getHeight()};
+			SDL_Rect part;
+			if (!SDL_IntersectRect(&area, &view, &part))
+				continue;
+
+			_visible.push_back(ChunkCopy{
+				chunk.texture->getSDLTexture(),
+				chunk.revision,
+				SDL_Rect{part.x - area.x, part.y - area.y, part.w, part.h},
+				SDL_Rect{part.x - camera.x, part.y - camera.y, part.w, part.h}});
+		}
+
+	return _visible;
+}
+
+/*!
+ * @returns		Chunks baked & SDL draw calls issued since last call
+ */
+TileMap::BakeStats TileMap::takeBakeStats(void)
+{
+	BakeStats const stats(_bakeStats);
+	_bakeStats = BakeStats{0, 0};
+	return stats;
+}
@@ -1,7 +1,28 @@
 #include <VBN/TrueTypeFont.hpp>
+#include <algorithm>
+#include <mutex>
+#include <VBN/UTF8.hpp>
 #include <VBN/Logging.hpp>
 #include <VBN/Exceptions.hpp>
 
+//! Number of codepoints whose metrics are cached in a dense table (Latin1)
+#define TRUE_TYPE_FONT_DENSE_METRICS 256
+//! Maximum number of other codepoints whose metrics are cached
+#define TRUE_TYPE_FONT_MAX_SPARSE_METRICS 4096
+
+namespace
+{
+	// Faces share the FreeType library of SDL_ttf : they must not be opened or
+	// closed concurrently, whichever thread or manager owns them
+	std::mutex faceMutex;
+
+	void closeFont(TTF_Font * font)
+	{
+		std::lock_guard<std::mutex> lock(faceMutex);
+		TTF_CloseFont(font);
+	}
+}
+
 /*!
  * @param	filePath	Full path to the .ttf file (with extension)
  * @param	size		Font size
@@ -14,7 +35,7 @@ TrueTypeFont::TrueTypeFont(
 	std::string const & filePath,
 	unsigned const size,
 	unsigned const face) :
-	_font(nullptr, &TTF_CloseFont)
+	_font(nullptr, &closeFont)
 {
 	// Check input parameters
 	if (filePath.empty())
@@ -23,9 +44,12 @@ TrueTypeFont::TrueTypeFont(
 		THROW(Exception, "Received 'size' <= 0");
 
 	// Instantiate TTF_Font and enclose it in unique_ptr
-	_font = std::unique_ptr<TTF_Font, decltype(&TTF_CloseFont)>(
-		TTF_OpenFontIndex(filePath.c_str(), size, face),
-		TTF_CloseFont);
+	{
+		std::lock_guard<std::mutex> lock(faceMutex);
+		_font = std::unique_ptr<TTF_Font, decltype(&TTF_CloseFont)>(
+			TTF_OpenFontIndex(filePath.c_str(), size, face),
+			&closeFont);
+	}
 
 	// Check for TTF_OpenFontIndex errors
 	if (_font == nullptr)
@@ -44,7 +68,10 @@ TrueTypeFont::TrueTypeFont(
 		size);
 }
 
-TrueTypeFont::TrueTypeFont(TrueTypeFont && other) : _font(std::move(other._font))
+TrueTypeFont::TrueTypeFont(TrueTypeFont && other) :
+	_font(std::move(other._font)),
+	_denseMetrics(std::move(other._denseMetrics)),
+	_sparseMetrics(std::move(other._sparseMetrics))
 {
 	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
 		"Move font %p (TTF_Font %p) into new font %p",
@@ -96,6 +123,11 @@ int TrueTypeFont::getLineSkip(void) const
 	return TTF_FontLineSkip(_font.get());
 }
 
+int TrueTypeFont::getHeight(void) const
+{
+	return TTF_FontHeight(_font.get());
+}
+
 int TrueTypeFont::getFaces(void) const
 {
 	return TTF_FontFaces(_font.get());
@@ -111,34 +143,123 @@ std::string TrueTypeFont::getFaceFamilyName(void) const
 	return TTF_FontFaceFamilyName(_font.get());
 }
 
-TrueTypeFont::GlyphMetrics TrueTypeFont::getGlyphMetrics(char const c) const
+/*!
+ * Metrics of codepoints outside of Latin1 are dropped once
+ * TRUE_TYPE_FONT_MAX_SPARSE_METRICS of them are cached (e.g. a CJK text
+ * stream), so that the table stays bounded. References stay valid until the
+ * next query, or a style, outline or hinting change.
+ *
+ * @param	codepoint	Unicode codepoint of the glyph
+ * @returns				Cache entry of the glyph
+ */
+TrueTypeFont::CachedMetrics const & TrueTypeFont::getCachedMetrics(
+	Uint32 const codepoint) const
+{
+	CachedMetrics * entry(nullptr);
+	if (codepoint < TRUE_TYPE_FONT_DENSE_METRICS)
+	{
+		if (_denseMetrics.empty())
+			_denseMetrics.resize(TRUE_TYPE_FONT_DENSE_METRICS,
+				CachedMetrics{GlyphMetrics{0, 0, 0, 0, 0, 0, 0}, false, false});
+		entry = &_denseMetrics[codepoint];
+	}
+	else
+	{
+		if (_sparseMetrics.size() >= TRUE_TYPE_FONT_MAX_SPARSE_METRICS &&
+			_sparseMetrics.find(codepoint) == _sparseMetrics.end())
+			_sparseMetrics.clear();
+		entry = &_sparseMetrics.emplace(codepoint,
+			CachedMetrics{GlyphMetrics{0, 0, 0, 0, 0, 0, 0}, false, false})
+			.first->second;
+	}
+
+	if (!entry->filled)
+	{
+		GlyphMetrics & metrics(entry->metrics);
+		entry->provided = (TTF_GlyphIsProvided32(_font.get(), codepoint) != 0);
+		if (TTF_GlyphMetrics32(_font.get(), codepoint,
+				&metrics.xMin, &metrics.xMax,
+				&metrics.yMin, &metrics.yMax,
+				&metrics.advance))
+			metrics = GlyphMetrics{0, 0, 0, 0, 0, 0, 0};
+		metrics.width = metrics.xMax - metrics.xMin;
+		metrics.height = metrics.yMax - metrics.yMin;
+		entry->filled = true;
+	}
+
+	return *entry;
+}
+
+void TrueTypeFont::clearMetrics(void)
+{
+	_denseMetrics.clear();
+	_sparseMetrics.clear();
+}
+
+/*!
+ * @param	c	Latin1 character
+ * @returns		Glyph metrics (zeroed if the glyph is not provided)
+ */
+TrueTypeFont::GlyphMetrics const & TrueTypeFont::getGlyphMetrics(
+	char const c) const
 {
-	GlyphMetrics metrics;
-	TTF_GlyphMetrics(_font.get(), c,
-			&metrics.xMin, &metrics.xMax,
-			&metrics.yMin, &metrics.yMax,
-			&metrics.advance);
-	metrics.width = metrics.xMax - metrics.xMin;
-	metrics.height = metrics.yMax - metrics.yMin;
-	return metrics;
+	return getCachedMetrics((unsigned char)c).metrics;
+}
+
+/*!
+ * @param	codepoint	Unicode codepoint of the glyph
+ * @returns				Glyph metrics (zeroed if the glyph is not provided)
+ */
+TrueTypeFont::GlyphMetrics const & TrueTypeFont::getCodepointMetrics(
+	Uint32 const codepoint) const
+{
+	return getCachedMetrics(codepoint).metrics;
+}
+
+bool TrueTypeFont::hasGlyph(Uint32 const codepoint) const
+{
+	return getCachedMetrics(codepoint).provided;
+}
+
+/*!
+ * Kerning is queried even while disabled for text renders.
+ *
+ * @param	previous	Unicode codepoint of the left glyph
+ * @param	current		Unicode codepoint of the right glyph
+ * @returns				Pen adjustment (in pixels) between both glyphs
+ */
+int TrueTypeFont::getKerningSize(
+	Uint32 const previous,
+	Uint32 const current) const
+{
+	return TTF_GetFontKerningSizeGlyphs32(_font.get(), previous, current);
 }
 
 void TrueTypeFont::setStyle(int const style)
 {
 	if(TTF_GetFontStyle(_font.get()) != style)
+	{
 		TTF_SetFontStyle(_font.get(), style);
+		clearMetrics();
+	}
 }
 
 void TrueTypeFont::setOutline(int const outline)
 {
 	if(TTF_GetFontOutline(_font.get()) != outline)
+	{
 		TTF_SetFontOutline(_font.get(), outline);
+		clearMetrics();
+	}
 }
 
 void TrueTypeFont::setHinting(int const hinting)
 {
 	if(TTF_GetFontHinting(_font.get()) != hinting)
+	{
 		TTF_SetFontHinting(_font.get(), hinting);
+		clearMetrics();
+	}
 }
 
 void TrueTypeFont::setKerning(int const kerning)
@@ -147,7 +268,7 @@ void TrueTypeFont::setKerning(int const kerning)
 		TTF_SetFontKerning(_font.get(), kerning);
 }
 
-std::pair<int, int> TrueTypeFont::getTextSize(std::string const text) const
+std::pair<int, int> TrueTypeFont::getTextSize(std::string const & text) const
 {
 	std::pair<int, int> result{0,0};
 
@@ -156,6 +277,62 @@ std::pair<int, int> TrueTypeFont::getTextSize(std::string const text) const
 	return result;
 }
 
+/*!
+ * Unlike getTextSize(), no glyph is loaded by SDL_ttf once its metrics are
+ * cached, and nothing is allocated once 'sizes' has grown : measuring the
+ * same labels every frame only costs table lookups.
+ *
+ * Widths follow SDL_ttf : the pen advance, widened by glyphs overhanging it
+ * on either side (kerning applies when enabled). Heights are the font height.
+ * Strings are measured on a single line ('\n' is not a line break). Bold &
+ * outlined fonts, which SDL_ttf widens beyond their glyph metrics, are
+ * measured by SDL_ttf itself instead (one string copy per text).
+ *
+ * @param	texts	UTF-8 strings to measure
+ * @param	sizes	Set to {width, height} of each string, in 'texts' order
+ */
+void TrueTypeFont::getTextSizes(
+	std::vector<std::string_view> const & texts,
+	std::vector<std::pair<int, int>> & sizes) const
+{
+	int const height(getHeight());
+	bool const kerning(getKerning() != 0);
+	bool const widened((getStyle() & TTF_STYLE_BOLD) != 0 || getOutline() > 0);
+	std::string terminated;
+
+	sizes.resize(texts.size());
+	for (std::size_t index(0) ; index < texts.size() ; ++index)
+	{
+		std::string_view const text(texts[index]);
+		if (widened)
+		{
+			terminated.assign(text);
+			sizes[index] = std::pair<int, int>(0, 0);
+			TTF_SizeUTF8(_font.get(), terminated.c_str(),
+				&sizes[index].first,
+				&sizes[index].second);
+			continue;
+		}
+
+		int x(0), minX(0), maxX(0);
+		Uint32 previous(0);
+		for (std::size_t cursor(0) ; cursor < text.size() ;)
+		{
+			Uint32 const codepoint(decodeUTF8(text, cursor));
+			if (kerning && previous != 0)
+				x += getKerningSize(previous, codepoint);
+
+			GlyphMetrics const & metrics(getCodepointMetrics(codepoint));
+			minX = std::min(minX, x + metrics.xMin);
+			maxX = std::max(maxX, x + std::max(metrics.xMax, metrics.advance));
+			x += metrics.advance;
+			previous = codepoint;
+		}
+
+		sizes[index] = std::pair<int, int>(maxX - minX, height);
+	}
+}
+
 /*!
  * @param	text		An std::string containing a Latin1-encoded sequence to print
  *						onto a new SDL_Surface
@@ -213,3 +390,67 @@ SDL_Surface * TrueTypeFont::renderSolidUTF8(
 	// Return rendered SDL_Surface
 	return renderedText;
 }
+
+/*!
+ * The Surface spans the whole font height, and starts at the pen position (or
+ * at the glyph left side, if it extends to the left of the pen position).
+ *
+ * @param	codepoint	Unicode codepoint of the glyph to print
+ * @param	color		SDL_Color to use for printing
+ * @returns				Raw pointer to newly created SDL_Surface containing the
+ *						printed glyph
+ * @throws	Exception	TTF call error
+ */
+SDL_Surface * TrueTypeFont::renderSolidGlyph(
+	Uint32 const codepoint,
+	SDL_Color const & color)
+{
+	// Try rendering
+	SDL_Surface * renderedGlyph(
+		TTF_RenderGlyph32_Solid(
+			_font.get(),
+			codepoint,
+			color));
+
+	// Check for rendering errors
+	if(renderedGlyph == nullptr)
+		THROW(Exception,
+			"Cannot render glyph U+%04X : TTF error '%s'",
+			(unsigned int)codepoint,
+			TTF_GetError());
+
+	// Return rendered SDL_Surface
+	return renderedGlyph;
+}
+
+/*!
+ * Same layout as renderSolidGlyph(), on an ARGB8888 Surface whose alpha
+ * channel holds the anti-aliased coverage.
+ *
+ * @param	codepoint	Unicode codepoint of the glyph to print
+ * @param	color		SDL_Color to use for printing
+ * @returns				Raw pointer to newly created SDL_Surface containing the
+ *						printed glyph
+ * @throws	Exception	TTF call error
+ */
+SDL_Surface * TrueTypeFont::renderBlendedGlyph(
+	Uint32 const codepoint,
+	SDL_Color const & color)
+{
+	// Try rendering
+	SDL_Surface * renderedGlyph(
+		TTF_RenderGlyph32_Blended(
+			_font.get(),
+			codepoint,
+			color));
+
+	// Check for rendering errors
+	if(renderedGlyph == nullptr)
+		THROW(Exception,
+			"Cannot render blended glyph U+%04X : TTF error '%s'",
+			(unsigned int)codepoint,
+			TTF_GetError());
+
+	// Return rendered SDL_Surface
+	return renderedGlyph;
+}
@@ -64,7 +64,7 @@ TrueTypeFont * TrueTypeFontManager::getFont(
 
 		// Instantiate TrueTypeFont using input file & face 0
 		// May throw
-		TrueTypeFont ttFont(_assetsDirectory + fontName + ".ttf", size);
+		TrueTypeFont ttFont(getFontPath(fontName), size);
 
 		// Store newly instantiated font in cache
 		auto insertedPair(_fonts.emplace(
@@ -85,4 +85,33 @@ TrueTypeFont * TrueTypeFontManager::getFont(
 	}
 
 	return font;
-}
\ No newline at end of file
+}
+
+/*!
+ * @param	fontName	Name of the font (filename without the .ttf extension)
+ * @param	size		Size of the font
+ * @returns				Raw pointer to the corresponding font, nullptr if it
+ *						was not opened yet
+ */
+TrueTypeFont * TrueTypeFontManager::findFont(
+	std::string const & fontName,
+	int const size)
+{
+	auto const fontIterator(_fonts.find(make_pair(fontName, size)));
+	return (fontIterator == _fonts.end() ? nullptr : &fontIterator->second);
+}
+
+/*!
+ * @param	fontName	Name of the font (filename without the .ttf extension)
+ * @returns				Path to the font file
+ * @throws	Exception	Font not configured
+ */
+std::string TrueTypeFontManager::getFontPath(std::string const & fontName) const
+{
+	if (_fontNames.find(fontName) == _fontNames.end())
+		THROW(Exception,
+			"No '%s' font configured",
+			fontName.c_str());
+
+	return _assetsDirectory + fontName + ".ttf";
+}
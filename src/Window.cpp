@@ -29,6 +29,7 @@ Window::Window(std::string const & title,
 	_ratioType(ratioType),
 	_canvasWidth(windowWidth),
 	_canvasHeight(windowHeight),
+	_renderScale(1.0f),
 	_renderer(nullptr)
 {
 	// Check input parameters
@@ -84,7 +85,8 @@ Window::Window(Window && other) :
 	_renderer(std::move(other._renderer)),
 	_ratioType(std::move(other._ratioType)),
 	_canvasWidth(std::move(other._canvasWidth)),
-	_canvasHeight(std::move(other._canvasHeight))
+	_canvasHeight(std::move(other._canvasHeight)),
+	_renderScale(std::move(other._renderScale))
 {
 	VERBOSE(SDL_LOG_CATEGORY_APPLICATION,
 		"Move Window %p (SDL_Window %p) into new Window %p",
@@ -128,6 +130,10 @@ void Window::applyRatioTypeSettings(void)
 			case FIXED_RATIO_STRETCH:
 				_renderer->setLogicalSize(_canvasWidth, _canvasHeight);
 			break;
+			case FIXED_RATIO_PIXEL:
+				_renderer->setLogicalSize(0, 0);
+				_renderer->enableScaledTarget(_canvasWidth, _canvasHeight, true);
+			break;
 			case DYNAMIC_RATIO:
 				_renderer->setLogicalSize(0, 0);
 			break;
@@ -151,11 +157,42 @@ void Window::applyRatioTypeSettings(void)
 			case FIXED_RATIO_STRETCH:
 				_renderer->setLogicalSize(_canvasWidth, _canvasHeight);
 			break;
+			case FIXED_RATIO_PIXEL:
+				_renderer->setLogicalSize(0, 0);
+				_renderer->enableScaledTarget(_canvasWidth, _canvasHeight, true);
+			break;
 			case DYNAMIC_RATIO:
 				_renderer->setLogicalSize(0, 0);
 			break;
 		}
 	}
+
+	applyRenderScale();
+}
+
+/*!
+ * Below full resolution, rendering goes through the Renderer scaled target,
+ * sized after the canvas (or the Window itself in DYNAMIC_RATIO mode). At full
+ * resolution, only FIXED_RATIO_PIXEL mode keeps it.
+ */
+void Window::applyRenderScale(void)
+{
+	if (_ratioType != FIXED_RATIO_PIXEL)
+	{
+		if (_renderScale < 1.0f)
+		{
+			int width(_canvasWidth);
+			int height(_canvasHeight);
+			if (_ratioType == DYNAMIC_RATIO)
+				SDL_GetWindowSize(_window.get(), &width, &height);
+
+			_renderer->enableScaledTarget(width, height, false);
+		}
+		else
+			_renderer->disableScaledTarget();
+	}
+
+	_renderer->setRenderScale(_renderScale);
 }
 
 /*!
@@ -232,4 +269,23 @@ Uint32 Window::getId(void)
 void Window::handleResize(void)
 {
 	applyRatioTypeSettings();
+}
+
+/*!
+ * @param	scale		Fraction of the canvas resolution to render at (]0, 1])
+ * @throws	Exception	Invalid input parameters or SDL call error
+ */
+void Window::setRenderScale(float const scale)
+{
+	// Check input parameters
+	if (!(scale > 0.0f && scale <= 1.0f))
+		THROW(Exception, "Received 'scale' out of ]0, 1] range");
+
+	_renderScale = scale;
+	applyRenderScale();
+}
+
+float Window::getRenderScale(void) const
+{
+	return _renderScale;
 }
\ No newline at end of file
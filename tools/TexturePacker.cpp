@@ -0,0 +1,242 @@
+/*!
+ * Offline texture pack builder
+ *
+ * Decodes images with SDL_image, converts them to a given pixel format and
+ * writes them into a pack file readable by TexturePack (see
+ * Renderer::addTexturePack()).
+ *
+ * Pick the pixel format the target renderer uses natively (first entry of
+ * SDL_RendererInfo::texture_formats, usually ARGB8888), so that no conversion
+ * happens at upload time.
+ *
+ * Usage : TexturePacker [-f FORMAT] OUTPUT [NAME=]IMAGE...
+ *
+ * Images are named after their file name without extension, unless an explicit
+ * NAME is given. Only depends on SDL2, SDL2_image and VBN/TexturePack.hpp.
+ */
+
+#include <VBN/TexturePack.hpp>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	//! Pixel formats accepted on the command line
+	struct FormatName
+	{
+		char const * name;
+		Uint32 format;
+	};
+
+	FormatName const FORMATS[] = {
+		{"ARGB8888", SDL_PIXELFORMAT_ARGB8888},
+		{"ABGR8888", SDL_PIXELFORMAT_ABGR8888},
+		{"RGBA8888", SDL_PIXELFORMAT_RGBA8888},
+		{"BGRA8888", SDL_PIXELFORMAT_BGRA8888},
+		{"RGBA32", SDL_PIXELFORMAT_RGBA32},
+		{"RGB888", SDL_PIXELFORMAT_RGB888},
+		{"RGB565", SDL_PIXELFORMAT_RGB565}
+	};
+
+	//! Image to pack
+	struct Image
+	{
+		std::string name;
+		std::string path;
+		SDL_Surface * surface;
+	};
+
+	void usage(char const * program)
+	{
+		std::fprintf(stderr,
+			"Usage : %s [-f FORMAT] OUTPUT [NAME=]IMAGE...\n"
+			"Formats :",
+			program);
+		for (FormatName const & format : FORMATS)
+			std::fprintf(stderr, " %s", format.name);
+		std::fprintf(stderr, " (default ARGB8888)\n");
+	}
+
+	//! Image name : explicit NAME, or file name without directory & extension
+	void parseImage(std::string const & argument, Image & image)
+	{
+		std::size_t const equal(argument.find('='));
+		if (equal != std::string::npos)
+		{
+			image.name = argument.substr(0, equal);
+			image.path = argument.substr(equal + 1);
+			return;
+		}
+
+		image.path = argument;
+		std::size_t const slash(argument.find_last_of("/\\"));
+		image.name = argument.substr(slash == std::string::npos ? 0 : slash + 1);
+		std::size_t const dot(image.name.find_last_of('.'));
+		if (dot != std::string::npos && dot != 0)
+			image.name.erase(dot);
+	}
+
+	//! Round up to TEXTURE_PACK_ALIGNMENT
+	Uint64 align(Uint64 const offset)
+	{
+		return ((offset + TEXTURE_PACK_ALIGNMENT - 1)
+			/ TEXTURE_PACK_ALIGNMENT * TEXTURE_PACK_ALIGNMENT);
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	Uint32 format(SDL_PIXELFORMAT_ARGB8888);
+	int argument(1);
+
+	// Options
+	if (argc > 2 && std::strcmp(argv[1], "-f") == 0)
+	{
+		format = SDL_PIXELFORMAT_UNKNOWN;
+		for (FormatName const & candidate : FORMATS)
+			if (std::strcmp(argv[2], candidate.name) == 0)
+				format = candidate.format;
+		if (format == SDL_PIXELFORMAT_UNKNOWN)
+		{
+			usage(argv[0]);
+			return 1;
+		}
+		argument = 3;
+	}
+	if (argc - argument < 2)
+	{
+		usage(argv[0]);
+		return 1;
+	}
+
+	std::string const output(argv[argument++]);
+	std::vector<Image> images;
+	for ( ; argument < argc ; ++argument)
+	{
+		Image image{"", "", nullptr};
+		parseImage(argv[argument], image);
+		if (image.name.empty() || image.name.size() >= TEXTURE_PACK_NAME_SIZE)
+		{
+			std::fprintf(stderr, "Invalid image name '%s'\n", image.name.c_str());
+			return 1;
+		}
+		for (Image const & other : images)
+			if (other.name == image.name)
+			{
+				std::fprintf(stderr, "Duplicate image name '%s'\n",
+					image.name.c_str());
+				return 1;
+			}
+		images.push_back(image);
+	}
+
+	if (IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG) == 0)
+		std::fprintf(stderr, "IMG_Init : %s\n", IMG_GetError());
+
+	// Decode & convert every image
+	int status(0);
+	for (Image & image : images)
+	{
+		SDL_Surface * decoded(IMG_Load(image.path.c_str()));
+		if (decoded == nullptr)
+		{
+			std::fprintf(stderr, "Cannot load '%s' : %s\n",
+				image.path.c_str(),
+				IMG_GetError());
+			status = 1;
+			break;
+		}
+
+		image.surface = SDL_ConvertSurfaceFormat(decoded, format, 0);
+		SDL_FreeSurface(decoded);
+		if (image.surface == nullptr)
+		{
+			std::fprintf(stderr, "Cannot convert '%s' : %s\n",
+				image.path.c_str(),
+				SDL_GetError());
+			status = 1;
+			break;
+		}
+	}
+
+	// Build header & index
+	TexturePack::Header header;
+	std::memcpy(header.magic, TEXTURE_PACK_MAGIC, sizeof(header.magic));
+	header.version = TEXTURE_PACK_VERSION;
+	header.byteOrder = TEXTURE_PACK_BYTE_ORDER;
+	header.count = (Uint32)images.size();
+
+	std::vector<TexturePack::Entry> entries(images.size());
+	Uint64 offset(align(sizeof(header)
+		+ entries.size() * sizeof(TexturePack::Entry)));
+	for (std::size_t index(0) ; status == 0 && index < images.size() ; ++index)
+	{
+		SDL_Surface const * surface(images[index].surface);
+		TexturePack::Entry & entry(entries[index]);
+
+		std::memset(&entry, 0, sizeof(entry));
+		std::strncpy(entry.name,
+			images[index].name.c_str(),
+			TEXTURE_PACK_NAME_SIZE - 1);
+		entry.format = format;
+		entry.width = surface->w;
+		entry.height = surface->h;
+		entry.pitch = surface->w * SDL_BYTESPERPIXEL(format);
+		entry.offset = offset;
+		entry.size = (Uint64)entry.pitch * entry.height;
+
+		offset = align(offset + entry.size);
+	}
+
+	// Write pack : header, index, then tightly packed rows per image
+	if (status == 0)
+	{
+		std::ofstream file(output, std::ios::binary | std::ios::trunc);
+		char const padding[TEXTURE_PACK_ALIGNMENT] = {0};
+
+		file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+		file.write(reinterpret_cast<char const *>(entries.data()),
+			entries.size() * sizeof(TexturePack::Entry));
+
+		Uint64 written(sizeof(header)
+			+ entries.size() * sizeof(TexturePack::Entry));
+		for (std::size_t index(0) ; index < images.size() ; ++index)
+		{
+			SDL_Surface * surface(images[index].surface);
+			TexturePack::Entry const & entry(entries[index]);
+
+			file.write(padding, (std::streamsize)(entry.offset - written));
+			SDL_LockSurface(surface);
+			for (int row(0) ; row < surface->h ; ++row)
+				file.write(
+					static_cast<char const *>(surface->pixels)
+						+ row * surface->pitch,
+					entry.pitch);
+			SDL_UnlockSurface(surface);
+			written = entry.offset + entry.size;
+
+			std::printf("%s : %dx%d (%s)\n",
+				entry.name,
+				entry.width,
+				entry.height,
+				images[index].path.c_str());
+		}
+
+		if (!file)
+		{
+			std::fprintf(stderr, "Cannot write '%s'\n", output.c_str());
+			status = 1;
+		}
+	}
+
+	for (Image & image : images)
+		SDL_FreeSurface(image.surface);
+	IMG_Quit();
+
+	return status;
+}